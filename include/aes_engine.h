@@ -0,0 +1,38 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// FIPS-197 AES-128/256 with ECB, CTR (SP 800-38A) and GCM (SP 800-38D).
+// Engines are picked at runtime from CPUID; all of them produce identical
+// output and are checked against known-answer vectors by aes_self_test().
+
+typedef enum {
+    AES_ENGINE_TABLE,   // portable 32-bit T-tables
+    AES_ENGINE_AESNI,   // AES-NI + PCLMULQDQ, 8 blocks in flight
+    AES_ENGINE_VAES     // VAES on 256-bit lanes for ECB/CTR, AES-NI for GCM
+} AesEngine;
+
+typedef struct {
+    uint32_t rk[60];    // expanded round keys, big-endian words
+    int      rounds;    // 10 (AES-128) or 14 (AES-256)
+} AesKey;
+
+AesEngine   aes_best_engine(void);
+const char* aes_engine_name(AesEngine e);
+
+// bits = 128 or 256; returns 0 on bad size
+int  aes_set_key(AesKey* k, const uint8_t* key, int bits);
+
+void aes_ecb_encrypt(AesEngine e, const AesKey* k, const uint8_t* in, uint8_t* out, size_t blocks);
+
+// Big-endian 128-bit counter starting at ctr; any byte length
+void aes_ctr_xor(AesEngine e, const AesKey* k, const uint8_t ctr[16],
+    const uint8_t* in, uint8_t* out, size_t len);
+
+// 96-bit IV only (the TLS/IPsec case)
+void aes_gcm_encrypt(AesEngine e, const AesKey* k, const uint8_t iv[12],
+    const uint8_t* aad, size_t aad_len,
+    const uint8_t* in, uint8_t* out, size_t len, uint8_t tag[16]);
+
+// Runs the FIPS-197 / SP 800-38A / GCM spec vectors on one engine; 1 = pass
+int aes_self_test(AesEngine e);
@@ -1,2 +1,7 @@
 #pragma once
-double aes_mbps_once(void);   // MB/s for one timed AES-like pass
+// MB/s for one timed pass of AES (key size from BenchConfig.aes_key_bits)
+int    aes_prepare(void);         // self-test, key schedule and data buffer, once
+void   aes_teardown(void);
+double aes_mbps_once(void);       // ECB (graded)
+double aes_ctr_mbps_once(void);   // CTR stream
+double aes_gcm_mbps_once(void);   // GCM over 16 KiB records (AEAD incl. GHASH)
@@ -0,0 +1,26 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Thin asynchronous positional I/O queue over a file descriptor.
+// Backends: io_uring (raw syscalls; Linux 5.6+, checked with a probe), then
+// libaio when it was found at build time. aio_ring_create() returns NULL when
+// neither works, and callers fall back to one synchronous stream per thread.
+
+typedef struct AioRing AioRing;
+
+typedef struct {
+    uint64_t tag;       // caller cookie given to aio_ring_queue()
+    long     result;    // bytes transferred, or -errno
+} AioCompletion;
+
+AioRing*    aio_ring_create(int fd, unsigned depth);
+void        aio_ring_destroy(AioRing* r);
+const char* aio_ring_engine(const AioRing* r);
+
+// Queues one read or write; returns 0 if `depth` requests are already in flight.
+int aio_ring_queue(AioRing* r, int write, void* buf, size_t len, uint64_t off, uint64_t tag);
+
+// Submits everything queued, then waits for at least wait_min completions.
+// Returns the number written to out (<= max), or -1 on error.
+int aio_ring_reap(AioRing* r, AioCompletion* out, int max, int wait_min);
@@ -0,0 +1,18 @@
+#pragma once
+#include <stddef.h>
+
+// Process-wide scratch arena for test buffers. Chunks are mapped and
+// pre-faulted once, then handed out again after every arena_reset(), so
+// repetitions and later tests never pay for page faults or zeroing. A request
+// no chunk can hold first unmaps the chunks unused since the last reset.
+// Single-threaded: allocate from prepare hooks, never from pool workers.
+
+void   arena_set_huge(int on);          // back new chunks with huge pages when possible
+void*  arena_alloc(size_t bytes);       // page-aligned, pre-faulted; NULL if out of memory
+void   arena_reset(void);               // every allocation returned, chunks stay mapped
+void   arena_release(void);             // unmaps all chunks
+size_t arena_mapped_bytes(void);
+
+// Incremented by reset/release: a module holding arena memory compares it
+// with the value seen at allocation time to know its buffers are still valid
+unsigned arena_generation(void);
@@ -0,0 +1,75 @@
+#pragma once
+#include "stats.h"
+
+#ifdef _WIN32
+#ifdef pcbench_EXPORTS
+#define API __declspec(dllexport)
+#else
+#define API __declspec(dllimport)
+#endif
+#else
+#define API
+#endif
+
+// Regression comparison of result files (JSON, JSON Lines or CSV). Rows match
+// on (id, threads). With per-sample values on both sides a Mann-Whitney U test
+// decides significance; otherwise the medians' confidence intervals must not
+// overlap. Single values (sweep points) are listed but not judged. A
+// significant change beyond the threshold is a regression or an improvement,
+// by the unit's direction (latencies: lower is better). A JSON Lines file
+// holds every appended run: as a baseline its runs are pooled, as a candidate
+// only the latest run is compared.
+
+typedef struct {
+    char        id[64];
+    char        unit[16];
+    int         threads;
+    SampleStats s;              // pooled samples when present, else as reported
+    double*     samples;        // every run's samples for this row, or NULL
+    int         nsamples;
+} ResultRow;
+
+typedef struct {
+    char       path[256];
+    char       host[128];
+    char       run_id[40];      // latest run in the file
+    char       profile[16];
+    int        runs;            // run records loaded (JSON Lines may hold many)
+    ResultRow* rows;
+    int        count;
+} ResultSet;
+
+typedef struct {
+    double threshold;           // relative change that counts, e.g. 0.05
+    double alpha;               // significance level of the U test
+} CompareOptions;
+
+#define COMPARE_DEFAULT_THRESHOLD 0.05
+#define COMPARE_DEFAULT_ALPHA     0.01
+#define COMPARE_BASELINE_DIR      "baselines"
+
+// 0 if unreadable or not a result file; all_runs = 0 keeps only the last run
+int  results_load(const char* path, int all_runs, ResultSet* out);
+void results_free(ResultSet* set);
+
+// Prints a table of base vs. cand; returns the number of regressions
+int  compare_results(const ResultSet* base, const ResultSet* cand, const CompareOptions* opt);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    // Compares the latest run of each of paths[1..n) against every run of
+    // paths[0]. Returns the total number of regressions, or -1 if a file could
+    // not be loaded.
+    API int compare_files(const char* const* paths, int n, double threshold, double alpha);
+
+    // Per-host baseline: COMPARE_BASELINE_DIR/<host>.jsonl or .json, host
+    // taken from the result file. compare_with_baseline returns as
+    // compare_files; save_baseline copies the file there (0 on failure).
+    API int compare_with_baseline(const char* path, double threshold, double alpha);
+    API int save_baseline(const char* path);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,2 +1,16 @@
 #pragma once
-double compress_mbps_once(void);   // MB/s for compress+decompress timed together
+#include "sweep.h"
+
+// LZ77 + Huffman block codec over synthetic corpora, MB/s of raw data
+int    compress_prepare(void);            // corpora, buffers and per-thread codec state, once
+void   compress_teardown(void);
+double compress_mbps_once(void);          // mixed corpus, compress+decompress timed together (graded)
+double compress_text_mbps_once(void);     // compression only
+double compress_json_mbps_once(void);
+double compress_binary_mbps_once(void);
+double decompress_text_mbps_once(void);   // decompression only
+double decompress_json_mbps_once(void);
+double decompress_binary_mbps_once(void);
+
+// Achieved compression ratio (raw / encoded) per corpus
+int compress_ratio_sweep(SweepPoint* out, int cap);
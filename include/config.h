@@ -22,8 +22,63 @@ typedef struct {
     size_t aes_bytes;             // V_data for AES
     size_t comp_bytes;            // V_data for Compression
 	size_t disk_bytes;            // total bytes for Disk I/O
+    int    threads;               // worker threads: >0 explicit, THREADS_ALL, THREADS_HALF
+    int    thread_sweep;          // 1 = run every test at 1,2,4..N threads
+    size_t latency_max_bytes;     // largest working set in the latency sweep
+    int    latency_hugepages;     // 1 = back the chase buffer with huge pages
+    int    stream_nt_stores;      // 1 = non-temporal (streaming) stores in STREAM kernels
+    int    aes_key_bits;          // 128 or 256
+    int    comp_level;            // codec effort 1 (fastest) .. 9 (best ratio)
+    size_t comp_block_bytes;      // independent codec block size (unit of parallelism)
+    char   disk_dir[256];         // directory for the disk test file ("" = current dir)
+    int    disk_queue_depth;      // 4 KiB requests kept in flight by the random disk tests
+    int    disk_jobs;             // submitting threads sharing that queue depth
+    int    disk_sweep_max_qd;     // deepest queue in the disk QD sweep (0 = skip)
+    int    disk_direct;           // 1 = bypass the page cache (O_DIRECT / NO_BUFFERING)
+    int    ci_repeat;             // 1 = repeat past repetitionsK until the CI is narrow enough
+    double ci_target;             // target 95% CI width of the median, relative (0.02 = 2%)
+    int    repetitions_max;       // hard cap on runs when ci_repeat is on
+    int    perf_counters;         // 1 = read hardware counters around timed regions (Linux)
+    int    arena_hugepages;       // 1 = back the test-buffer arena with huge pages
+    int    simd_isa;              // floating-point kernels: -1 = best available, else a SimdIsa value
+    size_t gemm_N;                // matrix order of the DGM/SGM tests
+    size_t gemm_sweep_max;        // largest matrix order in the GEMM size sweep
+    char   mixed_tests[64];       // mixed-load mode: test ids run together, e.g. "MEM,CMP,DSK" ("" = off)
+    double mixed_seconds;         // duration of the solo and the mixed phase, per workload
+    double test_seconds;          // time budget per test and team size (0 = repetitionsK fixed runs)
+    double sample_seconds;        // target duration of one sample when time-boxed
+    char   tests[256];            // test and sweep ids to run, e.g. "INT,MEM,DSK" ("" = all)
+    char   output_path[256];      // results file
+    int    output_format;         // REPORT_CSV, REPORT_JSON or REPORT_JSONL
+    char   refs_path[256];        // reference database (JSON)
+    char   ref_class[64];         // machine class to look up there ("" = the CPU model)
+    char   plugin_dir[256];       // shared libraries here add tests at startup ("" = none)
+    char   pin[64];               // thread pinning: none, cores, smt or a cpulist ("0-3,8")
+    char   pin_tests[256];        // per-test pinning, "ID:policy;ID:policy" (overrides pin)
+    int    core_types;            // 1 = extra per-core-type rows on hybrid CPUs
+    int    telemetry_ms;          // clock/temperature sampling interval; 0 = off
+    int    energy;                // 1 = RAPL energy around every timed sample
+    size_t bwm_max_bytes;         // largest working set in the bandwidth matrix (0 = 16x LLC)
+    int    bwm_hugepages;         // 1 = 2 MiB pages for the bandwidth matrix, 0 = 4 KiB
 } BenchConfig;
 
+#define THREADS_ALL   0           // one worker per logical CPU
+#define THREADS_HALF  (-1)        // half of the logical CPUs
+
+#define REPORT_CSV    0           // one row per result, appended
+#define REPORT_JSON   1           // one document per run, overwritten
+#define REPORT_JSONL  2           // JSON Lines: a run record, then one line per result, appended
+
+// Field table for setting BenchConfig members by name (command line, GUI)
+typedef enum { CFG_INT, CFG_SIZE, CFG_DOUBLE, CFG_STR } ConfigFieldType;
+
+typedef struct {
+    const char*     name;         // member name, e.g. "triad_N"
+    ConfigFieldType type;
+    size_t          offset;       // offsetof(BenchConfig, member)
+    size_t          size;         // capacity of CFG_STR members
+} ConfigField;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -32,6 +87,17 @@ extern "C" {
 
     // 0=Quick, 1=Standard, 2=Extreme
     API void set_config_profile(int profile_id);
+
+    // Profile last applied (STANDARD until set_config_profile is called)
+    API int bench_config_profile(void);
+    API const char* bench_profile_name(int profile_id);   // "QUICK", "STANDARD", "EXTREME"
+
+    // Every BenchConfig member, in declaration order
+    API const ConfigField* bench_config_fields(int* count);
+
+    // Parses value into the named member (sizes take K/M/G suffixes, binary).
+    // Returns 0 for an unknown name or a malformed value.
+    API int bench_config_set(const char* name, const char* value);
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
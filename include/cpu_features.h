@@ -0,0 +1,18 @@
+#pragma once
+#include <stddef.h>
+
+// Runtime ISA detection (CPUID + XGETBV on x86, compile target on ARM).
+// A flag is only set when both the CPU and the OS support it.
+typedef struct {
+    int sse2, ssse3, sse41, sse42, popcnt;
+    int avx, avx2, fma, bmi2;
+    int avx512f, avx512dq, avx512bw, avx512vl;
+    int aesni, pclmul, vaes, vpclmul, sha;
+    int neon;
+} CpuFeatures;
+
+const CpuFeatures* cpu_features(void);                // probed once, cached
+void cpu_features_str(char* buffer, size_t max_len);  // space-separated flag list
+
+// Raw CPUID leaf/subleaf into r[0..3] = eax, ebx, ecx, edx; 0 (and zeros) off x86
+int cpu_cpuid(unsigned leaf, unsigned sub, unsigned r[4]);
@@ -1,2 +1,19 @@
 #pragma once
-double disk_benchmark_mbps_once(void); // Returns MB/s for one timed pass
\ No newline at end of file
+#include "sweep.h"
+
+// Storage throughput with the OS page cache bypassed (O_DIRECT / NO_BUFFERING,
+// or a cache drop where the filesystem refuses direct I/O). Writes are timed
+// up to and including fsync. The file lives in BenchConfig.disk_dir.
+
+int    disk_prepare(void);                // writes the shared test file once
+double disk_benchmark_mbps_once(void);   // sequential write + read, combined MB/s
+double disk_seq_write_mbps_once(void);   // 1 MiB sequential writes, MB/s
+double disk_seq_read_mbps_once(void);    // 1 MiB sequential reads, MB/s
+double disk_rand_read_iops_once(void);   // 4 KiB random reads at disk_queue_depth, IOPS
+double disk_rand_write_iops_once(void);  // 4 KiB random writes at disk_queue_depth, IOPS
+
+// Random 4 KiB reads at QD 1,2,4..disk_sweep_max_qd (io_uring / libaio, else threads).
+// The IOPS sweep measures; the bandwidth and latency sweeps report the same run.
+int disk_qd_iops_sweep(SweepPoint* out, int cap);
+int disk_qd_mbps_sweep(SweepPoint* out, int cap);
+int disk_qd_latency_sweep(SweepPoint* out, int cap);     // p50/p99/p99.9 per QD, microseconds
@@ -1,2 +1,14 @@
 #pragma once
-double float_mflops_once(void);   // returns MFLOPS for one timed pass
+#include "sweep.h"
+
+// Floating-point kernels on the ISA chosen by BenchConfig.simd_isa (see float_simd.h)
+
+int    float_prepare(void);             // builds the f32/f64 input vectors once (arena)
+double float_mflops_once(void);         // f32 dot product, MFLOPS for one timed pass
+double float_dot64_mflops_once(void);   // f64 dot product, MFLOPS
+double float_fma32_mflops_once(void);   // f32 FMA peak, MFLOPS
+double float_fma64_mflops_once(void);   // f64 FMA peak, MFLOPS
+void   float_teardown(void);
+
+// Single-thread MFLOPS for every kernel on every supported ISA, labels "<ISA>_<KERNEL>"
+int float_isa_sweep(SweepPoint* out, int cap);
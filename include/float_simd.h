@@ -0,0 +1,40 @@
+#pragma once
+#include <stddef.h>
+
+// Floating-point kernels with one implementation per instruction set,
+// selected at runtime from CPUID (NEON is the baseline on AArch64).
+// Dot products use several independent accumulators so the loop is bound
+// by loads, not by add latency; the FMA kernels keep enough independent
+// chains in flight to saturate the FMA ports (peak FLOPS).
+
+typedef enum {
+    SIMD_SCALAR,    // plain C, same accumulator layout
+    SIMD_SSE2,      // 128-bit, mul + add
+    SIMD_AVX2,      // 256-bit FMA (AVX2 + FMA3)
+    SIMD_AVX512,    // 512-bit FMA (AVX-512F)
+    SIMD_NEON,      // 128-bit FMA (AArch64)
+    SIMD_ISA_COUNT
+} SimdIsa;
+
+int         simd_isa_available(SimdIsa isa);
+SimdIsa     simd_best_isa(void);
+const char* simd_isa_name(SimdIsa isa);
+// BenchConfig.simd_isa when this CPU supports it (warns once otherwise), else the best
+SimdIsa     simd_configured_isa(void);
+
+// Sum of a[i]*b[i]; 2 FLOPs per element
+double simd_dot_f32(SimdIsa isa, const float* a, const float* b, size_t n);
+double simd_dot_f64(SimdIsa isa, const double* a, const double* b, size_t n);
+
+// `iters` rounds of multiply-add on every chain; returns a checksum to keep
+// the work alive. simd_fma_flops_per_iter() gives the FLOPs in one round.
+double simd_fma_f32(SimdIsa isa, size_t iters);
+double simd_fma_f64(SimdIsa isa, size_t iters);
+double simd_fma_flops_per_iter(SimdIsa isa, int dp);
+
+// Theoretical peak of one core: FLOPs per cycle at the ISA's vector width,
+// assuming two FMA pipes (one multiply + one add pipe for SSE2 and scalar)
+double simd_peak_flops_per_cycle(SimdIsa isa, int dp);
+// Core clock in GHz, measured on a dependent chain of single-cycle adds
+// (GCC/Clang on x86-64 and AArch64; MSVC reads the nominal clock); 0 if unknown
+double simd_clock_ghz(void);
@@ -0,0 +1,20 @@
+#pragma once
+#include "sweep.h"
+
+// Dense C = A*B on square row-major matrices: packed A/B panels blocked for
+// the caches, a register-blocked SIMD micro-kernel (ISA from BenchConfig.simd_isa)
+// and the team split over MC x NC macro-tiles of C. GFLOPS = 2*N^3 / time.
+
+int    gemm_prepare(void);            // matrices of BenchConfig.gemm_N + pack buffers (arena)
+double gemm_dgemm_gflops_once(void);  // f64, GFLOPS
+double gemm_sgemm_gflops_once(void);  // f32, GFLOPS
+void   gemm_teardown(void);
+
+// Theoretical peak of the current team, GFLOPS (cores x clock x FLOPs/cycle);
+// counts the physical cores the team can occupy, not its SMT threads
+double gemm_peak_gflops(int dp);
+
+// N = 128, 256 .. gemm_sweep_max on the current team, labels "D<N>" / "S<N>".
+// The GFLOPS sweep measures; the percent-of-peak sweep reports the same run.
+int gemm_gflops_sweep(SweepPoint* out, int cap);
+int gemm_peak_pct_sweep(SweepPoint* out, int cap);
@@ -1,2 +1,17 @@
 #pragma once
-double integer_mips_once(void);// Returns one measured value (MIPS) for the integer-mix workload
+
+// Integer workloads sized by BenchConfig.integer_block_bytes and integer_passes
+// (streaming kernels make integer_passes passes; sort and probe one pass over a
+// share of the block). Each probes a different part of the core, so a
+// regression points somewhere.
+
+double integer_mips_once(void);        // one dependent xor-mul-rotate chain: multiply latency, MIPS
+double integer_ilp_mips_once(void);    // eight independent chains: multiplier throughput, MIPS
+
+int    integer_prepare(void);          // pseudo-random block, sort scratch, hash table (arena)
+double integer_sort_mkeys_once(void);  // quicksort of 64Ki-key chunks (1/16 of the block), Mkeys/s
+double integer_probe_mops_once(void);  // hash probes (1/4 of the block), half hits, Mprobes/s
+double integer_crc32c_mbps_once(void); // CRC32C over the block (SSE4.2 or slicing-by-8), MB/s
+double integer_xxh64_mbps_once(void);  // XXH64 over the block, MB/s
+double integer_vector_mbps_once(void); // 32-bit lane shift/xor/add mix on the SIMD ISA, MB/s
+void   integer_teardown(void);
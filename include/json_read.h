@@ -0,0 +1,30 @@
+#pragma once
+#include <stddef.h>
+#include <stdio.h>
+
+// Small JSON reader for the suite's own result and reference files: a tree of
+// values, numbers as double, strings unescaped to UTF-8.
+
+typedef enum { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT } JsonType;
+
+typedef struct JsonValue {
+    JsonType          type;
+    double            number;   // JSON_NUMBER, JSON_BOOL (0/1)
+    char*             string;   // JSON_STRING
+    int               count;    // JSON_ARRAY items / JSON_OBJECT members
+    char**            keys;     // JSON_OBJECT member names
+    struct JsonValue* items;    // JSON_ARRAY items / JSON_OBJECT member values
+} JsonValue;
+
+// Parses one value from text (leading blanks skipped). Returns the position
+// after it, or NULL on a syntax error (out is then empty).
+const char* json_parse(const char* text, JsonValue* out);
+void        json_free(JsonValue* v);
+
+// Object member by name, or NULL
+const JsonValue* json_get(const JsonValue* obj, const char* key);
+double           json_get_number(const JsonValue* obj, const char* key, double fallback);
+const char*      json_get_string(const JsonValue* obj, const char* key);   // NULL if absent or not a string
+
+// Writes s as a quoted, escaped JSON string
+void json_write_string(FILE* f, const char* s);
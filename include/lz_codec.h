@@ -0,0 +1,29 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// LZ77 + canonical Huffman block codec (DEFLATE alphabets, 32 KiB window).
+// Blocks are independent and self-describing, so a stream is simply the
+// concatenation of blocks and any number of threads can encode or decode
+// different blocks at the same time, each with its own LzWork.
+
+#define LZ_LEVEL_MIN     1
+#define LZ_LEVEL_MAX     9
+#define LZ_BLOCK_HEADER  9      // type byte + raw length + payload length
+
+typedef struct LzWork LzWork;   // per-thread match finder and decoder scratch
+
+LzWork* lz_work_create(size_t max_block);
+void    lz_work_destroy(LzWork* w);
+
+// Worst-case encoded size of a block of n raw bytes (stored fallback)
+size_t lz_bound(size_t n);
+
+// Encodes one block; returns bytes written to dst (0 if cap < lz_bound(n))
+size_t lz_compress_block(LzWork* w, int level, const uint8_t* src, size_t n,
+    uint8_t* dst, size_t cap);
+
+// Decodes the block at src; *consumed receives its encoded size.
+// Returns raw bytes written, or (size_t)-1 on corrupt input / small dst.
+size_t lz_decompress_block(LzWork* w, const uint8_t* src, size_t avail, size_t* consumed,
+    uint8_t* dst, size_t cap);
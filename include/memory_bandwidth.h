@@ -0,0 +1,23 @@
+#pragma once
+#include <stddef.h>
+#include "sweep.h"
+
+// Access patterns of the bandwidth matrix, all over one buffer of 64-bit words
+typedef enum {
+    BW_READ,        // sequential read
+    BW_WRITE,       // sequential write
+    BW_RMW,         // sequential read-modify-write
+    BW_STRIDE64,    // one word per 64 bytes, every line visited once per pass
+    BW_STRIDE128,
+    BW_STRIDE4K,
+    BW_REVERSE,     // sequential read, high to low addresses
+    BW_PATTERNS
+} BwPattern;
+
+// MB/s for one pattern over a working set of `bytes`, split across the pool team.
+// huge = 1 backs the buffer with 2 MiB pages, 0 forces 4 KiB pages.
+double memory_bandwidth_mbps(BwPattern pattern, size_t bytes, int huge);
+
+// Bandwidth-vs-size curve per pattern, 4 KiB up to bwm_max_bytes (0 = 16x the
+// last-level cache), one point per octave; labels "<pattern>_<size>"
+int memory_bandwidth_sweep(SweepPoint* out, int cap);
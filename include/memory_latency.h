@@ -0,0 +1,9 @@
+#pragma once
+#include <stddef.h>
+#include "sweep.h"
+
+int    memory_random_prepare(void);                  // builds the graded chain once (arena)
+double memory_random_mops_once(void);                // dependent loads per microsecond (MOPS)
+void   memory_random_teardown(void);
+double memory_latency_ns(size_t bytes, int huge);    // ns per dependent load over a working set
+int    memory_latency_sweep(SweepPoint* out, int cap); // ns/access from 4 KiB up to latency_max_bytes
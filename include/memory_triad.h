@@ -1,3 +1,15 @@
 #pragma once
-double memory_mbps_once(void);       // Sequential Bandwidth
-double memory_random_mops_once(void); // Random Latency
\ No newline at end of file
+#include "sweep.h"
+
+// STREAM family, MB/s for one multi-threaded pass over shared arrays that the
+// team first-touches (each thread its own slice)
+int    memory_prepare(void);          // maps and fills A, B, C once per test and team size
+void   memory_teardown(void);         // unmaps them
+double memory_copy_mbps_once(void);   // A = B
+double memory_scale_mbps_once(void);  // A = s*B
+double memory_add_mbps_once(void);    // A = B + C
+double memory_mbps_once(void);        // A = B + s*C (Triad, graded)
+
+// Triad bandwidth for every CPU-node x memory-node pair (local vs remote);
+// uses its own pinned first-touch allocations
+int memory_numa_sweep(SweepPoint* out, int cap);
@@ -1,4 +1,18 @@
 #pragma once
+#include <stdio.h>
+#include <string.h>
+
 #define UNIT_MIPS   "MIPS"
 #define UNIT_MFLOPS "MFLOPS"
-#define UNIT_MBPS   "MB/s"
\ No newline at end of file
+#define UNIT_MBPS   "MB/s"
+
+// Unit of work behind a rate unit: "MB/s" -> "MB", "MIPS" -> "Minstr",
+// "GFLOPS" -> "GFLOP", "IOPS" -> "IOP". 0 if the unit is not a rate (ns, %, x).
+static inline int unit_of_work(const char* rate, char* out, size_t n) {
+    const size_t len = strlen(rate);
+    if (len > 2 && strcmp(rate + len - 2, "/s") == 0) snprintf(out, n, "%.*s", (int)(len - 2), rate);
+    else if (len > 3 && strcmp(rate + len - 3, "IPS") == 0) snprintf(out, n, "%.*sinstr", (int)(len - 3), rate);
+    else if (len > 3 && strcmp(rate + len - 3, "OPS") == 0) snprintf(out, n, "%.*s", (int)(len - 1), rate);
+    else return 0;
+    return 1;
+}
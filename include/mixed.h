@@ -0,0 +1,21 @@
+#pragma once
+#include "testcase.h"
+#include "stats.h"
+
+// "System under load": several suite tests at once, each on its own group of
+// pool workers, for a fixed duration. Every workload is first timed alone on
+// the same group size, so the mixed figure can be read relative to solo.
+
+#define MIXED_MAX_WORKLOADS 6
+
+typedef struct {
+    const TestCase* tc;       // in: test to run (hooks must not share state with another workload)
+    int             threads;  // in: workers for this workload
+    SampleStats     solo;     // out: repetitions alone
+    SampleStats     mixed;    // out: repetitions completed while every workload was running
+    int             ok;       // out: prepare succeeded
+} MixedWorkload;
+
+// Runs w[0..n) alone and then together, `seconds` per phase. Returns 0 if the
+// workloads could not be placed (too many, or no free worker groups).
+int mixed_run(MixedWorkload* w, int n, double seconds);
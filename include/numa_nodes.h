@@ -0,0 +1,20 @@
+#pragma once
+
+// NUMA node -> CPU map, read from /sys/devices/system/node on Linux.
+// Other platforms (and single-node Linux boxes) report one node holding
+// every logical CPU.
+
+#define NUMA_MAX_NODES 64
+#define NUMA_MAX_CPUS  512
+
+typedef struct {
+    int id;                     // kernel node number (nodeN)
+    int ncpus;
+    int cpus[NUMA_MAX_CPUS];    // logical CPU ids on this node
+} NumaNode;
+
+// Discovered once and cached; *count receives the number of nodes
+const NumaNode* numa_nodes(int* count);
+
+// Parses a kernel cpulist ("0-3,8,10-11"), returns the number of CPUs stored
+int numa_parse_cpulist(const char* s, int* cpus, int cap);
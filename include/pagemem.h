@@ -0,0 +1,11 @@
+#pragma once
+#include <stddef.h>
+
+// Page-granular allocations for working sets that care about TLB reach.
+// Huge pages are a request, not a guarantee: *got_huge reports the outcome.
+
+#define PAGE_SMALL 0
+#define PAGE_HUGE  1
+
+void* page_alloc(size_t bytes, int kind, int* got_huge);
+void  page_free(void* p, size_t bytes);
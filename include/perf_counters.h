@@ -0,0 +1,42 @@
+#pragma once
+#include <stdint.h>
+
+// Hardware performance counters around timed regions (Linux perf_event_open).
+// Every thread that enters a timed region (pool_timed_begin / timer_start)
+// counts its own user-space events until the region ends; the deltas are
+// summed into process-wide totals that the suite reads after each run.
+// Elsewhere, or when the PMU is hidden (VMs, perf_event_paranoid > 2),
+// perf_available() is 0 and all totals stay zero.
+
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_LLC_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_EVENT_COUNT
+} PerfEvent;
+
+typedef struct {
+    uint64_t count[PERF_EVENT_COUNT];   // scaled for multiplexing
+    int      valid[PERF_EVENT_COUNT];   // event could be opened on this machine
+    double   thread_seconds;            // summed region time of all counting threads
+} PerfTotals;
+
+// Derived per-test figures (MPKI = misses per 1000 instructions)
+typedef struct {
+    int    valid;                       // cycles and instructions were counted
+    double ipc;
+    double ghz;                         // effective clock: cycles / thread-seconds
+    double llc_mpki, dtlb_mpki, branch_mpki;   // negative when that event is missing
+} PerfSummary;
+
+int  perf_available(void);
+void perf_set_enabled(int on);          // off = begin/end are no-ops
+
+void perf_region_begin(void);           // calling thread starts counting
+void perf_region_end(void);             // calling thread stops and adds its deltas
+
+void perf_reset_totals(void);
+void perf_read_totals(PerfTotals* out);
+void perf_summarize(const PerfTotals* t, PerfSummary* out);
@@ -0,0 +1,23 @@
+#pragma once
+#include "testcase.h"
+
+// Plugin interface. A plugin is a shared library that exports
+//
+//     PLUGIN_EXPORT int pcbench_plugin_init(int abi, PluginAddFn add);
+//
+// It checks abi against PLUGIN_ABI_VERSION, calls add() once per test and
+// returns nonzero. add() copies the TestCase; the strings and hooks it points
+// to must live as long as the process (the library is never unloaded).
+// Hooks may use the arena and the worker pool like the built-in tests do.
+
+#define PLUGIN_ABI_VERSION 1
+#define PLUGIN_ENTRY       "pcbench_plugin_init"
+
+typedef int (*PluginAddFn)(const TestCase* tc);
+typedef int (*PluginInitFn)(int abi, PluginAddFn add);
+
+#ifdef _WIN32
+#define PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
@@ -1,19 +1,46 @@
 #pragma once
 
+// Reference medians the index (result / reference) is computed against.
+// They come from a versioned JSON database (BenchConfig.refs_path) holding one
+// entry per machine class, profile and thread count; without a matching entry
+// the tests' built-in references (TestCase.reference, STANDARD at one thread)
+// are used.
+
+#define REFS_FORMAT_VERSION 1
+#define REFS_MAX_TESTS      128
+#define REFS_MAX_CV         0.25    // references noisier than this run to run are not used
+
+// One calibrated reference value
 typedef struct {
-    double pref_integer_mips;   // ops/s ? MIPS
-    double pref_float_mflops;   // FLOPs/s ? MFLOPS
-    double pref_mem_mbps;       // MB/s  (Triad)
-    double pref_aes_mbps;       // MB/s  (encrypt)
-    double pref_comp_mbps;      // MB/s  (avg of comp+decomp)
-	double pref_latency_mops;   // MOPS (Memory Latency)
-	double pref_disk_mbps;      // MB/s  (Disk I/O)
-} BenchRefs;
+    char   id[16];              // test id
+    double median;              // median over the calibration runs
+    double cv;                  // run-to-run coefficient of variation
+} RefValue;
 
 #ifdef __cplusplus
 extern "C" {
 #endif
-    const BenchRefs* bench_refs_defaults(void);
+    // Picks the entry for machine_class ("" = this CPU's model), profile and
+    // threads (the team the graded tests run at) from the database at path,
+    // falling back to class "default", then to the built-in references.
+    // Entries calibrated at another thread count, and values whose stored CV
+    // exceeds REFS_MAX_CV, are skipped with a warning.
+    // Returns 1 when the database supplied the entry.
+    int refs_select(const char* path, const char* machine_class, const char* profile, int threads);
+
+    // Reference median for a test id in the selected entry (0 = none). Selects
+    // from the current BenchConfig first if nothing was selected yet.
+    double refs_lookup(const char* test_id);
+
+    // Where the selected references came from, for the report header
+    const char* refs_source(void);
+
+    // Adds or replaces the (machine_class, profile, threads) entry, keeping the others
+    int refs_write_entry(const char* path, const char* machine_class, const char* profile,
+        int threads, const RefValue* values, int count, int runs);
+
+    // Machine class used when none is configured: the CPU model
+    void refs_default_class(char* out, int max_len);
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
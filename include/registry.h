@@ -0,0 +1,43 @@
+#pragma once
+#include "testcase.h"
+
+#ifdef _WIN32
+#ifdef pcbench_EXPORTS
+#define API __declspec(dllexport)
+#else
+#define API __declspec(dllimport)
+#endif
+#else
+#define API
+#endif
+
+// Runtime test registry: the built-in tests, then whatever plugins add. The
+// suite, the CLI and the GUI all enumerate tests from here.
+//
+// A plugin is a shared library exporting PLUGIN_ENTRY (see plugin.h); it is
+// loaded once and never unloaded, so its TestCase strings and hooks stay valid.
+
+#define REGISTRY_MAX_TESTS 128
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    API int             registry_count(void);
+    API const TestCase* registry_get(int index);            // NULL past the end
+    API const TestCase* registry_find(const char* id);      // NULL if unknown
+    API const char*     registry_source(int index);         // "built-in" or the plugin's path
+
+    // Copies tc into the registry. 0 if the id is taken, a hook or a name is
+    // missing, or the registry is full.
+    API int registry_add(const TestCase* tc);
+
+    // Returns the number of tests the plugin added, or -1 if it could not be
+    // loaded or refused to initialise.
+    API int registry_load_plugin(const char* path);
+
+    // Loads every shared library in dir; a missing directory is not an error.
+    // Returns the number of tests added.
+    API int registry_load_plugin_dir(const char* dir);
+#ifdef __cplusplus
+}
+#endif
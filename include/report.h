@@ -0,0 +1,42 @@
+#pragma once
+#include <stdio.h>
+#include "stats.h"
+#include "perf_counters.h"
+#include "telemetry.h"
+#include "run_env.h"
+
+// Results sink chosen by BenchConfig.output_format; forwards to the CSV or
+// JSON writer so the suite reports through one call.
+
+typedef struct {
+    FILE*  f;
+    int    format;                              // REPORT_CSV, REPORT_JSON or REPORT_JSONL
+    int    rows;                                // rows written so far
+    RunEnv env;                                 // captured when the report opens
+} Report;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    Report* report_begin(const char* path, int format);   // NULL if the file cannot be opened
+    void    report_write(Report* r,
+        const char* id,
+        const char* title,
+        const char* unit,
+        int threads,
+        const SampleStats* s,
+        const double* samples,                  // s->n values in run order, or NULL (JSON only)
+        double thread_min, double thread_max,
+        double efficiency,
+        double index,                           // result / reference; 0 = no reference (empty, null)
+        const PerfSummary* perf,
+        const TelemetrySummary* tele);          // NULL or invalid = no telemetry
+    void    report_end(Report* r);
+
+    // Creates the directory part of path (one level), if any
+    void    report_ensure_dir(const char* path);
+
+#ifdef __cplusplus
+}
+#endif
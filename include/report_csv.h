@@ -1,16 +1,25 @@
 #pragma once
 #include <stdio.h>
+#include "stats.h"
+#include "perf_counters.h"
+#include "telemetry.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-    FILE* report_csv_begin(const char* path);  // opens/creates file and writes header if empty
+    FILE* report_csv_begin(const char* path);  // opens/creates file and writes header if empty or outdated
     void   report_csv_write(FILE* f,
         const char* id,
         const char* title,
         const char* unit,
-        double avg, double minv, double maxv, double index);
+        int threads,
+        const SampleStats* s,                   // distribution over the repetitions
+        double thread_min, double thread_max,   // per-thread throughput extremes
+        double efficiency,                      // speedup / threads
+        double index,
+        const PerfSummary* perf,                // NULL or invalid = empty counter columns
+        const TelemetrySummary* tele);          // NULL or invalid = empty telemetry columns
     void   report_csv_end(FILE* f);
 
 #ifdef __cplusplus
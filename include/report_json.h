@@ -0,0 +1,29 @@
+#pragma once
+#include "report.h"
+
+// JSON document (REPORT_JSON, rewritten each run) or JSON Lines (REPORT_JSONL,
+// appended): the run record (id, time, host, build, CPU, OS tuning, effective
+// BenchConfig) and every result with its per-sample values.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    int   report_json_begin(Report* r, const char* path);  // opens r->f; 0 on failure
+    void  report_json_write(Report* r,
+        const char* id,
+        const char* title,
+        const char* unit,
+        int threads,
+        const SampleStats* s,
+        const double* samples,
+        double thread_min, double thread_max,
+        double efficiency,
+        double index,
+        const PerfSummary* perf,                // NULL or invalid = "perf": null
+        const TelemetrySummary* tele);          // NULL or invalid = "telemetry": null
+    void  report_json_end(Report* r);            // closes the document and the file
+
+#ifdef __cplusplus
+}
+#endif
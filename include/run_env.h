@@ -0,0 +1,37 @@
+#pragma once
+
+// Everything a result needs so rows from different machines, builds and
+// configurations can be told apart once collected. Captured once per run
+// when the report opens; the hardware half comes from sysinfo_get().
+// Strings are "" and numbers -1 when unknown.
+
+typedef struct {
+    char run_id[40];            // random UUID (version 4)
+    char timestamp[32];         // run start, UTC, ISO 8601
+    char host[128];
+    char os[128];               // "Linux 6.8.0-45-generic"
+    char os_version[128];       // kernel build string (uname -v) or Windows build
+    char arch[32];
+    char compiler[128];
+    char build_type[32];
+    char build_flags[256];
+    char cpu_vendor[16];
+    char cpu_model[128];
+    char cpu_flags[256];        // ISA extensions the kernels dispatch on
+    char governor[32];          // cpufreq governor of cpu0
+    int  turbo;                 // 1 = boost enabled, 0 = disabled
+    int  cpu_max_mhz;
+    int  logical_cpus;
+    int  physical_cores;
+    int  packages;
+    int  smt_active;            // 1 = SMT siblings online, 0 = off
+    long l1d_kb, l2_kb, l3_kb;  // per instance
+    long ram_mb;
+    char gpu[128];
+    char thp[16];               // transparent huge pages: always, madvise, never
+    long hugepages_total;       // reserved huge pages
+    long hugepage_kb;           // their size
+    int  profile;               // 0 = QUICK, 1 = STANDARD, 2 = EXTREME
+} RunEnv;
+
+void run_env_capture(RunEnv* env);
@@ -0,0 +1,33 @@
+#pragma once
+
+// Robust summary of repeated measurements of one test.
+// The median is the headline figure: one descheduled run cannot move it.
+
+#define STATS_CI_LEVEL   0.95   // two-sided confidence level of ci_lo..ci_hi
+#define STATS_BOOTSTRAP  1000   // resamples for the bootstrap interval
+
+typedef struct {
+    int    n;
+    double mean, median, stddev;
+    double cv;                  // stddev / mean (coefficient of variation)
+    double minv, maxv, p5, p95;
+    double ci_lo, ci_hi;        // percentile-bootstrap CI of the median
+} SampleStats;
+
+// Summarizes n samples (n >= 1); v is not modified
+void stats_summarize(const double* v, int n, SampleStats* out);
+
+// Percentile (p in 0..1) of sorted data, linear interpolation between ranks
+double stats_percentile(const double* sorted, int n, double p);
+
+// CI width relative to the median, the convergence test for adaptive runs
+double stats_ci_rel_width(const SampleStats* s);
+
+// Two-sided Mann-Whitney U test of a against b (normal approximation with tie
+// and continuity correction). Returns the p-value; *effect (optional) receives
+// the rank-biserial correlation, +1 when every a exceeds every b.
+double stats_mann_whitney(const double* a, int na, const double* b, int nb, double* effect);
+
+// Smallest p-value stats_mann_whitney can return for na and nb values (every
+// a above every b, no ties). Above alpha, the test cannot reject at all.
+double stats_mann_whitney_min_p(int na, int nb);
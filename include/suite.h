@@ -12,15 +12,12 @@
 
 typedef void (*StatusCallback)(int progress, double score);
 
-// IDs for the tests
-#define TEST_INTEGER 0
-#define TEST_FLOAT   1
-#define TEST_MEMORY  2
-#define TEST_AES     3
-#define TEST_COMP    4
-#define TEST_MEMORY_LATENCY 5
-#define TEST_DISK    6
-
-API void run_test_by_id(int id, StatusCallback cb);
-API double get_test_reference(int id);
-API void suite_run_all(void);
\ No newline at end of file
+// Tests are named by their registry id ("INT", "MEM", ...; see registry.h)
+API void run_test_by_id(const char* id, StatusCallback cb);
+API double get_test_reference(const char* id);   // 0 = no reference
+API void suite_run_all(void);                 // the tests and sweeps selected by BenchConfig.tests
+API int  suite_has_id(const char* id);        // 1 if id names a test or a sweep
+API void suite_print_registry(void);          // id, unit and title of every test and sweep
+API int  suite_calibrate(int runs);           // writes a reference entry; returns the number of tests in it
+API int  suite_threads(void);                // team the graded tests run at (BenchConfig.threads resolved)
+API double suite_work_fraction(void);       // share of its full work a TC_WORK_SCALES run_once does (1 = all)
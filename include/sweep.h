@@ -0,0 +1,13 @@
+#pragma once
+
+// One point of a parameter sweep (working-set size, queue depth, matrix N...).
+// Sweeps are reported as extra rows next to the graded tests.
+typedef struct {
+    char   label[32];   // short tag appended to the test id, e.g. "4K", "QD32"
+    double x;           // swept parameter in its natural unit
+    double value;       // measured metric at that point
+    int    threads;     // threads the point ran on; 0 = the team the sweep was started with
+} SweepPoint;
+
+// Fills up to cap points, returns how many were written
+typedef int (*SweepFn)(SweepPoint* out, int cap);
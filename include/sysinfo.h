@@ -1,4 +1,6 @@
 #pragma once
+#include <stddef.h>
+
 #ifdef _WIN32
 #ifdef pcbench_EXPORTS
 #define API __declspec(dllexport)
@@ -9,4 +11,47 @@
 #define API
 #endif
 
-API void get_system_info_str(char* buffer, int max_len);
\ No newline at end of file
+// Host description read in-process: /proc/cpuinfo, /proc/meminfo and
+// /sys/devices/system/cpu on Linux, CPUID on x86, sysctl on macOS and the
+// Win32 API on Windows. Nothing is spawned. Strings are "" and numbers -1
+// when unknown (cache sizes 0).
+typedef struct {
+    char      os[128];              // "Linux 6.8.0-45-generic"
+    char      os_version[128];      // kernel build string (uname -v) or Windows build
+    char      host[128];
+
+    char      cpu_vendor[16];       // "GenuineIntel", "AuthenticAMD", ...
+    char      cpu_model[128];       // brand string
+    int       cpu_family, cpu_model_id, cpu_stepping;
+    int       logical_cpus;
+    int       physical_cores;
+    int       packages;
+    int       smt_active;           // 1 = SMT siblings online, 0 = off
+    char      isa_flags[256];       // what the kernels dispatch on (cpu_features_str)
+
+    // Per instance, as seen from CPU 0
+    size_t    l1d_bytes, l1i_bytes, l2_bytes, l3_bytes;
+    size_t    llc_bytes;            // largest data/unified level present
+    int       llc_level;
+    int       llc_instances;        // L3 (or LLC) slices in the machine
+    int       cache_line;
+
+    char      governor[32];         // cpufreq governor of cpu0
+    int       turbo;                // 1 = boost enabled, 0 = disabled
+    int       base_mhz, min_mhz, max_mhz;
+
+    long long ram_bytes;
+    long long ram_available_bytes;
+    char      thp[16];              // transparent huge pages: always, madvise, never
+    long      hugepages_total;      // reserved huge pages
+    long      hugepages_free;
+    long      hugepage_kb;          // their size
+
+    char      gpu[128];             // first display adapter
+} SystemInfo;
+
+// Collected once and cached
+API const SystemInfo* sysinfo_get(void);
+
+// Multi-line summary for the report header and the GUI sidebar
+API void get_system_info_str(char* buffer, int max_len);
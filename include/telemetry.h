@@ -0,0 +1,56 @@
+#pragma once
+
+// Clock, temperature and energy sampled in the background while tests run
+// (Linux: cpufreq scaling_cur_freq, hwmon or thermal zones, thermal_throttle
+// counts, RAPL package and DRAM energy from powercap or else the MSRs). A
+// sampler thread takes one reading every interval; the suite brackets each
+// timed sample with a window and gets back what fell inside it. Energy is read
+// exactly at the window edges, so it needs no sampler. Elsewhere, or when no
+// source is readable, telemetry_available() is 0 and every window comes back invalid.
+
+typedef struct {
+    int    valid;               // at least one source was read
+    int    ticks;               // readings inside the window (the closing one included)
+    double seconds;
+    double mhz;                 // mean clock of the watched CPUs; < 0 unknown
+    double mhz_min;             // slowest reading
+    double temp_c;              // hottest package reading; < 0 unknown
+    double pkg_joules;          // RAPL package energy, all packages; < 0 unknown
+    double dram_joules;         // RAPL DRAM energy; < 0 unknown
+    long   throttle_events;     // kernel thermal-throttle count delta; < 0 unknown
+    int    throttled;           // set by telemetry_summarize
+} TelemetryWindow;
+
+// Per-test figures over its timed samples
+typedef struct {
+    int    valid;
+    double mhz;                 // mean over samples; < 0 unknown
+    double mhz_min;             // slowest sample
+    double temp_c;              // hottest sample; < 0 unknown
+    double pkg_watts;           // mean package power; < 0 unknown
+    double dram_watts;          // mean DRAM power; < 0 unknown
+    double work_per_joule;      // median throughput / (package + DRAM) power: MB/J for MB/s; < 0 unknown
+    double joules_per_work;     // its inverse: J per MB, per million instructions, ...
+    int    throttled;           // samples flagged
+    int    n;
+    const TelemetryWindow* windows;   // n per-sample windows (owned by the caller)
+} TelemetrySummary;
+
+// interval_ms <= 0: no sampler; energy = 0: no RAPL. 1 if any source is open.
+int  telemetry_start(int interval_ms, int energy);
+void telemetry_stop(void);
+int  telemetry_available(void);             // sources open
+const char* telemetry_sources(void);        // "cpufreq, coretemp, RAPL powercap" or ""
+
+// CPUs a pinned team runs on, in the order threads take them; n == 0 = unpinned
+void telemetry_watch(const int* cpus, int n);
+
+// The clock is the mean over the first `threads` watched CPUs or, unpinned,
+// over the `threads` fastest online CPUs at each reading (the team's busy cores)
+void telemetry_window_begin(int threads);
+void telemetry_window_end(TelemetryWindow* out);
+
+// Flags throttled samples (clock more than 10% under the test's fastest sample,
+// or a kernel throttle event) and averages the rest of the figures.
+// median is the test's median throughput, for the per-joule figures.
+void telemetry_summarize(TelemetryWindow* w, int n, double median, TelemetrySummary* out);
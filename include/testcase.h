@@ -1,8 +1,23 @@
 #pragma once
+
+// Lifecycle of one suite test. prepare() runs once per measurement (after the
+// team size is set) and builds every buffer from the arena; run_once() is a
+// single timed repetition; teardown() drops what prepare built.
+// prepare and teardown are optional (NULL).
 typedef struct {
-	const char* id;           // "integer", "float", "memory", "aes", "compress", latency", "disk"
+	const char* id;           // "INT", "FP", "MEM", ...
     const char* title;        // human-readable
-    void (*prepare)(void);    // allocate/fill data, optional warm-up
-    void (*run_once)(void);   // one repetition (unit of work)
     const char* unit;         // "MIPS", "MFLOPS", "MB/s"
+    int    (*prepare)(void);  // allocate/fill data; 0 = cannot run
+    double (*run_once)(void); // one repetition, returns throughput
+    void   (*teardown)(void);
+    double reference;         // built-in reference for the index; 0 = none (a refs database entry overrides it)
+    int    flags;             // TC_* below
 } TestCase;
+
+// TestCase.flags
+#define TC_SCALES       0x1   // run_once splits its work across the pool team (pool-safe)
+#define TC_GRADED       0x2   // counts toward the final grade
+#define TC_SELF_WARMING 0x4   // warms itself up; no unmeasured pass before single-test runs
+#define TC_NO_MIX       0x8   // keeps process-wide state; never runs alongside another test
+#define TC_WORK_SCALES  0x10  // run_once does suite_work_fraction() of its full work (time-boxed samples)
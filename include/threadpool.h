@@ -0,0 +1,52 @@
+#pragma once
+
+// Persistent worker pool shared by every module.
+// Workers are created once and reused, so thread start-up never lands
+// inside a timed region. A "team" is the first N workers of the pool;
+// the suite chooses the team size, modules just call pool_run().
+
+#define POOL_MAX_THREADS 512
+
+typedef void (*PoolTask)(int tid, int nthreads, void* arg);
+
+typedef struct {
+    int    threads;      // team size of the last run
+    double wall_s;       // first timed start -> last timed end
+    double units;        // total work units reported by all threads
+    double thread_min;   // slowest thread throughput (units/s)
+    double thread_max;   // fastest thread throughput (units/s)
+} PoolStats;
+
+int  pool_hw_threads(void);          // logical CPUs online
+void pool_set_team(int nthreads);    // team size for subsequent pool_run() calls
+int  pool_team(void);
+
+// CPU map of the current team: member i runs pinned to cpus[i % n], applied by
+// each worker before its next task. n = 0 lets the workers float again.
+void pool_set_affinity(const int* cpus, int n);
+
+// Runs task(tid, team, arg) on every team member and blocks until all return.
+void pool_run(PoolTask task, void* arg);
+
+// Worker groups for concurrent workloads. Binding gives the calling thread its
+// own group on workers [first_worker, first_worker + width) with a team of
+// nthreads: its pool_run(), pool_set_team(), pool_team() and pool_last_stats()
+// then use that group, and pool_set_team() never widens the team past width, so
+// threads bound to disjoint ranges run side by side. Returns 0 if no group is
+// free or the range overlaps another bound group's.
+int  pool_group_bind(int first_worker, int width, int nthreads);
+void pool_group_unbind(void);
+
+// Called by a task: waits on the start barrier, then stamps the thread start.
+void pool_timed_begin(int tid);
+// Called by a task: stamps the thread end and records the work it completed.
+void pool_timed_end(int tid, double units);
+// Plain barrier across the current team (e.g. between init and timed phase).
+void pool_sync(void);
+// Pins the calling thread to one logical CPU; cpu < 0 restores the process's
+// start-up affinity (taskset / cpuset), a no-op if the thread is not pinned.
+// Returns 1 on success, 0 where affinity is unsupported.
+int  pool_pin_self(int cpu);
+
+// Aggregate throughput (units/s) of the last run, with per-thread min/max.
+double pool_last_stats(PoolStats* out);
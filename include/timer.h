@@ -1,3 +1,4 @@
 #pragma once
-void timer_start(void);
-double timer_elapsed_seconds(void);  // seconds since last start
+void timer_start(void);                // also starts this thread's perf counters
+double timer_elapsed_seconds(void);  // seconds since last start (stops the counters)
+double timer_now_seconds(void);      // monotonic timestamp, thread-safe
@@ -0,0 +1,72 @@
+#pragma once
+
+#ifdef _WIN32
+#ifdef pcbench_EXPORTS
+#define API __declspec(dllexport)
+#else
+#define API __declspec(dllimport)
+#endif
+#else
+#define API
+#endif
+
+// CPU topology from /sys/devices/system/cpu on Linux: packages, physical
+// cores, SMT siblings, core types of hybrid parts and the CPUs sharing each
+// L2/L3. Other platforms report every logical CPU as its own core in one package.
+
+#define TOPO_MAX_CPUS   512
+#define TOPO_MAX_CACHES 256
+
+// Core types; hybrid parts mix PERF and EFF
+#define CORE_TYPE_DEFAULT 0
+#define CORE_TYPE_PERF    1     // Intel P-core, Arm big
+#define CORE_TYPE_EFF     2     // Intel E-core, Arm LITTLE
+#define CORE_TYPE_COUNT   3
+
+typedef struct {
+    int cpu;            // logical CPU id
+    int package;        // physical_package_id
+    int core;           // physical core, numbered from 0 across packages
+    int smt;            // thread index within its core (0 = first sibling)
+    int node;           // NUMA node
+    int type;           // CORE_TYPE_*
+} TopoCpu;
+
+typedef struct {
+    int  level;         // 2, 3 (L1 is private to a core's SMT siblings)
+    int  size_kb;
+    int  ncpus;         // logical CPUs sharing this instance
+    char cpus[64];      // their kernel cpulist, e.g. "0-15"
+} TopoCache;
+
+typedef struct {
+    int       ncpus;        // online logical CPUs
+    int       npackages;
+    int       ncores;       // physical cores
+    int       smt;          // most threads on one core (1 = no SMT)
+    int       hybrid;       // 1 if more than one core type
+    int       cores_of_type[CORE_TYPE_COUNT];
+    TopoCpu   cpus[TOPO_MAX_CPUS];         // by ascending logical id
+    int       ncaches;
+    TopoCache caches[TOPO_MAX_CACHES];     // one entry per distinct instance
+} Topology;
+
+// Discovered once and cached
+API const Topology* topology_get(void);
+
+// "P-core", "E-core" or "core"; short names "P", "E", "" for result ids
+const char* topology_type_name(int type);
+const char* topology_type_short(int type);
+
+// One line for the report header, e.g.
+// "1 package, 14 cores, 20 threads (2-way SMT), 6 P-core + 8 E-core, L3 24 MB x1"
+API void topology_summary(char* out, int max_len);
+
+// Logical CPUs for a pinning policy, in the order threads take them:
+//   "none"   no pinning (returns 0)
+//   "cores"  the first thread of every physical core
+//   "smt"    every logical CPU, a core's siblings next to each other
+//   a cpulist such as "0-3,8"
+// type >= 0 keeps only cores of that CORE_TYPE_*. Returns the count, or -1 if
+// the policy does not parse.
+int topology_pin_set(const char* policy, int type, int* out, int cap);
@@ -1,15 +1,160 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "controller.h"
 #include "sysinfo.h"
+#include "suite.h"
 #include "config.h"
+#include "compare.h"
+#include "registry.h"
 
-int main(void) {
-    // Get and print system info
-    char info_buffer[512];
+static void usage(const char* argv0) {
+    printf("Usage: %s [options]\n", argv0);
+    printf("Without options the profile and thread mode are asked for interactively.\n\n");
+    printf("  --list                    print the test and sweep ids (plugins included), then exit\n");
+    printf("  --list-config             print every configuration field and its value, then exit\n");
+    printf("  --profile P               quick|standard|extreme (or 0|1|2), default standard\n");
+    printf("  --tests IDS               comma-separated ids to run, e.g. INT,MEM,DSK (default: all)\n");
+    printf("  --threads N               N, all, half, or sweep (1,2,4..all)\n");
+    printf("  --pin POLICY              pin threads: none, cores (one per physical core),\n");
+    printf("                            smt (fill SMT siblings) or a cpulist such as 0-3,8\n");
+    printf("  --pin-tests ID:P;ID:P     per-test pinning, e.g. \"RND:2;MEM:smt\"\n");
+    printf("  --core-types 0|1          extra rows per core type on hybrid CPUs (default 1)\n");
+    printf("  --telemetry-ms N          clock/temperature sampling interval, 0 = off (default 100)\n");
+    printf("  --energy 0|1              RAPL package/DRAM energy per sample: W, J per unit of work (default 1)\n");
+    printf("  --bwm-max-bytes SIZE      largest working set of the BWM bandwidth matrix (default 0 = 16x LLC)\n");
+    printf("  --bwm-hugepages 0|1       BWM buffer on 2 MiB pages instead of 4 KiB (default 0)\n");
+    printf("  --duration S              seconds per test, time-boxed; 0 = fixed runs\n");
+    printf("  --runs K                  K fixed runs per test (not with a non-zero --duration)\n");
+    printf("  --mixed IDS               also run these tests together (mixed-load mode)\n");
+    printf("  --output PATH             results file (default results/run.csv, run.json, runs.jsonl)\n");
+    printf("  --format csv|json|jsonl   results format; JSON adds the environment and per-sample values\n");
+    printf("  --set FIELD=VALUE         set any configuration field (see --list-config)\n");
+    printf("  --FIELD VALUE             same, e.g. --triad-N 64M --disk-dir /mnt/scratch\n");
+    printf("  --plugin PATH             load tests from this shared library (repeatable)\n");
+    printf("  --plugin-dir DIR          load every plugin in DIR (default plugins; \"\" = none)\n");
+    printf("  --help                    this text\n\n");
+    printf("References (index = result / reference, grade = geometric mean of the indices):\n");
+    printf("  --refs-path PATH          reference database (default refs/references.json)\n");
+    printf("  --ref-class NAME          machine class to grade against (default: this CPU's model)\n");
+    printf("  --calibrate N             run the selected tests N times and store their medians as\n");
+    printf("                            the references of this class and profile, then exit\n\n");
+    printf("Comparing results (exit status 3 if any metric regressed):\n");
+    printf("  --compare BASE NEW...     compare result files (JSON, JSON Lines or CSV) against BASE\n");
+    printf("  --compare-baseline NEW    compare against the stored baseline of NEW's host\n");
+    printf("  --save-baseline FILE      store FILE as its host's baseline (in %s/)\n", COMPARE_BASELINE_DIR);
+    printf("  --threshold PCT           smallest change that counts (default %.0f)\n", 100.0 * COMPARE_DEFAULT_THRESHOLD);
+    printf("  --alpha P                 significance level of the U test (default %g)\n", COMPARE_DEFAULT_ALPHA);
+}
+
+#define EXIT_REGRESSION 3
+
+// Returns the exit status, or -1 when no comparison option was given
+static int run_compare(int argc, char** argv) {
+    double threshold = COMPARE_DEFAULT_THRESHOLD, alpha = COMPARE_DEFAULT_ALPHA;
+    const char* files[64];
+    int nfiles = 0, mode = 0;   // 1 = files, 2 = baseline, 3 = save
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]) / 100.0;
+        } else if (strcmp(argv[i], "--alpha") == 0 && i + 1 < argc) {
+            alpha = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--compare") == 0) {
+            mode = 1;
+            while (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0 && nfiles < 64) files[nfiles++] = argv[++i];
+        } else if ((strcmp(argv[i], "--compare-baseline") == 0 || strcmp(argv[i], "--save-baseline") == 0) && i + 1 < argc) {
+            mode = (argv[i][2] == 'c') ? 2 : 3;
+            files[0] = argv[++i];
+            nfiles = 1;
+        }
+    }
+    if (mode == 0) return -1;
+    if (mode == 3) return save_baseline(files[0]) ? 0 : 2;
+
+    int regressions;
+    if (mode == 2) {
+        regressions = compare_with_baseline(files[0], threshold, alpha);
+    } else if (nfiles < 2) {
+        fprintf(stderr, "--compare needs a baseline and at least one more result file\n");
+        return 2;
+    } else {
+        regressions = compare_files(files, nfiles, threshold, alpha);
+    }
+    if (regressions < 0) return 2;
+    return regressions > 0 ? EXIT_REGRESSION : 0;
+}
+
+static void print_config(void) {
+    const BenchConfig* cfg = bench_config_defaults();
+    int n = 0;
+    const ConfigField* f = bench_config_fields(&n);
+    for (int i = 0; i < n; ++i) {
+        const char* p = (const char*)cfg + f[i].offset;
+        printf("  %-22s ", f[i].name);
+        switch (f[i].type) {
+        case CFG_INT:    printf("%d\n", *(const int*)p); break;
+        case CFG_SIZE:   printf("%zu\n", *(const size_t*)p); break;
+        case CFG_DOUBLE: printf("%g\n", *(const double*)p); break;
+        case CFG_STR:    printf("\"%s\"\n", p); break;
+        }
+    }
+}
+
+static int parse_profile(const char* v) {
+    if (strcmp(v, "quick") == 0 || strcmp(v, "0") == 0) return 0;
+    if (strcmp(v, "standard") == 0 || strcmp(v, "1") == 0) return 1;
+    if (strcmp(v, "extreme") == 0 || strcmp(v, "2") == 0) return 2;
+    return -1;
+}
+
+// Thread mode as the interactive prompt takes it: N, 0 = all, -1 = half, -2 = sweep
+static int parse_threads(const char* v, int* mode) {
+    if (strcmp(v, "all") == 0) *mode = THREADS_ALL;
+    else if (strcmp(v, "half") == 0) *mode = THREADS_HALF;
+    else if (strcmp(v, "sweep") == 0) *mode = -2;
+    else {
+        char* end = NULL;
+        const long n = strtol(v, &end, 10);
+        if (end == v || *end != '\0' || n < -2) return 0;
+        *mode = (int)n;
+    }
+    return 1;
+}
+
+static void apply_threads(int mode) {
+    BenchConfig* cfg = bench_config_defaults();
+    cfg->thread_sweep = (mode == -2);
+    cfg->threads = (mode == -2) ? THREADS_ALL : mode;
+}
+
+// "--triad-N" -> "triad_N"
+static void option_to_field(const char* opt, char* out, size_t n) {
+    size_t i = 0;
+    for (; opt[i] && i < n - 1; ++i) out[i] = (opt[i] == '-') ? '_' : opt[i];
+    out[i] = '\0';
+}
+
+static int set_field(const char* name, const char* value) {
+    if (bench_config_set(name, value)) return 1;
+    int n = 0;
+    const ConfigField* f = bench_config_fields(&n);
+    for (int i = 0; i < n; ++i) {
+        if (strcmp(f[i].name, name) == 0) {
+            fprintf(stderr, "Invalid value '%s' for %s\n", value, name);
+            return 0;
+        }
+    }
+    fprintf(stderr, "Unknown option or field '%s' (see --help, --list-config)\n", name);
+    return 0;
+}
+
+static void print_system_info(void) {
+    char info_buffer[1024];
     get_system_info_str(info_buffer, sizeof(info_buffer));
     printf("=== System Info ===\n%s\n\n", info_buffer);
+}
 
-    
+static int run_interactive(void) {
     int profile = -1;
     printf("Choose profile to run:\n");
     printf("  0 - QUICK\n");
@@ -25,11 +170,183 @@ int main(void) {
         return 1;
     }
 
-    
+
+    int threads = 1;
+    printf("\nThreads per test:\n");
+    printf("  N  - exactly N threads\n");
+    printf("  0  - all logical cores\n");
+    printf("  -1 - half of the logical cores\n");
+    printf("  -2 - sweep 1,2,4..all and report scaling\n");
+    printf("Enter thread mode: ");
+    if (scanf("%d", &threads) != 1 || threads < -2) {
+        fprintf(stderr, "Invalid thread mode.\n");
+        return 1;
+    }
+
     const char* names[] = { "QUICK (0)", "STANDARD (1)", "EXTREME (2)" };
     printf("\n>>> RUNNING PROFILE: %s <<<\n", names[profile]);
     set_config_profile(profile);
+    apply_threads(threads);
     run_suite();
+    return 0;
+}
 
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            usage(argv[0]);
+            return 0;
+        }
+    }
+
+    const int compared = run_compare(argc, argv);
+    if (compared >= 0) return compared;
+
+    if (argc < 2) {
+        registry_load_plugin_dir(bench_config_defaults()->plugin_dir);
+        print_system_info();
+        return run_interactive();
+    }
+
+    // The profile sets the baseline; every other option overrides it, in order
+    int profile = 1;
+    for (int i = 1; i < argc; ++i) {
+        const char* v = NULL;
+        if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) v = argv[i + 1];
+        else if (strncmp(argv[i], "--profile=", 10) == 0) v = argv[i] + 10;
+        if (!v) continue;
+        profile = parse_profile(v);
+        if (profile < 0) {
+            fprintf(stderr, "Unknown profile '%s' (quick, standard, extreme)\n", v);
+            return 2;
+        }
+    }
+    set_config_profile(profile);
+
+    BenchConfig* cfg = bench_config_defaults();
+    int list = 0, list_config = 0, output_set = 0, calibrate = 0;
+    const char* duration = NULL;   // --duration and --runs exclude each other
+    int runs_set = 0;
+    const char* plugins[16];
+    int nplugins = 0;
+    for (int i = 1; i < argc; ++i) {
+        const char* opt = argv[i];
+        if (strcmp(opt, "--list") == 0) {
+            list = 1;
+            continue;
+        }
+        if (strcmp(opt, "--list-config") == 0) {
+            list_config = 1;
+            continue;
+        }
+        if (strncmp(opt, "--", 2) != 0) {
+            fprintf(stderr, "Unexpected argument '%s' (see --help)\n", opt);
+            return 2;
+        }
+
+        // --name=value or --name value
+        char name[64];
+        const char* value = NULL;
+        const char* eq = strchr(opt, '=');
+        if (eq) {
+            snprintf(name, sizeof(name), "%.*s", (int)(eq - opt - 2), opt + 2);
+            value = eq + 1;
+        } else {
+            snprintf(name, sizeof(name), "%s", opt + 2);
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Option %s needs a value\n", opt);
+                return 2;
+            }
+            value = argv[++i];
+        }
+
+        if (strcmp(name, "profile") == 0) continue;   // applied above
+        if (strcmp(name, "tests") == 0) {
+            if (!set_field("tests", value)) return 2;
+        } else if (strcmp(name, "threads") == 0) {
+            int mode = 1;
+            if (!parse_threads(value, &mode)) {
+                fprintf(stderr, "Invalid thread mode '%s' (N, all, half, sweep)\n", value);
+                return 2;
+            }
+            apply_threads(mode);
+        } else if (strcmp(name, "duration") == 0) {
+            if (!set_field("test_seconds", value)) return 2;
+            duration = value;
+        } else if (strcmp(name, "runs") == 0) {
+            if (!set_field("repetitionsK", value)) return 2;
+            runs_set = 1;
+        } else if (strcmp(name, "plugin") == 0) {
+            if (nplugins == (int)(sizeof(plugins) / sizeof(plugins[0]))) {
+                fprintf(stderr, "Too many --plugin options\n");
+                return 2;
+            }
+            plugins[nplugins++] = value;
+        } else if (strcmp(name, "calibrate") == 0) {
+            calibrate = atoi(value);
+            if (calibrate < 1) {
+                fprintf(stderr, "--calibrate needs a run count of at least 1\n");
+                return 2;
+            }
+        } else if (strcmp(name, "mixed") == 0) {
+            if (!set_field("mixed_tests", value)) return 2;
+        } else if (strcmp(name, "output") == 0) {
+            if (!set_field("output_path", value)) return 2;
+            output_set = 1;
+        } else if (strcmp(name, "format") == 0) {
+            if (strcmp(value, "csv") == 0) cfg->output_format = REPORT_CSV;
+            else if (strcmp(value, "json") == 0) cfg->output_format = REPORT_JSON;
+            else if (strcmp(value, "jsonl") == 0) cfg->output_format = REPORT_JSONL;
+            else {
+                fprintf(stderr, "Unknown format '%s' (csv, json, jsonl)\n", value);
+                return 2;
+            }
+        } else if (strcmp(name, "set") == 0) {
+            const char* sep = strchr(value, '=');
+            if (!sep) {
+                fprintf(stderr, "--set takes FIELD=VALUE\n");
+                return 2;
+            }
+            char field[64];
+            snprintf(field, sizeof(field), "%.*s", (int)(sep - value), value);
+            if (!set_field(field, sep + 1)) return 2;
+        } else {
+            char field[64];
+            option_to_field(name, field, sizeof(field));
+            if (!set_field(field, value)) return 2;
+        }
+    }
+    if (runs_set && duration && cfg->test_seconds > 0.0) {
+        fprintf(stderr, "--runs and --duration %s exclude each other: use one (--duration 0 = fixed runs)\n", duration);
+        return 2;
+    }
+    if (runs_set) cfg->test_seconds = 0.0;   // fixed runs were asked for
+    if (!output_set && cfg->output_format == REPORT_JSON) {
+        snprintf(cfg->output_path, sizeof(cfg->output_path), "results/run.json");
+    } else if (!output_set && cfg->output_format == REPORT_JSONL) {
+        snprintf(cfg->output_path, sizeof(cfg->output_path), "results/runs.jsonl");
+    }
+
+    // Plugins first: --list and the test selection must see their ids
+    registry_load_plugin_dir(cfg->plugin_dir);
+    for (int p = 0; p < nplugins; ++p) {
+        if (registry_load_plugin(plugins[p]) < 0) return 2;
+    }
+
+    if (list) {
+        suite_print_registry();
+        return 0;
+    }
+    if (list_config) {
+        print_config();
+        return 0;
+    }
+
+    // Listing needs no system info; a run prints it first
+    print_system_info();
+    const char* names[] = { "QUICK", "STANDARD", "EXTREME" };
+    printf(">>> RUNNING PROFILE: %s <<<\n", names[profile]);
+    if (calibrate) return suite_calibrate(calibrate) > 0 ? 0 : 2;
+    run_suite();
     return 0;
-}
\ No newline at end of file
+}
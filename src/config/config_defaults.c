@@ -9,12 +9,60 @@ static BenchConfig CFG = {
     .triad_N = 16777216ull,                 // 16 Mi elements
     .aes_bytes = 128ull * 1024ull * 1024ull,  // 128 MiB
     .comp_bytes = 64ull * 1024ull * 1024ull,   // 64 MiB
-	.disk_bytes = 128ull * 1024ull * 1024ull    // 100 MiB
+	.disk_bytes = 128ull * 1024ull * 1024ull,   // 100 MiB
+    .threads = 1,
+    .thread_sweep = 0,
+    .latency_max_bytes = 1024ull * 1024ull * 1024ull, // 1 GiB
+    .latency_hugepages = 0,
+    .stream_nt_stores = 0,
+    .aes_key_bits = 128,
+    .comp_level = 6,
+    .comp_block_bytes = 256ull * 1024ull,   // 256 KiB
+    .disk_dir = ".",
+    .disk_queue_depth = 1,
+    .disk_jobs = 1,
+    .disk_sweep_max_qd = 32,
+    .disk_direct = 1,
+    .ci_repeat = 0,
+    .ci_target = 0.02,
+    .repetitions_max = 200,
+    .perf_counters = 1,
+    .arena_hugepages = 0,
+    .simd_isa = -1,
+    .gemm_N = 1024,
+    .gemm_sweep_max = 2048,
+    .mixed_tests = "",
+    .mixed_seconds = 5.0,
+    .test_seconds = 3.0,
+    .sample_seconds = 0.1,
+    .tests = "",
+    .output_path = "results/run.csv",
+    .output_format = REPORT_CSV,
+    .refs_path = "refs/references.json",
+    .ref_class = "",
+    .plugin_dir = "plugins",
+    .pin = "none",
+    .pin_tests = "",
+    .core_types = 1,
+    .telemetry_ms = 100,
+    .energy = 1,
+    .bwm_max_bytes = 0,
+    .bwm_hugepages = 0
 };
 
+static int PROFILE = 1;
+
 BenchConfig* bench_config_defaults(void) { return &CFG; }
 
+int bench_config_profile(void) { return PROFILE; }
+
+const char* bench_profile_name(int profile_id) {
+    static const char* names[] = { "QUICK", "STANDARD", "EXTREME" };
+    return (profile_id >= 0 && profile_id <= 2) ? names[profile_id] : "STANDARD";
+}
+
 void set_config_profile(int profile_id) {
+    PROFILE = (profile_id == 0 || profile_id == 2) ? profile_id : 1;
     switch (profile_id) {
     case 0: // QUICK / DEMO
         CFG.repetitionsK = 10;
@@ -25,6 +73,10 @@ void set_config_profile(int profile_id) {
         CFG.aes_bytes = 32ull * 1024ull * 1024ull;
         CFG.comp_bytes = 16ull * 1024ull * 1024ull;
 		CFG.disk_bytes = 32ull * 1024ull * 1024ull;
+        CFG.latency_max_bytes = 64ull * 1024ull * 1024ull;
+        CFG.gemm_N = 512;
+        CFG.gemm_sweep_max = 1024;
+        CFG.test_seconds = 1.0;
         break;
 
     case 2: // EXTREME / STRESS
@@ -36,6 +88,10 @@ void set_config_profile(int profile_id) {
         CFG.aes_bytes = 512ull * 1024ull * 1024ull;
         CFG.comp_bytes = 256ull * 1024ull * 1024ull;
 		CFG.disk_bytes = 512ull * 1024ull * 1024ull;
+        CFG.latency_max_bytes = 4096ull * 1024ull * 1024ull; // 4 GiB
+        CFG.gemm_N = 2048;
+        CFG.gemm_sweep_max = 4096;
+        CFG.test_seconds = 10.0;
         break;
 
     case 1: // STANDARD (Default)
@@ -48,6 +104,10 @@ void set_config_profile(int profile_id) {
         CFG.aes_bytes = 128ull * 1024ull * 1024ull;
         CFG.comp_bytes = 64ull * 1024ull * 1024ull;
 		CFG.disk_bytes = 128ull * 1024ull * 1024ull;
+        CFG.latency_max_bytes = 1024ull * 1024ull * 1024ull;
+        CFG.gemm_N = 1024;
+        CFG.gemm_sweep_max = 2048;
+        CFG.test_seconds = 3.0;
         break;
     }
 }
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+
+#define F(type, member) { #member, type, offsetof(BenchConfig, member), sizeof(((BenchConfig*)0)->member) }
+
+// Keep in declaration order (the GUI's ctypes mirror follows the same list)
+static const ConfigField FIELDS[] = {
+    F(CFG_INT,    repetitionsK),
+    F(CFG_INT,    warmup),
+    F(CFG_SIZE,   integer_block_bytes),
+    F(CFG_INT,    integer_passes),
+    F(CFG_SIZE,   float_N),
+    F(CFG_SIZE,   triad_N),
+    F(CFG_SIZE,   aes_bytes),
+    F(CFG_SIZE,   comp_bytes),
+    F(CFG_SIZE,   disk_bytes),
+    F(CFG_INT,    threads),
+    F(CFG_INT,    thread_sweep),
+    F(CFG_SIZE,   latency_max_bytes),
+    F(CFG_INT,    latency_hugepages),
+    F(CFG_INT,    stream_nt_stores),
+    F(CFG_INT,    aes_key_bits),
+    F(CFG_INT,    comp_level),
+    F(CFG_SIZE,   comp_block_bytes),
+    F(CFG_STR,    disk_dir),
+    F(CFG_INT,    disk_queue_depth),
+    F(CFG_INT,    disk_jobs),
+    F(CFG_INT,    disk_sweep_max_qd),
+    F(CFG_INT,    disk_direct),
+    F(CFG_INT,    ci_repeat),
+    F(CFG_DOUBLE, ci_target),
+    F(CFG_INT,    repetitions_max),
+    F(CFG_INT,    perf_counters),
+    F(CFG_INT,    arena_hugepages),
+    F(CFG_INT,    simd_isa),
+    F(CFG_SIZE,   gemm_N),
+    F(CFG_SIZE,   gemm_sweep_max),
+    F(CFG_STR,    mixed_tests),
+    F(CFG_DOUBLE, mixed_seconds),
+    F(CFG_DOUBLE, test_seconds),
+    F(CFG_DOUBLE, sample_seconds),
+    F(CFG_STR,    tests),
+    F(CFG_STR,    output_path),
+    F(CFG_INT,    output_format),
+    F(CFG_STR,    refs_path),
+    F(CFG_STR,    ref_class),
+    F(CFG_STR,    plugin_dir),
+    F(CFG_STR,    pin),
+    F(CFG_STR,    pin_tests),
+    F(CFG_INT,    core_types),
+    F(CFG_INT,    telemetry_ms),
+    F(CFG_INT,    energy),
+    F(CFG_SIZE,   bwm_max_bytes),
+    F(CFG_INT,    bwm_hugepages)
+};
+
+#undef F
+
+const ConfigField* bench_config_fields(int* count) {
+    if (count) *count = (int)(sizeof(FIELDS) / sizeof(FIELDS[0]));
+    return FIELDS;
+}
+
+// "64M", "1g", "4096": binary multiples
+static int parse_size(const char* v, size_t* out) {
+    char* end = NULL;
+    const unsigned long long n = strtoull(v, &end, 10);
+    if (end == v) return 0;
+    unsigned long long mul = 1;
+    switch (*end) {
+    case 'k': case 'K': mul = 1ull << 10; ++end; break;
+    case 'm': case 'M': mul = 1ull << 20; ++end; break;
+    case 'g': case 'G': mul = 1ull << 30; ++end; break;
+    default: break;
+    }
+    if (*end == 'i' || *end == 'B') ++end;   // "64MiB", "64MB"
+    if (*end == 'B') ++end;
+    if (*end != '\0') return 0;
+    *out = (size_t)(n * mul);
+    return 1;
+}
+
+int bench_config_set(const char* name, const char* value) {
+    if (!name || !value) return 0;
+    const ConfigField* f = NULL;
+    for (size_t i = 0; i < sizeof(FIELDS) / sizeof(FIELDS[0]) && !f; ++i) {
+        if (strcmp(FIELDS[i].name, name) == 0) f = &FIELDS[i];
+    }
+    if (!f) return 0;
+
+    char* p = (char*)bench_config_defaults() + f->offset;
+    char* end = NULL;
+    switch (f->type) {
+    case CFG_INT: {
+        const long v = strtol(value, &end, 10);
+        if (end == value || *end != '\0') return 0;
+        *(int*)p = (int)v;
+        return 1;
+    }
+    case CFG_SIZE:
+        return parse_size(value, (size_t*)p);
+    case CFG_DOUBLE: {
+        const double v = strtod(value, &end);
+        if (end == value || *end != '\0') return 0;
+        *(double*)p = v;
+        return 1;
+    }
+    case CFG_STR:
+        if (strlen(value) >= f->size) return 0;
+        snprintf(p, f->size, "%s", value);
+        return 1;
+    }
+    return 0;
+}
@@ -1,15 +1,241 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include "refs.h"
+#include "config.h"
+#include "json_read.h"
+#include "run_env.h"
+#include "report.h"
+#include "registry.h"
+#include "suite.h"
 
-// Calibrated on User PC
-// Based on 5-run average from run.csv
-static const BenchRefs REFS = {
-    .pref_integer_mips = 2260.426,
-    .pref_float_mflops = 907.005,
-    .pref_mem_mbps = 9821.765,
-    .pref_aes_mbps = 1672.159,
-    .pref_comp_mbps = 724.029,
-    .pref_latency_mops = 460.951,
-	.pref_disk_mbps = 1562.559
-};
-
-const BenchRefs* bench_refs_defaults(void) { return &REFS; }
\ No newline at end of file
+static RefValue active[REFS_MAX_TESTS];
+static int      active_count = -1;       // -1 = nothing selected yet
+static char     active_source[256];
+
+// The compiled-in references were measured single-threaded under STANDARD;
+// any other profile or team size has none rather than a misleading index
+static void select_builtin(const char* profile, int threads) {
+    active_count = 0;
+    if (strcmp(profile, bench_profile_name(1)) != 0 || threads != 1) {
+        snprintf(active_source, sizeof(active_source),
+            "none for %s at %d thread%s (built-ins are STANDARD, 1 thread; see --calibrate)",
+            profile, threads, threads == 1 ? "" : "s");
+        return;
+    }
+    for (int i = 0; i < registry_count() && active_count < REFS_MAX_TESTS; ++i) {
+        const TestCase* tc = registry_get(i);
+        if (tc->reference <= 0.0) continue;
+        snprintf(active[active_count].id, sizeof(active[0].id), "%s", tc->id);
+        active[active_count].median = tc->reference;
+        active[active_count].cv = 0.0;
+        active_count++;
+    }
+    snprintf(active_source, sizeof(active_source), "built-in (i7-12700H laptop, %s, 1 thread)", profile);
+}
+
+void refs_default_class(char* out, int max_len) {
+    RunEnv env;
+    run_env_capture(&env);
+    snprintf(out, (size_t)max_len, "%s", env.cpu_model[0] ? env.cpu_model : "default");
+}
+
+static char* read_file(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* buf = (size >= 0) ? (char*)malloc((size_t)size + 1) : NULL;
+    if (buf) buf[fread(buf, 1, (size_t)size, f)] = '\0';
+    fclose(f);
+    return buf;
+}
+
+// Parsed database, or 0 if missing, malformed or of a newer format
+static int load_db(const char* path, JsonValue* db) {
+    char* text = read_file(path);
+    if (!text) return 0;
+    const int ok = json_parse(text, db) != NULL;
+    free(text);
+    if (!ok) {
+        fprintf(stderr, "References: %s is not valid JSON, ignored\n", path);
+        return 0;
+    }
+    const JsonValue* entries = json_get(db, "entries");
+    if (json_get_number(db, "version", 0.0) > REFS_FORMAT_VERSION || !entries || entries->type != JSON_ARRAY) {
+        fprintf(stderr, "References: %s has an unsupported format, ignored\n", path);
+        json_free(db);
+        return 0;
+    }
+    return 1;
+}
+
+// Entries without "threads" predate it and match any team size. *other is
+// set to the thread count of a class/profile match that was skipped for it.
+static const JsonValue* find_entry(const JsonValue* db, const char* machine_class, const char* profile,
+    int threads, int* other) {
+    const JsonValue* entries = json_get(db, "entries");
+    for (int i = 0; entries && i < entries->count; ++i) {
+        const JsonValue* e = &entries->items[i];
+        const char* c = json_get_string(e, "class");
+        const char* p = json_get_string(e, "profile");
+        if (!c || !p || strcmp(c, machine_class) != 0 || strcmp(p, profile) != 0) continue;
+        const int t = (int)json_get_number(e, "threads", 0.0);
+        if (t <= 0 || t == threads) return e;
+        if (other) *other = t;
+    }
+    return NULL;
+}
+
+int refs_select(const char* path, const char* machine_class, const char* profile, int threads) {
+    char cls[128];
+    if (machine_class && machine_class[0]) snprintf(cls, sizeof(cls), "%s", machine_class);
+    else refs_default_class(cls, sizeof(cls));
+
+    JsonValue db;
+    if (!path || !load_db(path, &db)) {
+        select_builtin(profile, threads);
+        return 0;
+    }
+    int other = 0;
+    const JsonValue* e = find_entry(&db, cls, profile, threads, &other);
+    if (other && !e) {
+        fprintf(stderr, "References: class \"%s\" %s was calibrated at %d threads, this run uses %d; not used\n",
+            cls, profile, other, threads);
+    }
+    if (!e) {
+        other = 0;
+        e = find_entry(&db, "default", profile, threads, &other);
+        if (other && !e) {
+            fprintf(stderr, "References: class \"default\" %s was calibrated at %d threads, this run uses %d; not used\n",
+                profile, other, threads);
+        }
+        if (e) fprintf(stderr, "References: no entry for class \"%s\", grading against class \"default\"\n", cls);
+    }
+    const JsonValue* values = e ? json_get(e, "refs") : NULL;
+    if (!values || values->type != JSON_OBJECT) {
+        json_free(&db);
+        select_builtin(profile, threads);
+        return 0;
+    }
+
+    active_count = 0;
+    for (int i = 0; i < values->count && active_count < REFS_MAX_TESTS; ++i) {
+        const JsonValue* v = &values->items[i];
+        const double median = json_get_number(v, "median", 0.0);
+        if (median <= 0.0) continue;
+        const double cv = json_get_number(v, "cv", 0.0);
+        if (cv > REFS_MAX_CV) {
+            fprintf(stderr, "References: %s has a run-to-run CV of %.0f%% (limit %.0f%%), not used\n",
+                values->keys[i], 100.0 * cv, 100.0 * REFS_MAX_CV);
+            continue;
+        }
+        snprintf(active[active_count].id, sizeof(active[0].id), "%s", values->keys[i]);
+        active[active_count].median = median;
+        active[active_count].cv = cv;
+        active_count++;
+    }
+    const int t = (int)json_get_number(e, "threads", 0.0);
+    char at[32] = "";
+    if (t > 0) snprintf(at, sizeof(at), ", %d thread%s", t, t == 1 ? "" : "s");
+    snprintf(active_source, sizeof(active_source), "%.120s, class \"%.60s\", %s%s (%d runs, %.32s)", path,
+        json_get_string(e, "class"), profile, at, (int)json_get_number(e, "runs", 0.0),
+        json_get_string(e, "created") ? json_get_string(e, "created") : "undated");
+    json_free(&db);
+    return 1;
+}
+
+double refs_lookup(const char* test_id) {
+    if (active_count < 0) {
+        const BenchConfig* cfg = bench_config_defaults();
+        refs_select(cfg->refs_path, cfg->ref_class, bench_profile_name(bench_config_profile()), suite_threads());
+    }
+    for (int i = 0; i < active_count; ++i) {
+        if (strcmp(active[i].id, test_id) == 0) return active[i].median;
+    }
+    return 0.0;
+}
+
+const char* refs_source(void) {
+    if (active_count < 0) (void)refs_lookup("");
+    return active_source;
+}
+
+static void write_entry(FILE* f, const char* machine_class, const char* profile, int threads,
+    const char* created, int runs, const RefValue* values, int count) {
+    fprintf(f, "    {\"class\": ");
+    json_write_string(f, machine_class);
+    fprintf(f, ", \"profile\": ");
+    json_write_string(f, profile);
+    if (threads > 0) fprintf(f, ", \"threads\": %d", threads);
+    fprintf(f, ", \"created\": ");
+    json_write_string(f, created);
+    fprintf(f, ", \"runs\": %d,\n     \"refs\": {", runs);
+    for (int i = 0; i < count; ++i) {
+        fprintf(f, "%s\n       ", i ? "," : "");
+        json_write_string(f, values[i].id);
+        fprintf(f, ": {\"median\": %.9g, \"cv\": %.6g}", values[i].median, values[i].cv);
+    }
+    fprintf(f, "}}");
+}
+
+int refs_write_entry(const char* path, const char* machine_class, const char* profile,
+    int threads, const RefValue* values, int count, int runs) {
+    char cls[128];
+    if (machine_class && machine_class[0]) snprintf(cls, sizeof(cls), "%s", machine_class);
+    else refs_default_class(cls, sizeof(cls));
+
+    RunEnv env;
+    run_env_capture(&env);
+
+    JsonValue db;
+    const int have_db = load_db(path, &db);
+
+    // Rewritten through a temporary file so a failed write keeps the old database
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    report_ensure_dir(path);
+    FILE* f = fopen(tmp, "w");
+    if (!f) {
+        if (have_db) json_free(&db);
+        return 0;
+    }
+    fprintf(f, "{\n  \"format\": \"pc-bench-refs\",\n  \"version\": %d,\n  \"entries\": [\n", REFS_FORMAT_VERSION);
+    int written = 0;
+    const JsonValue* entries = have_db ? json_get(&db, "entries") : NULL;
+    for (int i = 0; entries && i < entries->count; ++i) {
+        const JsonValue* e = &entries->items[i];
+        const char* c = json_get_string(e, "class");
+        const char* p = json_get_string(e, "profile");
+        const JsonValue* refs = json_get(e, "refs");
+        if (!c || !p || !refs || refs->type != JSON_OBJECT) continue;
+        const int t = (int)json_get_number(e, "threads", 0.0);
+        if (strcmp(c, cls) == 0 && strcmp(p, profile) == 0 && (t <= 0 || t == threads)) continue;   // replaced below
+
+        RefValue old[REFS_MAX_TESTS];
+        int n = 0;
+        for (int k = 0; k < refs->count && n < REFS_MAX_TESTS; ++k) {
+            snprintf(old[n].id, sizeof(old[n].id), "%s", refs->keys[k]);
+            old[n].median = json_get_number(&refs->items[k], "median", 0.0);
+            old[n].cv = json_get_number(&refs->items[k], "cv", 0.0);
+            n++;
+        }
+        const char* created = json_get_string(e, "created");
+        if (written++) fprintf(f, ",\n");
+        write_entry(f, c, p, t, created ? created : "", (int)json_get_number(e, "runs", 0.0), old, n);
+    }
+    if (written++) fprintf(f, ",\n");
+    write_entry(f, cls, profile, threads, env.timestamp, runs, values, count);
+    fprintf(f, "\n  ]\n}\n");
+    const int ok = fclose(f) == 0;
+    if (have_db) json_free(&db);
+
+    if (ok) {
+        remove(path);   // rename does not replace on Windows
+        if (rename(tmp, path) != 0) return 0;
+    }
+    active_count = -1;  // reselect on next lookup
+    return ok;
+}
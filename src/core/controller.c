@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include "controller.h"
 #include "suite.h"
 #include "config.h"
@@ -11,5 +12,17 @@ void run_suite(void) {
 }
 
 void run_single(const char* test_id) {
-    printf("[Controller] Running single test: %s\n", test_id ? test_id : "(null)");
+    if (!suite_has_id(test_id)) {
+        fprintf(stderr, "[Controller] Unknown test id: %s\n", test_id ? test_id : "(null)");
+        return;
+    }
+    printf("[Controller] Running single test: %s\n", test_id);
+
+    // Runs through the suite with the selection narrowed to this id
+    BenchConfig* cfg = bench_config_defaults();
+    char saved[sizeof(cfg->tests)];
+    memcpy(saved, cfg->tests, sizeof(saved));
+    snprintf(cfg->tests, sizeof(cfg->tests), "%s", test_id);
+    suite_run_all();
+    memcpy(cfg->tests, saved, sizeof(saved));
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mixed.h"
+#include "threadpool.h"
+#include "timer.h"
+
+// Drivers are workers 0..n-1 of the default team; workload g owns the MIXED_STRIDE
+// workers starting at MIXED_FIRST + g * MIXED_STRIDE. Disk tests widen their own
+// team up to the queue depth; the pool clamps that to the group's width.
+#define MIXED_FIRST        MIXED_MAX_WORKLOADS
+#define MIXED_STRIDE       64
+#define MIXED_MAX_SAMPLES  4096
+
+typedef struct {
+    MixedWorkload* w;
+    double         seconds;
+    double*        samples[MIXED_MAX_WORKLOADS];
+    int            count[MIXED_MAX_WORKLOADS];
+} MixedCtx;
+
+static int group_first(int g) { return MIXED_FIRST + g * MIXED_STRIDE; }
+
+// Repetitions until the deadline. A repetition that ends after the deadline is
+// dropped (others may already have stopped), unless it is the only one.
+static int sample_until(const TestCase* tc, double deadline, double* out, int cap) {
+    int n = 0;
+    do {
+        const double v = tc->run_once();
+        if (n > 0 && timer_now_seconds() > deadline) break;
+        out[n++] = v;
+    } while (n < cap && timer_now_seconds() < deadline);
+    return n;
+}
+
+static void mixed_driver(int tid, int nthreads, void* arg) {
+    MixedCtx* c = (MixedCtx*)arg;
+    (void)nthreads;
+    MixedWorkload* w = &c->w[tid];
+
+    const int bound = pool_group_bind(group_first(tid), MIXED_STRIDE, w->threads);
+    pool_sync();   // every group bound before any starts
+    if (bound && w->ok) {
+        const double deadline = timer_now_seconds() + c->seconds;
+        c->count[tid] = sample_until(w->tc, deadline, c->samples[tid], MIXED_MAX_SAMPLES);
+    }
+    if (bound) pool_group_unbind();
+}
+
+int mixed_run(MixedWorkload* w, int n, double seconds) {
+    if (n < 1 || n > MIXED_MAX_WORKLOADS) return 0;
+    MixedCtx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.w = w;
+    ctx.seconds = seconds;
+    for (int g = 0; g < n; ++g) {
+        if (w[g].threads < 1) w[g].threads = 1;
+        if (w[g].threads > MIXED_STRIDE) w[g].threads = MIXED_STRIDE;
+        ctx.samples[g] = (double*)malloc(MIXED_MAX_SAMPLES * sizeof(double));
+        if (!ctx.samples[g]) {
+            for (int k = 0; k < g; ++k) free(ctx.samples[k]);
+            return 0;
+        }
+    }
+
+    // Prepare (serially: the arena is single-threaded) and time each workload
+    // alone, on the same worker group it gets in the mixed phase
+    for (int g = 0; g < n; ++g) {
+        const TestCase* tc = w[g].tc;
+        memset(&w[g].solo, 0, sizeof(w[g].solo));
+        memset(&w[g].mixed, 0, sizeof(w[g].mixed));
+        if (!pool_group_bind(group_first(g), MIXED_STRIDE, w[g].threads)) {
+            for (int k = 0; k < n; ++k) free(ctx.samples[k]);
+            return 0;
+        }
+        w[g].ok = !tc->prepare || tc->prepare();
+        if (w[g].ok) {
+            (void)tc->run_once();   // warm-up
+            const int cnt = sample_until(tc, timer_now_seconds() + seconds, ctx.samples[g], MIXED_MAX_SAMPLES);
+            stats_summarize(ctx.samples[g], cnt, &w[g].solo);
+        } else {
+            fprintf(stderr, "[%s] prepare failed (out of memory?), skipped\n", tc->id);
+        }
+        pool_group_unbind();
+    }
+
+    // All together, one driver per workload
+    const int saved_team = pool_team();
+    pool_set_team(n);
+    pool_run(mixed_driver, &ctx);
+    pool_set_team(saved_team);
+
+    for (int g = 0; g < n; ++g) {
+        if (w[g].ok && ctx.count[g] > 0) stats_summarize(ctx.samples[g], ctx.count[g], &w[g].mixed);
+        if (w[g].tc->teardown) w[g].tc->teardown();
+        free(ctx.samples[g]);
+    }
+    return 1;
+}
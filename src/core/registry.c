@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "registry.h"
+#include "plugin.h"
+
+#include "integer_mix.h"
+#include "float_dot.h"
+#include "gemm.h"
+#include "memory_triad.h"
+#include "memory_latency.h"
+#include "aes_throughput.h"
+#include "compress_throughput.h"
+#include "disk_sys.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <dlfcn.h>
+#endif
+
+// Built-in tests, in report order. References: i7-12700H laptop, STANDARD,
+// one thread, 5-run average, kept only for tests whose metric is unchanged
+// since (INT, MEM); the others are graded from the refs database
+// (refs/references.json, see --calibrate).
+static const TestCase BUILTIN[] = {
+    { "INT", "Integer checksum mix",     "MIPS",   NULL, integer_mips_once, NULL, 2260.426, TC_SCALES | TC_GRADED },
+    { "ILP", "Integer independent chains", "MIPS", NULL, integer_ilp_mips_once, NULL, 0, TC_SCALES },
+    { "SRT", "Integer quicksort",        "Mkeys/s", integer_prepare, integer_sort_mkeys_once, integer_teardown, 0, TC_SCALES },
+    { "HPR", "Hash-table probe",         "Mprobes/s", integer_prepare, integer_probe_mops_once, integer_teardown, 0, TC_SCALES },
+    { "CRC", "CRC32C",                   "MB/s",   integer_prepare, integer_crc32c_mbps_once, integer_teardown, 0, TC_SCALES },
+    { "XXH", "XXH64 hash",               "MB/s",   integer_prepare, integer_xxh64_mbps_once, integer_teardown, 0, TC_SCALES },
+    { "VIN", "Vector integer mix",       "MB/s",   integer_prepare, integer_vector_mbps_once, integer_teardown, 0, TC_SCALES },
+    { "FP",  "Floating-point dot",       "MFLOPS", float_prepare, float_mflops_once, float_teardown, 0, TC_SCALES | TC_GRADED },
+    { "FDD", "Floating-point dot (f64)", "MFLOPS", float_prepare, float_dot64_mflops_once, float_teardown, 0, TC_SCALES },
+    { "FMS", "FMA peak (f32)",           "MFLOPS", float_prepare, float_fma32_mflops_once, float_teardown, 0, TC_SCALES },
+    { "FMD", "FMA peak (f64)",           "MFLOPS", float_prepare, float_fma64_mflops_once, float_teardown, 0, TC_SCALES },
+    { "DGM", "DGEMM (f64 matrix multiply)", "GFLOPS", gemm_prepare, gemm_dgemm_gflops_once, gemm_teardown, 0, TC_SCALES },
+    { "SGM", "SGEMM (f32 matrix multiply)", "GFLOPS", gemm_prepare, gemm_sgemm_gflops_once, gemm_teardown, 0, TC_SCALES },
+    { "CPY", "Memory COPY (A=B)",        "MB/s",   memory_prepare, memory_copy_mbps_once, memory_teardown, 0, TC_SCALES },
+    { "SCL", "Memory SCALE (A=s*B)",     "MB/s",   memory_prepare, memory_scale_mbps_once, memory_teardown, 0, TC_SCALES },
+    { "ADD", "Memory ADD (A=B+C)",       "MB/s",   memory_prepare, memory_add_mbps_once, memory_teardown, 0, TC_SCALES },
+    { "MEM", "Memory TRIAD (A=B+s*C)",   "MB/s",   memory_prepare, memory_mbps_once, memory_teardown, 9821.765, TC_SCALES | TC_GRADED },
+    { "AES", "AES ECB (throughput)",     "MB/s",   aes_prepare, aes_mbps_once, aes_teardown, 0, TC_SCALES | TC_GRADED },
+    { "ACT", "AES CTR (throughput)",     "MB/s",   aes_prepare, aes_ctr_mbps_once, aes_teardown, 0, TC_SCALES },
+    { "AGC", "AES-GCM 16K records",      "MB/s",   aes_prepare, aes_gcm_mbps_once, aes_teardown, 0, TC_SCALES },
+    { "CMP", "LZ77+Huffman codec (mixed)", "MB/s", compress_prepare, compress_mbps_once, compress_teardown, 0, TC_SCALES | TC_GRADED | TC_WORK_SCALES },
+    { "CTX", "Compress text",            "MB/s",   compress_prepare, compress_text_mbps_once, compress_teardown, 0, TC_SCALES | TC_WORK_SCALES },
+    { "DTX", "Decompress text",          "MB/s",   compress_prepare, decompress_text_mbps_once, compress_teardown, 0, TC_SCALES | TC_WORK_SCALES },
+    { "CJS", "Compress JSON logs",       "MB/s",   compress_prepare, compress_json_mbps_once, compress_teardown, 0, TC_SCALES | TC_WORK_SCALES },
+    { "DJS", "Decompress JSON logs",     "MB/s",   compress_prepare, decompress_json_mbps_once, compress_teardown, 0, TC_SCALES | TC_WORK_SCALES },
+    { "CBN", "Compress binary records",  "MB/s",   compress_prepare, compress_binary_mbps_once, compress_teardown, 0, TC_SCALES | TC_WORK_SCALES },
+    { "DBN", "Decompress binary records", "MB/s",  compress_prepare, decompress_binary_mbps_once, compress_teardown, 0, TC_SCALES | TC_WORK_SCALES },
+    { "RND", "Memory Random Latency",    "MOPS",   memory_random_prepare, memory_random_mops_once, memory_random_teardown, 0, TC_GRADED | TC_SELF_WARMING | TC_WORK_SCALES },
+    { "DSK", "Disk I/O Throughput",      "MB/s",   disk_prepare, disk_benchmark_mbps_once, NULL, 0, TC_GRADED },
+    { "DSW", "Disk sequential write",    "MB/s",   disk_prepare, disk_seq_write_mbps_once, NULL, 0, 0 },
+    { "DSR", "Disk sequential read",     "MB/s",   disk_prepare, disk_seq_read_mbps_once, NULL, 0, 0 },
+    { "DRW", "Disk 4K random write",     "IOPS",   disk_prepare, disk_rand_write_iops_once, NULL, 0, 0 },
+    { "DRR", "Disk 4K random read",      "IOPS",   disk_prepare, disk_rand_read_iops_once, NULL, 0, 0 }
+};
+
+static TestCase    entries[REGISTRY_MAX_TESTS];
+static const char* sources[REGISTRY_MAX_TESTS];
+static int         count = -1;                  // -1 = built-ins not added yet
+static const char* loading = "built-in";        // source recorded by registry_add
+
+static void ensure_builtin(void) {
+    if (count >= 0) return;
+    count = 0;
+    for (size_t i = 0; i < sizeof(BUILTIN) / sizeof(BUILTIN[0]); ++i) (void)registry_add(&BUILTIN[i]);
+}
+
+int registry_count(void) {
+    ensure_builtin();
+    return count;
+}
+
+const TestCase* registry_get(int index) {
+    ensure_builtin();
+    return (index >= 0 && index < count) ? &entries[index] : NULL;
+}
+
+const TestCase* registry_find(const char* id) {
+    ensure_builtin();
+    for (int i = 0; id && i < count; ++i) {
+        if (strcmp(entries[i].id, id) == 0) return &entries[i];
+    }
+    return NULL;
+}
+
+const char* registry_source(int index) {
+    ensure_builtin();
+    return (index >= 0 && index < count) ? sources[index] : NULL;
+}
+
+int registry_add(const TestCase* tc) {
+    ensure_builtin();
+    if (!tc || !tc->id || !tc->id[0] || !tc->title || !tc->unit || !tc->run_once) return 0;
+    if (count == REGISTRY_MAX_TESTS) {
+        fprintf(stderr, "[registry] full (%d tests), '%s' not added\n", REGISTRY_MAX_TESTS, tc->id);
+        return 0;
+    }
+    if (registry_find(tc->id)) {
+        fprintf(stderr, "[registry] duplicate test id '%s' from %s ignored\n", tc->id, loading);
+        return 0;
+    }
+    entries[count] = *tc;
+    sources[count] = loading;
+    count++;
+    return 1;
+}
+
+// Plugin paths outlive the load call: registry_source hands them out
+static char plugin_paths[16][256];
+static int  plugin_count;
+
+int registry_load_plugin(const char* path) {
+    ensure_builtin();
+    if (!path || !path[0]) return -1;
+    if (plugin_count == (int)(sizeof(plugin_paths) / sizeof(plugin_paths[0]))) {
+        fprintf(stderr, "[registry] too many plugins, %s not loaded\n", path);
+        return -1;
+    }
+
+    PluginInitFn init = NULL;
+#ifdef _WIN32
+    HMODULE lib = LoadLibraryA(path);
+    if (lib) init = (PluginInitFn)(void (*)(void))GetProcAddress(lib, PLUGIN_ENTRY);
+    if (!lib || !init) {
+        fprintf(stderr, "[registry] %s: not a plugin (error %lu)\n", path, (unsigned long)GetLastError());
+        if (lib) FreeLibrary(lib);
+        return -1;
+    }
+#else
+    void* lib = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (lib) *(void**)&init = dlsym(lib, PLUGIN_ENTRY);   // POSIX-sanctioned object -> function pointer cast
+    if (!lib || !init) {
+        fprintf(stderr, "[registry] %s: not a plugin (%s)\n", path, dlerror());
+        if (lib) dlclose(lib);
+        return -1;
+    }
+#endif
+
+    char* stored = plugin_paths[plugin_count];
+    snprintf(stored, sizeof(plugin_paths[0]), "%s", path);
+    const int before = count;
+    loading = stored;
+    const int ok = init(PLUGIN_ABI_VERSION, registry_add);
+    loading = "built-in";
+    if (!ok) {
+        // Tests it added before refusing stay out of the registry
+        count = before;
+        fprintf(stderr, "[registry] %s refused to initialise (host ABI %d)\n", path, PLUGIN_ABI_VERSION);
+#ifdef _WIN32
+        FreeLibrary(lib);
+#else
+        dlclose(lib);
+#endif
+        return -1;
+    }
+    plugin_count++;
+    return count - before;
+}
+
+static int is_library(const char* name) {
+#ifdef _WIN32
+    const char* ext = ".dll";
+#elif defined(__APPLE__)
+    const char* ext = ".dylib";
+#else
+    const char* ext = ".so";
+#endif
+    const size_t n = strlen(name), e = strlen(ext);
+    return n > e && strcmp(name + n - e, ext) == 0;
+}
+
+int registry_load_plugin_dir(const char* dir) {
+    ensure_builtin();
+    if (!dir || !dir[0]) return 0;
+    char path[512];
+    int added = 0;
+#ifdef _WIN32
+    char pattern[512];
+    snprintf(pattern, sizeof(pattern), "%s\\*", dir);
+    WIN32_FIND_DATAA fd;
+    HANDLE h = FindFirstFileA(pattern, &fd);
+    if (h == INVALID_HANDLE_VALUE) return 0;
+    do {
+        if (!is_library(fd.cFileName)) continue;
+        snprintf(path, sizeof(path), "%s\\%s", dir, fd.cFileName);
+        const int n = registry_load_plugin(path);
+        if (n > 0) added += n;
+    } while (FindNextFileA(h, &fd));
+    FindClose(h);
+#else
+    // readdir order is arbitrary; sorted names keep the report order stable
+    struct dirent** names = NULL;
+    const int found = scandir(dir, &names, NULL, alphasort);
+    if (found < 0) return 0;
+    for (int i = 0; i < found; ++i) {
+        if (is_library(names[i]->d_name)) {
+            snprintf(path, sizeof(path), "%s/%s", dir, names[i]->d_name);
+            const int n = registry_load_plugin(path);
+            if (n > 0) added += n;
+        }
+        free(names[i]);
+    }
+    free(names);
+#endif
+    return added;
+}
@@ -1,42 +1,338 @@
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <float.h>
+#include <math.h>
 #include "suite.h"
 #include "config.h"
 #include "refs.h"
 
 #include "integer_mix.h"
 #include "float_dot.h"
+#include "gemm.h"
 #include "memory_triad.h"
+#include "memory_latency.h"
+#include "memory_bandwidth.h"
 #include "aes_throughput.h"
 #include "compress_throughput.h"
 #include "disk_sys.h"
-
-#include "report_csv.h"
-
-typedef enum { PREF_INT, PREF_FP, PREF_MEM, PREF_AES, PREF_COMP, PREF_LATENCY, PREF_DISK } PrefKind;
-
+#include "threadpool.h"
+#include "stats.h"
+#include "perf_counters.h"
+#include "timer.h"
+
+#include "report.h"
+#include "testcase.h"
+#include "registry.h"
+#include "arena.h"
+#include "mixed.h"
+#include "topology.h"
+#include "telemetry.h"
+#include "metric_units.h"
+
+// Ungraded parameter sweeps, reported one row per point after the graded tests
 typedef struct {
     const char* id;
     const char* title;
-    const char* unit;            // "MIPS", "MFLOPS", "MB/s"
-    PrefKind    prefk;
-    double    (*once)(void);     // one timed pass returns throughput
-} TestEntry;
+    const char* unit;
+    SweepFn     fn;
+} SweepEntry;
+
+#define SWEEP_MAX_POINTS 256
+
+typedef struct {
+    int         threads;
+    SampleStats s;               // aggregate throughput over all runs
+    double      tmin, tmax;      // per-thread throughput extremes over all runs
+    PerfSummary perf;            // counters summed over the timed runs
+    TelemetrySummary tele;       // clock, temperature and power over the timed runs
+    double*     samples;         // s.n values in run order (owned; NULL if none)
+    TelemetryWindow* windows;    // s.n telemetry windows, aligned with samples (owned)
+} Measurement;
+
+static void measurement_free(const Measurement* m) {
+    free(m->samples);
+    free(m->windows);
+}
+
+// Adaptive runs need a few samples before a bootstrap interval means anything
+#define CI_MIN_RUNS 5
+
+// Time-boxed runs: fewest samples kept even past the budget, largest batch.
+// TC_WORK_SCALES tests warm up on a slice of their work, then shrink it (down
+// to TIMEBOX_MIN_FRACTION) so one repetition fits in a sample.
+#define TIMEBOX_MIN_SAMPLES    3
+#define TIMEBOX_MAX_REPS       100000
+#define TIMEBOX_PROBE_FRACTION (1.0 / 16.0)
+#define TIMEBOX_MIN_FRACTION   (1.0 / 256.0)
+
+static double work_fraction = 1.0;
+
+API double suite_work_fraction(void) { return work_fraction; }
+
+// Resolves BenchConfig.threads (explicit, THREADS_ALL, THREADS_HALF) to a count
+static int resolve_threads(const BenchConfig* cfg) {
+    const int hw = pool_hw_threads();
+    int n = cfg->threads;
+    if (n == THREADS_ALL) n = hw;
+    else if (n == THREADS_HALF) n = hw / 2;
+    if (n < 1) n = 1;
+    if (n > POOL_MAX_THREADS) n = POOL_MAX_THREADS;
+    return n;
+}
+
+API int suite_threads(void) { return resolve_threads(bench_config_defaults()); }
+
+// Thread counts to measure: 1,2,4..N (+N) when sweeping, else just N
+static int thread_plan(const BenchConfig* cfg, int* plan, int cap) {
+    const int n = resolve_threads(cfg);
+    int count = 0;
+    if (cfg->thread_sweep) {
+        for (int t = 1; t < n && count < cap - 1; t *= 2) plan[count++] = t;
+    }
+    plan[count++] = n;
+    return count;
+}
+
+// Pinning policy for a test: its "ID:policy" entry in cfg->pin_tests, else cfg->pin
+static void pin_policy(const BenchConfig* cfg, const char* id, char* out, size_t len) {
+    const size_t idlen = strlen(id);
+    for (const char* p = cfg->pin_tests; *p;) {
+        while (*p == ';' || *p == ' ') ++p;
+        const size_t n = strcspn(p, ";");
+        if (n > idlen && strncmp(p, id, idlen) == 0 && p[idlen] == ':') {
+            snprintf(out, len, "%.*s", (int)(n - idlen - 1), p + idlen + 1);
+            return;
+        }
+        p += n;
+    }
+    snprintf(out, len, "%s", cfg->pin);
+}
+
+// CPUs a test's threads are pinned to (type < 0: any core type); 0 = unpinned
+static int pin_cpus(const BenchConfig* cfg, const TestCase* tc, int type, int* out) {
+    char policy[64];
+    pin_policy(cfg, tc->id, policy, sizeof(policy));
+    int n = topology_pin_set(policy, type, out, TOPO_MAX_CPUS);
+    if (n < 0) n = topology_pin_set(cfg->pin, type, out, TOPO_MAX_CPUS);   // bad entry: global policy
+    return n > 0 ? n : 0;
+}
 
-static double pick_pref(PrefKind k, const BenchRefs* r) {
-    switch (k) {
-    case PREF_INT:  return r->pref_integer_mips;
-    case PREF_FP:   return r->pref_float_mflops;
-    case PREF_MEM:  return r->pref_mem_mbps;
-    case PREF_AES:  return r->pref_aes_mbps;
-    case PREF_COMP: return r->pref_comp_mbps;
-	case PREF_LATENCY: return r ->pref_latency_mops;
-	case PREF_DISK: return r->pref_disk_mbps;
-    default:        return 1.0;
+// Team members take cpus in order; single-threaded tests run on this thread
+static void apply_pins(const TestCase* tc, const int* cpus, int n) {
+    pool_set_affinity(cpus, n);
+    telemetry_watch(cpus, n);
+    if (!(tc->flags & TC_SCALES)) pool_pin_self(n > 0 ? cpus[0] : -1);
+}
+
+// Reports policies that do not parse; they fall back to no pinning
+static void check_pinning(const BenchConfig* cfg) {
+    int cpus[TOPO_MAX_CPUS];
+    char policy[64];
+    if (topology_pin_set(cfg->pin, -1, cpus, TOPO_MAX_CPUS) < 0) {
+        fprintf(stderr, "Unknown pinning '%s' ignored (none, cores, smt or a cpulist)\n", cfg->pin);
+    }
+    for (const char* p = cfg->pin_tests; *p;) {
+        while (*p == ';' || *p == ' ') ++p;
+        const size_t n = strcspn(p, ";");
+        const char* colon = memchr(p, ':', n);
+        if (n > 0) {
+            snprintf(policy, sizeof(policy), "%.*s", colon ? (int)(n - (size_t)(colon + 1 - p)) : 0, colon ? colon + 1 : "");
+            if (!colon || topology_pin_set(policy, -1, cpus, TOPO_MAX_CPUS) < 0) {
+                fprintf(stderr, "Bad per-test pinning '%.*s' ignored (ID:policy)\n", (int)n, p);
+            }
+        }
+        p += n;
     }
 }
 
+// Missing counters (negative) print as n/a
+static const char* fmt_mpki(char buf[16], double v) {
+    if (v < 0.0) snprintf(buf, 16, "n/a");
+    else snprintf(buf, 16, "%.2f", v);
+    return buf;
+}
+
+// " [3.10 GHz, 71 C, 28.4 W]" for a sample's line; "" without telemetry
+static void fmt_window(char* out, size_t len, const TelemetryWindow* w) {
+    out[0] = '\0';
+    if (!w->valid) return;
+    int n = snprintf(out, len, " [");
+    if (w->mhz > 0.0) n += snprintf(out + n, len - (size_t)n, "%.2f GHz, ", w->mhz / 1000.0);
+    if (w->temp_c >= 0.0) n += snprintf(out + n, len - (size_t)n, "%.0f C, ", w->temp_c);
+    if (w->pkg_joules >= 0.0 && w->seconds > 0.0) n += snprintf(out + n, len - (size_t)n, "%.1f W, ", w->pkg_joules / w->seconds);
+    if (w->throttle_events > 0) n += snprintf(out + n, len - (size_t)n, "%ld throttle events, ", w->throttle_events);
+    if (n == 2) out[0] = '\0';
+    else snprintf(out + n - 2, len - (size_t)n + 2, "]");
+}
+
+// "1.95 mJ", "420 nJ"
+static const char* fmt_joules(char buf[24], double j) {
+    static const char* prefix[] = { "", "m", "u", "n", "p" };
+    int k = 0;
+    while (j < 1.0 && k < 4) { j *= 1000.0; k++; }
+    snprintf(buf, 24, "%.3g %sJ", j, prefix[k]);
+    return buf;
+}
+
+// Summary lines under a result: clock and temperature with the throttled
+// samples by number, then power and energy per unit of work
+static void print_telemetry(const TelemetrySummary* t, const char* unit) {
+    if (!t->valid) return;
+    const int clock = t->mhz > 0.0 || t->temp_c >= 0.0;
+    if (clock) {
+        printf("    ");
+        if (t->mhz > 0.0) printf(" %.2f GHz mean (slowest sample %.2f),", t->mhz / 1000.0, t->mhz_min / 1000.0);
+        if (t->temp_c >= 0.0) printf(" max %.0f C,", t->temp_c);
+        if (t->throttled == 0) {
+            printf(" no throttling\n");
+        } else {
+            printf(" THROTTLED in %d of %d samples:", t->throttled, t->n);
+            for (int i = 0; i < t->n; ++i) {
+                if (t->windows[i].throttled) printf(" %d", i + 1);
+            }
+            printf("\n");
+        }
+    } else if (t->throttled > 0) {
+        printf("     THROTTLED in %d of %d samples\n", t->throttled, t->n);
+    }
+    if (t->pkg_watts > 0.0) {
+        char work[32], jb[24];
+        printf("     Energy: package %.1f W", t->pkg_watts);
+        if (t->dram_watts > 0.0) printf(", DRAM %.1f W", t->dram_watts);
+        if (t->work_per_joule > 0.0 && unit_of_work(unit, work, sizeof(work))) {
+            printf("; %.4g %s/J, %s/%s", t->work_per_joule, work, fmt_joules(jb, t->joules_per_work), work);
+        }
+        printf("\n");
+    }
+}
+
+// One sample: `reps` back-to-back repetitions. Every repetition does the same
+// work, so the sample's throughput is the harmonic mean of theirs.
+static double run_sample(const TestCase* tc, int reps, PerfTotals* sum, Measurement* m) {
+    double inv = 0.0;
+    for (int r = 0; r < reps; ++r) {
+        perf_reset_totals();
+        const double v = tc->run_once();
+        PerfTotals pt;
+        perf_read_totals(&pt);
+        for (int k = 0; k < PERF_EVENT_COUNT; ++k) {
+            sum->count[k] += pt.count[k];
+            sum->valid[k] = pt.valid[k];
+        }
+        sum->thread_seconds += pt.thread_seconds;
+
+        PoolStats ps;
+        pool_last_stats(&ps);
+        double tlo = (tc->flags & TC_SCALES) ? ps.thread_min : v;
+        double thi = (tc->flags & TC_SCALES) ? ps.thread_max : v;
+
+        if (tlo < m->tmin) m->tmin = tlo;
+        if (thi > m->tmax) m->tmax = thi;
+        if (v <= 0.0) return 0.0;
+        inv += 1.0 / v;
+    }
+    return (double)reps / inv;
+}
+
+// Warm-up plus K timed runs of one test at a fixed team size. With
+// cfg->ci_repeat, runs continue past K until the CI of the median is narrow.
+// With cfg->test_seconds, samples are instead batches of repetitions lasting
+// about cfg->sample_seconds, taken until the test's time budget (warm-up
+// included) is spent.
+static Measurement measure(const TestCase* tc, const BenchConfig* cfg, int threads, int verbose) {
+    Measurement m;
+    memset(&m, 0, sizeof(m));
+    m.threads = threads;
+    m.tmin = DBL_MAX;
+    pool_set_team(threads);
+
+    const int timed = cfg->test_seconds > 0.0;
+    const int K = cfg->repetitionsK < 1 ? 1 : cfg->repetitionsK;
+    int cap = (cfg->ci_repeat && cfg->repetitions_max > K) ? cfg->repetitions_max : K;
+    if (timed) cap = cfg->repetitions_max > TIMEBOX_MIN_SAMPLES ? cfg->repetitions_max : TIMEBOX_MIN_SAMPLES;
+    double* samples = (double*)malloc((size_t)cap * sizeof(double));
+    TelemetryWindow* windows = (TelemetryWindow*)calloc((size_t)cap, sizeof(TelemetryWindow));
+    if (!samples || !windows) {
+        free(samples);
+        free(windows);
+        return m;
+    }
+
+    // Buffers are built once for all runs at this team size
+    if (tc->prepare && !tc->prepare()) {
+        fprintf(stderr, "[%s] prepare failed (out of memory?), skipped\n", tc->id);
+        free(samples);
+        free(windows);
+        arena_reset();
+        return m;
+    }
+
+    const double deadline = timer_now_seconds() + cfg->test_seconds;
+
+    // Warm-up (unmeasured). Time-boxed, the last warm-up repetition also sets
+    // the batch size; without warm-up one unmeasured repetition does.
+    const int scalable = timed && (tc->flags & TC_WORK_SCALES);
+    if (scalable) work_fraction = TIMEBOX_PROBE_FRACTION;
+    double dt = 0.0;
+    for (int w = 0; w < cfg->warmup || (timed && w == 0); ++w) {
+        const double t0 = timer_now_seconds();
+        (void)tc->run_once();
+        dt = timer_now_seconds() - t0;
+    }
+    int reps = 1;
+    if (timed) {
+        if (scalable) {
+            const double full = dt / work_fraction;
+            double f = (full > 0.0) ? cfg->sample_seconds / full : 1.0;
+            if (f > 1.0) f = 1.0;
+            if (f < TIMEBOX_MIN_FRACTION) f = TIMEBOX_MIN_FRACTION;
+            work_fraction = f;
+            dt = full * f;
+        }
+        if (dt > 0.0 && dt < cfg->sample_seconds) {
+            const double r = cfg->sample_seconds / dt + 0.5;
+            reps = r > TIMEBOX_MAX_REPS ? TIMEBOX_MAX_REPS : (int)r;
+        }
+    }
+
+    PerfTotals sum;
+    memset(&sum, 0, sizeof(sum));
+
+    int n = 0;
+    while (n < cap) {
+        telemetry_window_begin(threads);
+        const double v = run_sample(tc, reps, &sum, &m);
+        telemetry_window_end(&windows[n]);
+        samples[n++] = v;
+        if (verbose) {
+            char tele[96];
+            fmt_window(tele, sizeof(tele), &windows[n - 1]);
+            if (timed) printf("[%s] T=%d sample %d (x%d): %.1f %s%s\n", tc->id, threads, n, reps, v, tc->unit, tele);
+            else printf("[%s] T=%d run %d/%d: %.1f %s%s\n", tc->id, threads, n, cap, v, tc->unit, tele);
+        }
+
+        if (timed && n >= TIMEBOX_MIN_SAMPLES && timer_now_seconds() >= deadline) break;
+        if (cfg->ci_repeat && n >= (timed ? TIMEBOX_MIN_SAMPLES : K) && n >= CI_MIN_RUNS) {
+            stats_summarize(samples, n, &m.s);
+            if (stats_ci_rel_width(&m.s) <= cfg->ci_target) break;
+        }
+    }
+    stats_summarize(samples, n, &m.s);
+    perf_summarize(&sum, &m.perf);
+    telemetry_summarize(windows, n, m.s.median, &m.tele);
+    char work[32];
+    if (!unit_of_work(tc->unit, work, sizeof(work))) m.tele.work_per_joule = m.tele.joules_per_work = -1.0;   // not a rate
+    m.samples = samples;
+    m.windows = windows;
+    work_fraction = 1.0;
+
+    if (tc->teardown) tc->teardown();
+    arena_reset();
+    return m;
+}
+
 void suite_run_with_callback(StatusCallback cb) {
     const int K = 5;
 
@@ -56,130 +352,456 @@ void suite_run_with_callback(StatusCallback cb) {
     }
 }
 
-void run_test_by_id(int id, StatusCallback cb) {
+void run_test_by_id(const char* id, StatusCallback cb) {
     const BenchConfig* cfg = bench_config_defaults();
     const int K = cfg->repetitionsK;
+    const TestCase* tc = registry_find(id);
+    if (!tc) return;
+
+    int pins[TOPO_MAX_CPUS];
+    const int npin = pin_cpus(cfg, tc, -1, pins);
+    const int team = resolve_threads(cfg);
+    apply_pins(tc, pins, npin);
+    pool_set_team((tc->flags & TC_SCALES) ? (npin > 0 && npin < team ? npin : team) : 1);
+    arena_set_huge(cfg->arena_hugepages);
+
+    const int ready = !tc->prepare || tc->prepare();
+    if (ready && !(tc->flags & TC_SELF_WARMING)) (void)tc->run_once();
 
     for (int r = 0; r < K; ++r) {
-        double score = 0.0;
+        const double score = ready ? tc->run_once() : 0.0;
+        if (cb) cb(r + 1, score);
+    }
 
-        switch (id) {
-        case TEST_INTEGER:
-            if (r == 0) integer_mips_once(); // Warmup
-            score = integer_mips_once();
-            break;
+    if (tc->teardown) tc->teardown();
+    apply_pins(tc, NULL, 0);
+    arena_reset();
+}
 
-        case TEST_FLOAT:
-            if (r == 0) float_mflops_once();
-            score = float_mflops_once();
-            break;
+// Helper to get reference values (for grading); 0 = no reference
+API double get_test_reference(const char* id) {
+    return id ? refs_lookup(id) : 0.0;
+}
 
-        case TEST_MEMORY:
-            if (r == 0) memory_mbps_once();
-            score = memory_mbps_once();
-            break;
+static const SweepEntry sweeps[] = {
+    { "ISA",  "Float kernels by ISA",      "MFLOPS", float_isa_sweep },
+    { "GEMM", "Matrix multiply by size",   "GFLOPS", gemm_gflops_sweep },
+    { "GEMMP", "Matrix multiply vs. peak", "%",    gemm_peak_pct_sweep },
+    { "LAT",  "Pointer-chase latency",     "ns",   memory_latency_sweep },
+    { "BWM",  "Bandwidth by size and pattern", "MB/s", memory_bandwidth_sweep },
+    { "NUMA", "Triad by CPU/memory node",  "MB/s", memory_numa_sweep },
+    { "CR",   "Compression ratio",         "x",    compress_ratio_sweep },
+    { "QDI",  "Disk 4K random read IOPS",  "IOPS", disk_qd_iops_sweep },
+    { "QDB",  "Disk 4K random read bandwidth", "MB/s", disk_qd_mbps_sweep },
+    { "QDL",  "Disk 4K read completion latency", "us", disk_qd_latency_sweep }
+};
+
+// Comma-separated id list for the grade summary
+static void append_id(char* list, size_t cap, const char* id) {
+    const size_t len = strlen(list);
+    if (len < cap) snprintf(list + len, cap - len, "%s%s", len ? ", " : "", id);
+}
 
-        case TEST_AES:
-            if (r == 0) aes_mbps_once();
-            score = aes_mbps_once();
-            break;
+// cfg->tests lists ids separated by ',', '+' or ' '; an empty list selects all
+static int is_selected(const char* list, const char* id) {
+    if (!list[0]) return 1;
+    const size_t len = strlen(id);
+    for (const char* p = list; *p;) {
+        while (*p == ',' || *p == '+' || *p == ' ') ++p;
+        const size_t n = strcspn(p, ",+ ");
+        if (n == len && strncmp(p, id, n) == 0) return 1;
+        p += n;
+    }
+    return 0;
+}
 
-        case TEST_COMP:
-            if (r == 0) compress_mbps_once();
-            score = compress_mbps_once();
-            break;
+int suite_has_id(const char* id) {
+    const int S = (int)(sizeof(sweeps) / sizeof(sweeps[0]));
+    if (!id) return 0;
+    if (registry_find(id)) return 1;
+    for (int s = 0; s < S; ++s) {
+        if (strcmp(sweeps[s].id, id) == 0) return 1;
+    }
+    return 0;
+}
 
-        case TEST_MEMORY_LATENCY:
-            score = memory_random_mops_once();
-            break;
+void suite_print_registry(void) {
+    const int T = registry_count();
+    const int S = (int)(sizeof(sweeps) / sizeof(sweeps[0]));
+    printf("Tests:\n");
+    for (int t = 0; t < T; ++t) {
+        const TestCase* tc = registry_get(t);
+        const char* src = registry_source(t);
+        const int plugin = strcmp(src, "built-in") != 0;
+        printf("  %-5s %-10s %-34s %s%s%s%s\n", tc->id, tc->unit, tc->title,
+            (tc->flags & TC_SCALES) ? "multi-threaded" : "single-threaded",
+            (tc->flags & TC_GRADED) ? ", graded" : "", plugin ? ", plugin " : "", plugin ? src : "");
+    }
+    printf("Sweeps:\n");
+    for (int s = 0; s < S; ++s) {
+        printf("  %-5s %-10s %s\n", sweeps[s].id, sweeps[s].unit, sweeps[s].title);
+    }
+}
 
-        case TEST_DISK:
-            if (r == 0) disk_benchmark_mbps_once();
-            score = disk_benchmark_mbps_once();
-			break;
+// Warns about ids in the selection that name nothing
+static void check_selection(const char* list) {
+    char id[64];
+    for (const char* p = list; *p;) {
+        while (*p == ',' || *p == '+' || *p == ' ') ++p;
+        const size_t n = strcspn(p, ",+ ");
+        if (n > 0) {
+            snprintf(id, sizeof(id), "%.*s", (int)n, p);
+            if (!suite_has_id(id)) fprintf(stderr, "Unknown test id '%s' ignored (see --list)\n", id);
+        }
+        p += n;
+    }
+}
 
-        default:
-            score = 0.0;
+// Mixed-load mode: the tests named in cfg->mixed_tests run at the same time, the
+// team split between them. Rows are "MIX_<id>", efficiency = mixed / solo median.
+static void run_mixed(const BenchConfig* cfg, Report* rep) {
+    MixedWorkload w[MIXED_MAX_WORKLOADS];
+    char list[sizeof(cfg->mixed_tests)];
+    int n = 0;
+
+    snprintf(list, sizeof(list), "%s", cfg->mixed_tests);
+    for (char* tok = strtok(list, ",+ "); tok; tok = strtok(NULL, ",+ ")) {
+        const TestCase* tc = registry_find(tok);
+        if (!tc) {
+            fprintf(stderr, "[MIX] unknown test '%s', skipped\n", tok);
+            continue;
+        }
+        if (tc->flags & TC_NO_MIX) {
+            fprintf(stderr, "[MIX] %s cannot run alongside other tests, skipped\n", tok);
+            continue;
+        }
+        // Tests of one module share its prepared state; only one of them may run
+        int clash = 0;
+        for (int k = 0; k < n; ++k) {
+            clash |= (w[k].tc->run_once == tc->run_once) ||
+                     (tc->prepare && w[k].tc->prepare == tc->prepare);
+        }
+        if (clash) {
+            fprintf(stderr, "[MIX] %s shares state with an earlier workload, skipped\n", tok);
+            continue;
+        }
+        if (n == MIXED_MAX_WORKLOADS) {
+            fprintf(stderr, "[MIX] at most %d workloads, '%s' and later skipped\n", MIXED_MAX_WORKLOADS, tok);
             break;
         }
+        memset(&w[n], 0, sizeof(w[n]));
+        w[n].tc = tc;
+        w[n].threads = (tc->flags & TC_SCALES) ? 0 : 1;
+        n++;
+    }
+    if (n == 0) return;
 
-        if (cb) cb(r + 1, score);
+    // Scaling tests split the team evenly; single-threaded ones take one worker
+    int fixed = 0, scaling = 0;
+    for (int g = 0; g < n; ++g) {
+        if (w[g].threads) fixed++;
+        else scaling++;
+    }
+    const int share = scaling ? (resolve_threads(cfg) - fixed) / scaling : 0;
+    for (int g = 0; g < n; ++g) {
+        if (!w[g].threads) w[g].threads = share > 1 ? share : 1;
     }
-}
 
-// Helper to get reference values (for grading)
-API double get_test_reference(int id) {
-    const BenchRefs* refs = bench_refs_defaults();
-    switch (id) {
-    case TEST_INTEGER: return refs->pref_integer_mips;
-    case TEST_FLOAT:   return refs->pref_float_mflops;
-    case TEST_MEMORY:  return refs->pref_mem_mbps;
-    case TEST_AES:     return refs->pref_aes_mbps;
-    case TEST_COMP:    return refs->pref_comp_mbps;
-    case TEST_MEMORY_LATENCY: return refs->pref_latency_mops;
-    case TEST_DISK:    return refs->pref_disk_mbps;
-    default: return 1.0;
+    printf("--- Mixed load:");
+    for (int g = 0; g < n; ++g) printf("%s%s", g ? " + " : " ", w[g].tc->id);
+    printf(", %.1f s solo and %.1f s together ---\n", cfg->mixed_seconds, cfg->mixed_seconds);
+
+    arena_reset();
+    if (!mixed_run(w, n, cfg->mixed_seconds)) {
+        fprintf(stderr, "[MIX] could not place the workloads on worker groups\n");
+        arena_reset();
+        return;
+    }
+    arena_reset();
+
+    for (int g = 0; g < n; ++g) {
+        const TestCase* tc = w[g].tc;
+        if (!w[g].ok) continue;
+        const double rel = (w[g].solo.median > 0.0) ? w[g].mixed.median / w[g].solo.median : 0.0;
+        printf("[MIX] %-4s T=%-3d solo %.1f %s, mixed %.1f %s: %.1f%% of solo (n=%d)\n",
+            tc->id, w[g].threads, w[g].solo.median, tc->unit, w[g].mixed.median, tc->unit,
+            100.0 * rel, w[g].mixed.n);
+        if (rep) {
+            char id[64], title[128];
+            snprintf(id, sizeof(id), "MIX_%s", tc->id);
+            snprintf(title, sizeof(title), "Mixed load: %s", tc->title);
+            report_write(rep, id, title, tc->unit, w[g].threads, &w[g].mixed, NULL,
+                w[g].mixed.median, w[g].mixed.median, rel, 0.0, NULL, NULL);
+        }
     }
+    printf("\n");
 }
 
-
 void suite_run_all(void) {
     const BenchConfig* cfg = bench_config_defaults();
-    const BenchRefs* ref = bench_refs_defaults();
-
-    // Single source of truth for the registry:
-    static const TestEntry tests[] = {
-        { "INT", "Integer checksum mix",     "MIPS",   PREF_INT,  integer_mips_once },
-        { "FP",  "Floating-point dot",       "MFLOPS", PREF_FP,   float_mflops_once },
-        { "MEM", "Memory TRIAD (A=B+s*C)",   "MB/s",   PREF_MEM,  memory_mbps_once },
-        { "AES", "AES-128 ECB (throughput)", "MB/s",   PREF_AES,  aes_mbps_once },
-        { "CMP", "DEFLATE-style codec",      "MB/s",   PREF_COMP, compress_mbps_once },
-        { "RND", "Memory Random Latency",    "MOPS",   PREF_LATENCY, memory_random_mops_once },
-		{ "DSK", "Disk I/O Throughput",     "MB/s",   PREF_DISK, disk_benchmark_mbps_once }
-    };
-    const int T = (int)(sizeof(tests) / sizeof(tests[0]));
+    const int T = registry_count();
+
+    int plan[32];
+    const int P = thread_plan(cfg, plan, 32);
 
     printf("=== PC Benchmark (multi-algorithm run) ===\n");
-    printf("K=%d, warmup=%d\n\n", cfg->repetitionsK, cfg->warmup);
+    if (cfg->test_seconds > 0.0) {
+        printf("Time-boxed: samples of ~%.0f ms for %.1f s per test, warmup=%d, threads=%d%s\n",
+            1000.0 * cfg->sample_seconds, cfg->test_seconds, cfg->warmup,
+            plan[P - 1], cfg->thread_sweep ? " (sweep)" : "");
+    } else {
+        printf("K=%d, warmup=%d, threads=%d%s\n", cfg->repetitionsK, cfg->warmup,
+            plan[P - 1], cfg->thread_sweep ? " (sweep)" : "");
+    }
+    arena_set_huge(cfg->arena_hugepages);
+    perf_set_enabled(cfg->perf_counters);
+    if (cfg->perf_counters) {
+        printf("Hardware counters: %s\n", perf_available()
+            ? "cycles, instructions, LLC/dTLB/branch misses"
+            : "unavailable (no PMU access; see perf_event_paranoid)");
+    }
+    if (cfg->tests[0]) {
+        printf("Selected: %s\n", cfg->tests);
+        check_selection(cfg->tests);
+    }
+    if (cfg->ci_repeat) {
+        printf("Repeating until the 95%% CI of the median is within %.1f%% (max %d runs)\n",
+            100.0 * cfg->ci_target, cfg->repetitions_max);
+    }
+    refs_select(cfg->refs_path, cfg->ref_class, bench_profile_name(bench_config_profile()), resolve_threads(cfg));
+    printf("References: %s\n", refs_source());
+    const Topology* topo = topology_get();
+    char topo_line[256];
+    topology_summary(topo_line, sizeof(topo_line));
+    printf("Topology: %s\n", topo_line);
+    if (cfg->telemetry_ms > 0 || cfg->energy) {
+        if (!telemetry_start(cfg->telemetry_ms, cfg->energy)) {
+            printf("Telemetry: unavailable (no readable cpufreq, hwmon, thermal zone or RAPL energy)\n");
+        } else if (cfg->telemetry_ms > 0) {
+            printf("Telemetry: every %d ms (%s)\n", cfg->telemetry_ms, telemetry_sources());
+        } else {
+            printf("Telemetry: energy only (%s)\n", telemetry_sources());
+        }
+    }
+    check_pinning(cfg);
+    if (strcmp(cfg->pin, "none") != 0 || cfg->pin_tests[0]) {
+        printf("Pinning: %s%s%s\n", cfg->pin, cfg->pin_tests[0] ? "; per test " : "", cfg->pin_tests);
+    }
+    printf("\n");
 
-    double grade_sum = 0.0;
-    
-    //Open
-    FILE* csv = report_csv_begin("results/run.csv");
+    // Geometric mean: a single outlier index cannot dominate the grade
+    double log_sum = 0.0;
+    int graded = 0;
+    char failed[128] = "", unreferenced[128] = "";   // graded tests left out of the grade
 
-    for (int t = 0; t < T; ++t) {
-        const TestEntry* e = &tests[t];
+    Report* rep = report_begin(cfg->output_path, cfg->output_format);
+    if (!rep) fprintf(stderr, "Cannot open %s, results are not saved\n", cfg->output_path);
 
-        // warm-up (unmeasured)
-        for (int w = 0; w < cfg->warmup; ++w) (void)e->once();
+    for (int t = 0; t < T; ++t) {
+        const TestCase* tc = registry_get(t);
+        const int scales = (tc->flags & TC_SCALES) != 0;
+        if (!is_selected(cfg->tests, tc->id)) continue;
+        const int steps = scales ? P : 1;
+        double base = 0.0;   // single-thread average, for scaling efficiency
+        const double pref = refs_lookup(tc->id);
+        double index = 0.0;
+
+        int pins[TOPO_MAX_CPUS];
+        const int npin = pin_cpus(cfg, tc, -1, pins);
+        apply_pins(tc, pins, npin);
+
+        // Fixed multi-thread runs still need a 1-thread baseline for the efficiency column
+        if (scales && plan[0] > 1) {
+            Measurement one = measure(tc, cfg, 1, 0);
+            base = one.s.median;
+            measurement_free(&one);
+        }
 
-        double sum = 0.0, minv = DBL_MAX, maxv = 0.0;
-        for (int r = 0; r < cfg->repetitionsK; ++r) {
-            double v = e->once();
-            if (v < minv) minv = v;
-            if (v > maxv) maxv = v;
-            sum += v;
-            printf("[%s] run %d/%d: %.1f %s\n", e->id, r + 1, cfg->repetitionsK, v, e->unit);
+        int last = 0;
+        for (int p = 0; p < steps; ++p) {
+            // A pinned team is no larger than its CPU set
+            int threads = scales ? plan[p] : 1;
+            if (npin > 0 && threads > npin) threads = npin;
+            if (threads == last) continue;
+            last = threads;
+            const Measurement m = measure(tc, cfg, threads, 1);
+            if (threads == 1) base = m.s.median;
+
+            // Median, not mean: one descheduled run must not move the score
+            const double speedup = (base > 0.0) ? (m.s.median / base) : 0.0;
+            const double efficiency = speedup / (double)threads;
+            index = (pref > 0.0) ? (m.s.median / pref) : 0.0;
+
+            if (rep) {
+                report_write(rep, tc->id, tc->title, tc->unit, threads,
+                    &m.s, m.samples, m.tmin, m.tmax, efficiency, index, &m.perf, &m.tele);
+            }
+
+            char ibuf[32] = "n/a";
+            if (index > 0.0) snprintf(ibuf, sizeof(ibuf), "%.3f", index);
+            printf("  -> %s median: %.1f %s  [p5 %.1f, p95 %.1f], 95%% CI [%.1f, %.1f], CV %.1f%%, n=%d, index %s\n",
+                tc->title, m.s.median, tc->unit, m.s.p5, m.s.p95, m.s.ci_lo, m.s.ci_hi,
+                100.0 * m.s.cv, m.s.n, ibuf);
+            if (m.perf.valid) {
+                char llc[16], tlb[16], br[16];
+                printf("     IPC %.2f, %.2f GHz, MPKI: LLC %s, dTLB %s, branch %s\n",
+                    m.perf.ipc, m.perf.ghz, fmt_mpki(llc, m.perf.llc_mpki),
+                    fmt_mpki(tlb, m.perf.dtlb_mpki), fmt_mpki(br, m.perf.branch_mpki));
+            }
+            print_telemetry(&m.tele, tc->unit);
+            if (scales && threads > 1) {
+                printf("     T=%d per-thread [min %.1f, max %.1f] %s, speedup %.2fx, efficiency %.2f\n",
+                    threads, m.tmin, m.tmax, tc->unit, speedup, efficiency);
+            }
+            printf("\n");
+            measurement_free(&m);
+        }
 
-            
+        // Hybrid CPUs: the test once more on each core type alone, as "<ID>_P" / "<ID>_E"
+        for (int type = CORE_TYPE_PERF; cfg->core_types && topo->hybrid && type <= CORE_TYPE_EFF; ++type) {
+            int n = pin_cpus(cfg, tc, type, pins);
+            if (n == 0) n = topology_pin_set("cores", type, pins, TOPO_MAX_CPUS);
+            if (n <= 0) continue;
+            apply_pins(tc, pins, n);
+            const int threads = scales ? n : 1;
+            const Measurement m = measure(tc, cfg, threads, 0);
+            const double efficiency = (base > 0.0) ? m.s.median / base / (double)threads : 0.0;
+            char id[64], title[128];
+            snprintf(id, sizeof(id), "%s_%s", tc->id, topology_type_short(type));
+            snprintf(title, sizeof(title), "%s (%ss)", tc->title, topology_type_name(type));
+            printf("  -> %s only: %.1f %s, T=%d, CV %.1f%%, n=%d\n", topology_type_name(type),
+                m.s.median, tc->unit, threads, 100.0 * m.s.cv, m.s.n);
+            if (rep) {
+                report_write(rep, id, title, tc->unit, threads,
+                    &m.s, m.samples, m.tmin, m.tmax, efficiency, 0.0, &m.perf, &m.tele);
+            }
+            measurement_free(&m);
         }
+        if (cfg->core_types && topo->hybrid) printf("\n");
+        apply_pins(tc, NULL, 0);
 
-        const double avg = sum / (double)cfg->repetitionsK;
-        const double pref = pick_pref(e->prefk, ref);
-        const double index = (pref > 0.0) ? (avg / pref) : 0.0;
+        // Grade on the widest thread count measured
+        if ((tc->flags & TC_GRADED) && index > 0.0) {
+            log_sum += log(index);
+            graded++;
+        }
+        else if ((tc->flags & TC_GRADED) && pref > 0.0) append_id(failed, sizeof(failed), tc->id);
+        else if (tc->flags & TC_GRADED) append_id(unreferenced, sizeof(unreferenced), tc->id);
+    }
 
-        if (csv) {
-            report_csv_write(csv, e->id, e->title, e->unit, avg, minv, maxv, index);
+    const int S = (int)(sizeof(sweeps) / sizeof(sweeps[0]));
+
+    // Sweeps run unpinned on the configured team, not whatever the last test left
+    pool_set_team(resolve_threads(cfg));
+    for (int s = 0; s < S; ++s) {
+        const SweepEntry* e = &sweeps[s];
+        if (!is_selected(cfg->tests, e->id)) continue;
+        SweepPoint pts[SWEEP_MAX_POINTS];
+        memset(pts, 0, sizeof(pts));
+        printf("--- %s sweep ---\n", e->title);
+        const int n = e->fn(pts, SWEEP_MAX_POINTS);
+        for (int i = 0; i < n; ++i) {
+            // Bounded so id and title always fit: id <= 15 + 1 + 31, title <= 79 + 1 + 31
+            const int lab = (int)sizeof(pts[i].label) - 1;
+            char id[64], title[128];
+            snprintf(id, sizeof(id), "%.15s_%.*s", e->id, lab, pts[i].label);
+            snprintf(title, sizeof(title), "%.79s %.*s", e->title, lab, pts[i].label);
+            printf("[%s] %8s: %.2f %s\n", e->id, pts[i].label, pts[i].value, e->unit);
+            if (rep) {
+                const double v = pts[i].value;
+                SampleStats one;
+                stats_summarize(&v, 1, &one);
+                const int threads = pts[i].threads > 0 ? pts[i].threads : pool_team();
+                report_write(rep, id, title, e->unit, threads, &one, &v, v, v, 1.0, 0.0, NULL, NULL);
+            }
         }
+        printf("\n");
+    }
+
+    if (cfg->mixed_tests[0]) run_mixed(cfg, rep);
 
-        printf("  -> %s average: %.1f %s  [min %.1f, max %.1f], index = %.3f\n\n",
-            e->title, avg, e->unit, minv, maxv, index);
+    telemetry_stop();
+    report_end(rep);
+    arena_release();
 
-        grade_sum += index;
+    if (graded > 0) {
+        printf("=== Final grade (geometric mean of indices over %d algorithms): %.3f%s ===\n",
+            graded, exp(log_sum / (double)graded), failed[0] ? " INCOMPLETE" : "");
+    } else {
+        printf("=== No final grade: no graded test has an index ===\n");
     }
+    // A failed test would otherwise just drop out, and could raise the grade
+    if (failed[0]) printf("    no result from %s; the grade is not comparable\n", failed);
+    if (unreferenced[0]) printf("    ungraded, no reference: %s\n", unreferenced);
+}
 
-    report_csv_end(csv);
+// Calibration: the selected tests measured `runs` times at the full team (one
+// thread if the test does not scale). The median of the per-run medians becomes
+// the reference, their CV its run-to-run variance. Sweeps and mixed load are skipped.
+int suite_calibrate(int runs) {
+    const BenchConfig* cfg = bench_config_defaults();
+    const int T = registry_count();
+    const char* profile = bench_profile_name(bench_config_profile());
+    const int team = resolve_threads(cfg);
+    if (runs < 1) runs = 1;
+
+    RefValue values[REFS_MAX_TESTS];
+    double* medians = (double*)calloc((size_t)T * (size_t)runs, sizeof(double));
+    if (!medians) return 0;
+
+    printf("=== PC Benchmark calibration: %d runs, profile %s ===\n", runs, profile);
+    if (cfg->tests[0]) {
+        printf("Selected: %s\n", cfg->tests);
+        check_selection(cfg->tests);
+    }
+    printf("\n");
+    arena_set_huge(cfg->arena_hugepages);
+    perf_set_enabled(0);
+
+    // Runs outermost, so drift over time spreads across every test alike
+    for (int r = 0; r < runs; ++r) {
+        printf("--- Run %d of %d ---\n", r + 1, runs);
+        for (int t = 0; t < T; ++t) {
+            const TestCase* tc = registry_get(t);
+            if (!is_selected(cfg->tests, tc->id)) continue;
+            int pins[TOPO_MAX_CPUS];
+            const int npin = pin_cpus(cfg, tc, -1, pins);
+            apply_pins(tc, pins, npin);
+            const int threads = (tc->flags & TC_SCALES) ? (npin > 0 && npin < team ? npin : team) : 1;
+            const Measurement m = measure(tc, cfg, threads, 0);
+            apply_pins(tc, NULL, 0);
+            medians[t * runs + r] = m.s.median;
+            printf("  %-5s %.1f %s (n=%d)\n", tc->id, m.s.median, tc->unit, m.s.n);
+            measurement_free(&m);
+        }
+    }
+    arena_release();
+
+    int count = 0;
+    printf("\n");
+    for (int t = 0; t < T && count < REFS_MAX_TESTS; ++t) {
+        const TestCase* tc = registry_get(t);
+        if (!is_selected(cfg->tests, tc->id)) continue;
+        SampleStats s;
+        stats_summarize(&medians[t * runs], runs, &s);
+        if (s.median <= 0.0) {
+            fprintf(stderr, "%s produced no result, not written\n", tc->id);
+            continue;
+        }
+        snprintf(values[count].id, sizeof(values[count].id), "%s", tc->id);
+        values[count].median = s.median;
+        values[count].cv = s.cv;
+        printf("  %-5s reference %.1f %s, run-to-run CV %.1f%%%s\n", tc->id, s.median, tc->unit, 100.0 * s.cv,
+            s.cv > REFS_MAX_CV ? " (too noisy, will not be used)" : "");
+        count++;
+    }
+    free(medians);
 
-    const double final_grade = grade_sum / (double)T;
-    printf("=== Final grade (mean of indices over %d algorithms): %.3f ===\n", T, final_grade);
+    if (count == 0) return 0;
+    if (!refs_write_entry(cfg->refs_path, cfg->ref_class, profile, team, values, count, runs)) {
+        fprintf(stderr, "Cannot write %s\n", cfg->refs_path);
+        return 0;
+    }
+    printf("References written to %s (%s)\n", cfg->refs_path, refs_source());
+    return count;
 }
@@ -1,41 +1,47 @@
 ﻿import ctypes
+import math
 import os
 import platform
+import statistics
 import threading
 import time
 import customtkinter as ctk
 from matplotlib.figure import Figure
 from matplotlib.backends.backend_tkagg import FigureCanvasTkAgg
 
-REF_SPECS = """Reference System (Grade 10.0):
+REF_SPECS = """Built-in Reference System (Grade 1.00, STANDARD, 1 thread):
 OS:  Windows 11 Pro
 CPU: Intel Core i7-12700H (14 Cores), 20 logical processors
 GPU: NVIDIA GeForce RTX 3060 Laptop
 RAM: 16.0 GB DDR5"""
 
-# Tests Names
-TESTS = {
-    0: "Integer (MIPS)",
-    1: "Float (MFLOPS)",
-    2: "Memory Bandwidth (MB/s)",
-    3: "AES (MB/s)",
-    4: "Compression (MB/s)",
-    5: "Memory Latency (MOPS)",
-    6: "Disk I/O (MB/s)"
-}
-
-# C Struct Definition 
-class BenchConfig(ctypes.Structure):
+# TestCase.flags (testcase.h)
+TC_SCALES = 0x1
+TC_GRADED = 0x2
+
+# C Struct Definition (testcase.h)
+class TestCase(ctypes.Structure):
+    _fields_ = [
+        ("id", ctypes.c_char_p),
+        ("title", ctypes.c_char_p),
+        ("unit", ctypes.c_char_p),
+        ("prepare", ctypes.c_void_p),
+        ("run_once", ctypes.c_void_p),
+        ("teardown", ctypes.c_void_p),
+        ("reference", ctypes.c_double),
+        ("flags", ctypes.c_int)
+    ]
+
+# Configuration fields (config.h ConfigField): read BenchConfig by name through
+# the library's own field table, so the GUI never mirrors the struct layout
+CFG_INT, CFG_SIZE, CFG_DOUBLE, CFG_STR = range(4)
+
+class ConfigField(ctypes.Structure):
     _fields_ = [
-        ("repetitionsK", ctypes.c_int),
-        ("warmup", ctypes.c_int),
-        ("integer_block_bytes", ctypes.c_size_t),
-        ("integer_passes", ctypes.c_int),
-        ("float_N", ctypes.c_size_t),
-        ("triad_N", ctypes.c_size_t),
-        ("aes_bytes", ctypes.c_size_t),
-        ("comp_bytes", ctypes.c_size_t),
-        ("disk_bytes", ctypes.c_size_t)
+        ("name", ctypes.c_char_p),
+        ("type", ctypes.c_int),
+        ("offset", ctypes.c_size_t),
+        ("size", ctypes.c_size_t)
     ]
 
 # Load DLL
@@ -76,14 +82,57 @@ lib = ctypes.CDLL(dll_path)
 # Define C signatures
 CALLBACK_TYPE = ctypes.CFUNCTYPE(None, ctypes.c_int, ctypes.c_double)
 
-lib.run_test_by_id.argtypes = [ctypes.c_int, CALLBACK_TYPE]
-lib.get_test_reference.argtypes = [ctypes.c_int]
+lib.run_test_by_id.argtypes = [ctypes.c_char_p, CALLBACK_TYPE]
+lib.get_test_reference.argtypes = [ctypes.c_char_p]
 lib.get_test_reference.restype = ctypes.c_double
 lib.get_system_info_str.argtypes = [ctypes.c_char_p, ctypes.c_int]
 
 # Config Functions
 lib.set_config_profile.argtypes = [ctypes.c_int]
-lib.bench_config_defaults.restype = ctypes.POINTER(BenchConfig)
+lib.bench_config_defaults.restype = ctypes.c_void_p
+lib.bench_config_fields.argtypes = [ctypes.POINTER(ctypes.c_int)]
+lib.bench_config_fields.restype = ctypes.POINTER(ConfigField)
+
+def load_config_fields():
+    """Field name -> ConfigField, from the library's table."""
+    n = ctypes.c_int(0)
+    table = lib.bench_config_fields(ctypes.byref(n))
+    return {table[i].name.decode(): table[i] for i in range(n.value)}
+
+CONFIG_FIELDS = load_config_fields()
+
+def cfg_get(name):
+    """Current value of a BenchConfig member (int, float or str)."""
+    f = CONFIG_FIELDS[name]
+    addr = lib.bench_config_defaults() + f.offset
+    if f.type == CFG_INT:
+        return ctypes.c_int.from_address(addr).value
+    if f.type == CFG_SIZE:
+        return ctypes.c_size_t.from_address(addr).value
+    if f.type == CFG_DOUBLE:
+        return ctypes.c_double.from_address(addr).value
+    return ctypes.string_at(addr).decode()
+
+# Test Registry (built-in tests plus plugins)
+lib.registry_count.restype = ctypes.c_int
+lib.registry_get.argtypes = [ctypes.c_int]
+lib.registry_get.restype = ctypes.POINTER(TestCase)
+lib.registry_load_plugin_dir.argtypes = [ctypes.c_char_p]
+lib.registry_load_plugin_dir.restype = ctypes.c_int
+
+def load_tests():
+    """Test id -> (display name, flags), in registry order."""
+    lib.registry_load_plugin_dir(cfg_get("plugin_dir").encode())
+    tests = {}
+    for i in range(lib.registry_count()):
+        tc = lib.registry_get(i).contents
+        tests[tc.id.decode()] = (f"{tc.title.decode()} ({tc.unit.decode()})", tc.flags)
+    return tests
+
+TESTS = load_tests()
+
+def test_name(tid):
+    return TESTS[tid][0] if tid in TESTS else "Unknown"
 
 class BenchmarkApp(ctk.CTk):
     def __init__(self):
@@ -114,7 +163,7 @@ class BenchmarkApp(ctk.CTk):
         self.logo.pack(pady=(30, 10))
 
         # Grade
-        self.lbl_grade = ctk.CTkLabel(self.sidebar, text="Grade: -- / 10", text_color="#00FF00", font=("Arial", 24, "bold"))
+        self.lbl_grade = ctk.CTkLabel(self.sidebar, text="Grade: --", text_color="#00FF00", font=("Arial", 24, "bold"))
         self.lbl_grade.pack(pady=5)
 
         # Little Note (observation)
@@ -160,10 +209,11 @@ class BenchmarkApp(ctk.CTk):
         self.switch_mem.pack(padx=20, pady=5)
 
         self.buttons = {}
-        # Create buttons for basic tests
-        test_ids = [0, 1, 3, 4, 6] 
-        for tid in test_ids:
-            btn = ctk.CTkButton(self.sidebar, text=TESTS[tid].split()[0], 
+        # One button per graded test; the memory pair shares the toggle
+        for tid, (name, flags) in TESTS.items():
+            if not (flags & TC_GRADED) or tid in ("MEM", "RND"):
+                continue
+            btn = ctk.CTkButton(self.sidebar, text=name.split()[0], 
                                 command=lambda i=tid: self.run_test(i))
             btn.pack(padx=20, pady=3)
             self.buttons[tid] = btn
@@ -172,6 +222,14 @@ class BenchmarkApp(ctk.CTk):
         self.btn_mem = ctk.CTkButton(self.sidebar, text="Memory (Seq)", command=self.run_memory_test)
         self.btn_mem.pack(padx=20, pady=3)
 
+        # Every other registered test, plugins included
+        others = [tid for tid, (_, flags) in TESTS.items() if not (flags & TC_GRADED)]
+        if others:
+            self.other_var = ctk.StringVar(value=others[0])
+            ctk.CTkOptionMenu(self.sidebar, values=others, variable=self.other_var).pack(padx=20, pady=(10, 3))
+            ctk.CTkButton(self.sidebar, text="Run Selected",
+                          command=lambda: self.run_test(self.other_var.get())).pack(padx=20, pady=3)
+
         ctk.CTkFrame(self.sidebar, height=2, fg_color="gray40").pack(fill="x", pady=20, padx=20)
         
         self.btn_full = ctk.CTkButton(self.sidebar, text="RUN FULL SUITE", 
@@ -213,21 +271,21 @@ class BenchmarkApp(ctk.CTk):
         self.update_config_display()
 
     def update_config_display(self):
-        # Read the Struct from C
-        cfg_ptr = lib.bench_config_defaults()
-        cfg = cfg_ptr.contents
+        # Read the configuration from C
+        threads = cfg_get("threads")
         
         # Format Bytes to MiB
         to_mb = lambda b: f"{b / (1024*1024):.0f} MiB"
         
         text = (
-            f"Runs per Test: {cfg.repetitionsK}\n"
-            f"Integer Data:  {to_mb(cfg.integer_block_bytes)}\n"
-            f"Float Count:   {cfg.float_N:,} elems\n"
-            f"Memory Array:  {cfg.triad_N:,} elems\n"
-            f"AES Data:      {to_mb(cfg.aes_bytes)}\n"
-            f"Compress Data: {to_mb(cfg.comp_bytes)}\n"
-            f"Disk Data:     {to_mb(cfg.disk_bytes)}"
+            f"Runs per Test: {cfg_get('repetitionsK')}\n"
+            f"Integer Data:  {to_mb(cfg_get('integer_block_bytes'))}\n"
+            f"Float Count:   {cfg_get('float_N'):,} elems\n"
+            f"Memory Array:  {cfg_get('triad_N'):,} elems\n"
+            f"AES Data:      {to_mb(cfg_get('aes_bytes'))}\n"
+            f"Compress Data: {to_mb(cfg_get('comp_bytes'))}\n"
+            f"Disk Data:     {to_mb(cfg_get('disk_bytes'))} in {cfg_get('disk_dir') or '.'} (QD {cfg_get('disk_queue_depth')})\n"
+            f"Threads:       {threads if threads > 0 else ('all' if threads == 0 else 'half')}"
         )
         self.lbl_cfg_details.configure(text=text)
 
@@ -240,14 +298,14 @@ class BenchmarkApp(ctk.CTk):
 
     def run_memory_test(self):
         # Decide which ID to run based on toggle
-        tid = 5 if self.mem_mode.get() == "Latency" else 2
+        tid = "RND" if self.mem_mode.get() == "Latency" else "MEM"
         self.run_test(tid)
 
     def fetch_system_info(self):
         # Get User's Info from C
         try:
-            buf = ctypes.create_string_buffer(512)
-            lib.get_system_info_str(buf, 512)
+            buf = ctypes.create_string_buffer(1024)
+            lib.get_system_info_str(buf, 1024)
             user_specs = buf.value.decode("utf-8")
             
             # Update the Sidebar Label (Short version)
@@ -272,7 +330,7 @@ class BenchmarkApp(ctk.CTk):
         self.log_box.see("end")
 
     def run_test(self, test_id):
-        tname = TESTS.get(test_id, "Unknown")
+        tname = test_name(test_id)
         self.log(f"--- Starting {tname} ---")
         self.results[test_id] = []
 
@@ -290,7 +348,7 @@ class BenchmarkApp(ctk.CTk):
         def on_progress(run, score):
             self.after(0, self.update_data, test_id, run, score)
         c_cb = CALLBACK_TYPE(on_progress)
-        lib.run_test_by_id(test_id, c_cb)
+        lib.run_test_by_id(test_id.encode(), c_cb)
 
     def update_data(self, test_id, run, score):
         self.results[test_id].append(score)
@@ -313,7 +371,7 @@ class BenchmarkApp(ctk.CTk):
         self.ax.fill_between(runs, self.results[test_id], color='#00E5FF', alpha=0.1)
 
         # Text styling
-        tname = TESTS.get(test_id, "")
+        tname = test_name(test_id)
         self.ax.set_title(f"{tname}", color='#00E5FF', fontsize=12, fontweight='bold')
         self.ax.set_xlabel("Samples (Time)", color='gray', fontsize=9)
         
@@ -330,16 +388,16 @@ class BenchmarkApp(ctk.CTk):
         self.log(f"Run {run}: {score:,.1f}")
 
         # Check against the configured repetitions
-        cfg_ptr = lib.bench_config_defaults()
-        max_runs = cfg_ptr.contents.repetitionsK
+        max_runs = cfg_get("repetitionsK")
         
         if run == max_runs: 
              self.calculate_final_grade()
 
     def calculate_final_grade(self):
         print("--- DEBUG: STARTING GRADE CALCULATION ---")
-        total_ratio = 0
+        log_sum = 0.0
         count = 0
+        failed = []   # graded, referenced, but no score: the grade is incomplete
         
         # Iterate through all results
         for tid, scores in self.results.items():
@@ -347,28 +405,37 @@ class BenchmarkApp(ctk.CTk):
                 print(f"Skipping Test ID {tid} (No scores)")
                 continue
                 
-            best = max(scores)
-            ref = lib.get_test_reference(tid)
+            # Median, as the CLI scores: one lucky or descheduled run can't move it
+            median = statistics.median(scores)
+            if not (TESTS.get(tid, ("", 0))[1] & TC_GRADED):
+                continue
+            ref = lib.get_test_reference(tid.encode())
             
-            print(f"Test ID: {tid} | Your Score: {best:.2f} | Reference: {ref:.2f}")
+            print(f"Test ID: {tid} | Your Score: {median:.2f} | Reference: {ref:.2f}")
             
             # Check for valid reference AND valid score
-            if ref > 0:
-                ratio = best / ref
-                total_ratio += ratio
+            if ref > 0 and median > 0:
+                ratio = median / ref
+                log_sum += math.log(ratio)
                 count += 1
                 print(f"   -> Added Ratio: {ratio:.4f}")
+            elif ref > 0:
+                failed.append(tid)
+                print("   -> FAILED (no score)")
             else:
-                print("   -> IGNORED (Reference is 0)")
+                print("   -> IGNORED (no reference)")
 
-        print(f"--- SUMMARY: Count={count}, TotalRatio={total_ratio:.4f} ---")
+        print(f"--- SUMMARY: Count={count}, LogSum={log_sum:.4f} ---")
 
         if count > 0:
-            final_grade = (total_ratio / count) * 10.0
+            # Geometric mean, as the CLI grades: one outlier can't dominate
+            final_grade = math.exp(log_sum / count)
             print(f"✅ CALCULATED GRADE: {final_grade:.2f}")
             
             # Update Grade Label
-            new_text = f"Grade: {final_grade:.2f} / 10"
+            new_text = f"Grade: {final_grade:.2f} (1.00 = reference)"
+            if failed:
+                new_text += f" (incomplete: {', '.join(failed)})"
             self.lbl_grade.configure(text=new_text)
             self.lbl_grade.update() # Force redraw immediately
         else:
@@ -379,16 +446,16 @@ class BenchmarkApp(ctk.CTk):
         threading.Thread(target=self._run_full_sequence).start()
 
     def _run_full_sequence(self):        
-        ids_to_run = [0, 1, 2, 3, 4, 5, 6] 
+        ids_to_run = [tid for tid, (_, flags) in TESTS.items() if flags & TC_GRADED]
         for tid in ids_to_run:
-            self.after(0, self.log, f"Running {TESTS[tid]}...")
+            self.after(0, self.log, f"Running {test_name(tid)}...")
             self.results[tid] = []
             
             def on_progress(run, score, _tid=tid):
                 self.after(0, self.update_data, _tid, run, score)
             
             c_cb = CALLBACK_TYPE(on_progress)
-            lib.run_test_by_id(tid, c_cb)
+            lib.run_test_by_id(tid.encode(), c_cb)
             time.sleep(0.5)
         self.after(0, self.log, ">>> DONE <<<")
 
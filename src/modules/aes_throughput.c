@@ -1,33 +1,117 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include "timer.h"
 #include "config.h"
 #include "util.h"
+#include "threadpool.h"
+#include "aes_engine.h"
+#include "arena.h"
+#include "aes_throughput.h"
 
-double aes_mbps_once(void) {
-    const size_t V = bench_config_defaults()->aes_bytes; // total bytes
-    uint8_t* buf = (uint8_t*)malloc(V);
-    if (!buf) return 0.0;
+#define GCM_RECORD 16384   // TLS-sized record: each one is an independent GCM message
+#define GCM_AAD    13      // TLS 1.2 additional data length
 
-    // init not timed
-    for (size_t i = 0; i < V; i++) buf[i] = (uint8_t)(i * 131u);
+typedef enum { MODE_ECB, MODE_CTR, MODE_GCM } AesMode;
+
+typedef struct {
+    AesMode   mode;
+    AesEngine engine;
+    AesKey    key;
+    uint8_t*  buf;      // encrypted in place
+    size_t    bytes;
+} AesJob;
 
-    // timing: simulate 10 "rounds" over 16B blocks (ECB-like, no I/O)
-    timer_start();
-    for (size_t off = 0; off + 16 <= V; off += 16) {
-        uint32_t* w = (uint32_t*)(buf + off);
-        // 10 very cheap rounds to mimic steady compute on 16B
-        for (int r = 0; r < 10; r++) {
-            w[0] ^= 0x243F6A88u; w[0] = rotl32(w[0] + w[1], 5);
-            w[1] ^= 0x85A308D3u; w[1] = rotl32(w[1] + w[2], 7);
-            w[2] ^= 0x13198A2Eu; w[2] = rotl32(w[2] + w[3], 11);
-            w[3] ^= 0x03707344u; w[3] = rotl32(w[3] + w[0], 13);
+// Engine chosen and verified once; -1 until the self-tests ran, 0 if they failed
+static int       kat_state = -1;
+static AesEngine engine;
+
+static int aes_ready(void) {
+    if (kat_state < 0) {
+        engine = aes_best_engine();
+        kat_state = aes_self_test(AES_ENGINE_TABLE) && aes_self_test(engine);
+        printf("[AES] engine: %s, known-answer tests %s\n",
+            aes_engine_name(engine), kat_state ? "passed" : "FAILED");
+    }
+    return kat_state;
+}
+
+static void aes_worker(int tid, int nthreads, void* arg) {
+    const AesJob* job = (const AesJob*)arg;
+    const size_t unit = (job->mode == MODE_GCM) ? GCM_RECORD : 16;
+    const size_t units = job->bytes / unit;
+    const size_t begin = units * (size_t)tid / (size_t)nthreads;
+    const size_t end = units * (size_t)(tid + 1) / (size_t)nthreads;
+    uint8_t* p = job->buf + begin * unit;
+    const size_t len = (end - begin) * unit;
+
+    uint8_t iv[16] = { 0 };
+    uint8_t aad[GCM_AAD] = { 0 };
+    uint8_t tag[16];
+
+    pool_timed_begin(tid);
+    switch (job->mode) {
+    case MODE_ECB:
+        aes_ecb_encrypt(job->engine, &job->key, p, p, len / 16);
+        break;
+    case MODE_CTR:
+        // Counter continues from this slice's first block, as one long stream would
+        store_be64(iv + 8, (uint64_t)begin);
+        aes_ctr_xor(job->engine, &job->key, iv, p, p, len);
+        break;
+    case MODE_GCM:
+        for (size_t r = begin; r < end; ++r) {
+            store_be64(iv + 4, (uint64_t)r);   // per-record nonce, like a TLS sequence number
+            store_be64(aad, (uint64_t)r);
+            aes_gcm_encrypt(job->engine, &job->key, iv, aad, GCM_AAD,
+                job->buf + r * GCM_RECORD, job->buf + r * GCM_RECORD, GCM_RECORD, tag);
         }
+        break;
     }
-    double dt = timer_elapsed_seconds();
+    pool_timed_end(tid, (double)len / (1024.0 * 1024.0));
+
+    volatile uint8_t sink = tag[0]; (void)sink;
+}
 
-    volatile uint8_t sink = buf[0]; (void)sink;
-    free(buf);
+// Buffer and key schedule survive across repetitions; every pass encrypts
+// the previous pass's output in place, which costs the same
+static AesJob   prepared;
+static unsigned prepared_gen;
 
-    return ((double)V / dt) / (1024.0 * 1024.0); // MB/s
+int aes_prepare(void) {
+    const BenchConfig* cfg = bench_config_defaults();
+    const size_t V = cfg->aes_bytes; // total bytes
+    if (!aes_ready()) return 0;
+    if (prepared_gen == arena_generation() && prepared.bytes == V) return 1;
+
+    uint8_t* buf = (uint8_t*)arena_alloc(V);
+    if (!buf) return 0;
+
+    // init not timed
+    for (size_t i = 0; i < V; i++) buf[i] = (uint8_t)(i * 131u);
+
+    uint8_t key[32];
+    for (int i = 0; i < 32; ++i) key[i] = (uint8_t)(0xA5 ^ (i * 17));
+    prepared.engine = engine;
+    prepared.buf = buf;
+    prepared.bytes = V;
+    if (!aes_set_key(&prepared.key, key, cfg->aes_key_bits)) aes_set_key(&prepared.key, key, 128);
+    prepared_gen = arena_generation();
+    return 1;
 }
+
+void aes_teardown(void) { prepared_gen = 0; }
+
+static double aes_mode_once(AesMode mode) {
+    if (!aes_prepare()) return 0.0;
+    prepared.mode = mode;
+    pool_run(aes_worker, &prepared);
+
+    volatile uint8_t sink = prepared.buf[0]; (void)sink;
+    return pool_last_stats(NULL); // MB/s
+}
+
+double aes_mbps_once(void)     { return aes_mode_once(MODE_ECB); }
+double aes_ctr_mbps_once(void) { return aes_mode_once(MODE_CTR); }
+double aes_gcm_mbps_once(void) { return aes_mode_once(MODE_GCM); }
@@ -1,53 +1,366 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
 #include "compress_throughput.h"
 #include "timer.h"
 #include "config.h"
+#include "threadpool.h"
+#include "lz_codec.h"
+#include "util.h"
+#include "arena.h"
+#include "suite.h"
 
-double compress_mbps_once(void) {
+// ---------------------------------------------------------------------------
+// Synthetic but realistic corpora (deterministic, generated outside timing)
+// ---------------------------------------------------------------------------
+
+static const char* WORDS[] = {
+    "the", "of", "and", "to", "in", "a", "is", "that", "for", "it", "as", "was", "with", "be",
+    "by", "on", "not", "he", "this", "are", "or", "his", "from", "at", "which", "but", "have",
+    "an", "had", "they", "you", "were", "their", "one", "all", "we", "can", "her", "has", "there",
+    "been", "if", "more", "when", "will", "would", "who", "so", "no", "system", "memory", "data",
+    "process", "between", "through", "performance", "benchmark", "measurement", "throughput",
+    "latency", "processor", "cache", "because", "however", "different", "important", "number",
+    "example", "government", "information", "development", "question", "experience", "network",
+    "analysis", "interest", "problem", "community", "structure", "function", "variable", "result"
+};
+#define NWORDS (sizeof(WORDS) / sizeof(WORDS[0]))
+
+// Zipf-like pick: small indices (common words) dominate
+static size_t zipf_pick(uint64_t* rng, size_t n) {
+    const double u = (double)(splitmix64(rng) >> 11) / 9007199254740992.0;
+    return (size_t)(u * u * u * (double)n);
+}
+
+static size_t append(uint8_t* dst, size_t at, size_t cap, const char* s) {
+    const size_t n = strlen(s);
+    const size_t k = (at + n <= cap) ? n : cap - at;
+    memcpy(dst + at, s, k);
+    return at + k;
+}
+
+static void gen_text(uint8_t* dst, size_t n, uint64_t seed) {
+    size_t at = 0;
+    int word_in_sentence = 0, sentence_len = 8;
+    while (at < n) {
+        const char* w = WORDS[zipf_pick(&seed, NWORDS)];
+        if (word_in_sentence == 0 && at < n) {
+            char cap[32];
+            snprintf(cap, sizeof(cap), "%s", w);
+            cap[0] = (char)(cap[0] - 32 * (cap[0] >= 'a' && cap[0] <= 'z'));
+            at = append(dst, at, n, cap);
+            sentence_len = 6 + (int)(splitmix64(&seed) % 14);
+        }
+        else {
+            at = append(dst, at, n, w);
+        }
+        if (++word_in_sentence >= sentence_len) {
+            at = append(dst, at, n, (splitmix64(&seed) % 5) ? ". " : ".\n");
+            word_in_sentence = 0;
+        }
+        else {
+            at = append(dst, at, n, (splitmix64(&seed) % 11) ? " " : ", ");
+        }
+    }
+}
+
+static void gen_json_logs(uint8_t* dst, size_t n, uint64_t seed) {
+    static const char* LEVEL[] = { "INFO", "INFO", "INFO", "DEBUG", "WARN", "ERROR" };
+    static const char* PATH[] = { "/v1/users", "/v1/orders", "/v1/cart", "/health", "/v2/search", "/v1/login" };
+    static const char* METHOD[] = { "GET", "GET", "POST", "PUT", "DELETE" };
+    static const int STATUS[] = { 200, 200, 200, 201, 204, 301, 400, 404, 500 };
+    uint64_t ts = 1700000000000ull;
+    size_t at = 0;
+    char line[512];
+    while (at < n) {
+        ts += splitmix64(&seed) % 50;
+        const uint64_t r = splitmix64(&seed);
+        snprintf(line, sizeof(line),
+            "{\"ts\":%llu,\"level\":\"%s\",\"svc\":\"api-%u\",\"method\":\"%s\",\"path\":\"%s/%u\","
+            "\"status\":%d,\"latency_ms\":%u,\"req_id\":\"%016llx\",\"bytes\":%u}\n",
+            (unsigned long long)ts, LEVEL[r % 6], (unsigned)((r >> 8) % 12), METHOD[(r >> 16) % 5],
+            PATH[(r >> 20) % 6], (unsigned)((r >> 24) % 100000), STATUS[(r >> 40) % 9],
+            (unsigned)((r >> 44) % 900 + 1), (unsigned long long)splitmix64(&seed),
+            (unsigned)((r >> 32) % 65536));
+        at = append(dst, at, n, line);
+    }
+}
+
+// Record-oriented binary: sequential ids, slowly moving timestamps and
+// floats, low-cardinality flags and an incompressible 8-byte payload
+static void gen_binary(uint8_t* dst, size_t n, uint64_t seed) {
+    uint32_t id = 1, ts = 500000;
+    float value = 20.0f;
+    size_t at = 0;
+    while (at < n) {
+        uint8_t rec[28];
+        const uint64_t r = splitmix64(&seed);
+        ts += (uint32_t)(r % 16);
+        value += (float)((int)(r >> 8) % 7 - 3) * 0.125f;
+        const uint16_t flags = (uint16_t)(1u << ((r >> 16) % 4));
+        const uint64_t payload = splitmix64(&seed);
+        memcpy(rec, &id, 4);
+        memcpy(rec + 4, &ts, 4);
+        memcpy(rec + 8, &value, 4);
+        memcpy(rec + 12, &flags, 2);
+        memset(rec + 14, 0, 6);
+        memcpy(rec + 20, &payload, 8);
+        const size_t k = (n - at < sizeof(rec)) ? n - at : sizeof(rec);
+        memcpy(dst + at, rec, k);
+        at += k;
+        ++id;
+    }
+}
+
+typedef enum { CORPUS_TEXT, CORPUS_JSON, CORPUS_BINARY, CORPUS_MIXED, CORPUS_COUNT } Corpus;
+
+static const char* CORPUS_NAME[CORPUS_COUNT] = { "TEXT", "JSON", "BIN", "MIXED" };
+
+// Corpora are immutable, so one is generated on first use and reused until
+// teardown. Only one is resident at a time (comp_bytes, 256 MiB in EXTREME),
+// so later memory tests size themselves against memory that is really free.
+static uint8_t* corpus_data[CORPUS_COUNT];
+static size_t   corpus_size[CORPUS_COUNT];
+
+static void free_corpora(void) {
+    for (int c = 0; c < CORPUS_COUNT; ++c) {
+        free(corpus_data[c]);
+        corpus_data[c] = NULL;
+        corpus_size[c] = 0;
+    }
+}
+
+static const uint8_t* get_corpus(Corpus c, size_t n) {
+    if (corpus_data[c] && corpus_size[c] == n) return corpus_data[c];
+    free_corpora();
+    corpus_data[c] = (uint8_t*)malloc(n ? n : 1);
+    corpus_size[c] = n;
+    if (!corpus_data[c]) return NULL;
+    switch (c) {
+    case CORPUS_TEXT:   gen_text(corpus_data[c], n, 1); break;
+    case CORPUS_JSON:   gen_json_logs(corpus_data[c], n, 2); break;
+    case CORPUS_BINARY: gen_binary(corpus_data[c], n, 3); break;
+    default:
+        // One third of each kind, concatenated
+        gen_text(corpus_data[c], n / 3, 1);
+        gen_json_logs(corpus_data[c] + n / 3, n / 3, 2);
+        gen_binary(corpus_data[c] + 2 * (n / 3), n - 2 * (n / 3), 3);
+        break;
+    }
+    return corpus_data[c];
+}
+
+// ---------------------------------------------------------------------------
+// Parallel block compression / decompression
+// ---------------------------------------------------------------------------
+
+typedef enum { PHASE_COMPRESS, PHASE_DECOMPRESS, PHASE_BOTH } Phase;
+
+typedef struct {
+    Phase          phase;
+    int            level;
+    const uint8_t* in;
+    Corpus         corpus;     // what `in` holds
+    Corpus         comp_of;    // corpus currently encoded in comp (CORPUS_COUNT = none)
+    size_t         comp_active; // `active` when comp_of was encoded
+    size_t         V;
+    size_t         block;      // raw block size
+    size_t         nblocks;
+    size_t         active;     // blocks each pass processes, spread evenly (suite_work_fraction)
+    uint8_t*       comp;       // one lz_bound(block) slot per block
+    size_t*        comp_len;
+    uint8_t*       out;
+    LzWork*        work[POOL_MAX_THREADS];   // per-thread scratch, built in prepare
+    int            nwork;
+    int            failed;
+} CodecJob;
+
+// i-th of the active blocks: a slice samples the whole corpus, not just its head
+static size_t active_block(const CodecJob* job, size_t i) {
+    return i * job->nblocks / job->active;
+}
+
+static size_t block_len(const CodecJob* job, size_t b) {
+    const size_t off = b * job->block;
+    return (job->V - off < job->block) ? job->V - off : job->block;
+}
+
+static void codec_worker(int tid, int nthreads, void* arg) {
+    CodecJob* job = (CodecJob*)arg;
+    const size_t i0 = job->active * (size_t)tid / (size_t)nthreads;
+    const size_t i1 = job->active * (size_t)(tid + 1) / (size_t)nthreads;
+    const size_t slot = lz_bound(job->block);
+    LzWork* w = (tid < job->nwork) ? job->work[tid] : NULL;
+    if (!w) job->failed = 1;
+
+    double raw = 0.0;
+    pool_timed_begin(tid);
+    for (size_t i = i0; w && i < i1; ++i) {
+        const size_t b = active_block(job, i);
+        const size_t off = b * job->block;
+        const size_t n = block_len(job, b);
+        if (job->phase != PHASE_DECOMPRESS) {
+            job->comp_len[b] = lz_compress_block(w, job->level, job->in + off, n, job->comp + b * slot, slot);
+            raw += (double)n;
+        }
+        if (job->phase != PHASE_COMPRESS) {
+            size_t used = 0;
+            const size_t got = lz_decompress_block(w, job->comp + b * slot, job->comp_len[b], &used,
+                job->out + off, n);
+            if (got != n) job->failed = 1;
+            raw += (double)n;
+        }
+    }
+    pool_timed_end(tid, raw / (1024.0 * 1024.0));
+}
+
+// Buffers (arena) and per-thread codec state survive across repetitions
+// and across the corpus tests, which all share the same sizes
+static CodecJob prepared;
+static unsigned prepared_gen;
+
+void compress_teardown(void) {
+    for (int t = 0; t < prepared.nwork; ++t) lz_work_destroy(prepared.work[t]);
+    prepared.nwork = 0;
+    prepared_gen = 0;
+    free_corpora();
+}
+
+int compress_prepare(void) {
     const BenchConfig* cfg = bench_config_defaults();
-    const size_t V = cfg->comp_bytes;          // total input bytes
+    const size_t V = cfg->comp_bytes;
+    const size_t block = cfg->comp_block_bytes ? cfg->comp_block_bytes : (256u << 10);
+    const int team = pool_team();
+    if (prepared_gen == arena_generation() && prepared.V == V && prepared.block == block &&
+        prepared.nwork >= team) {
+        if (prepared.level != cfg->comp_level) prepared.comp_of = CORPUS_COUNT;
+        prepared.level = cfg->comp_level;
+        return 1;
+    }
 
-    uint8_t* in = (uint8_t*)malloc(V);
-    const size_t TMP_CAP = V ? (2 * V) : 2;    // worst case: 2 bytes per input byte
-    uint8_t* tmp = (uint8_t*)malloc(TMP_CAP);
-    uint8_t* out = (uint8_t*)malloc(V);        // decompressed size <= V for this toy RLE
-    if (!in || !tmp || !out) { free(in); free(tmp); free(out); return 0.0; }
+    compress_teardown();
+    CodecJob* job = &prepared;
+    memset(job, 0, sizeof(*job));
+    job->V = V;
+    job->level = cfg->comp_level;
+    job->block = block;
+    job->nblocks = (V + block - 1) / block;
+    job->comp_of = CORPUS_COUNT;
+    job->comp = (uint8_t*)arena_alloc(job->nblocks * lz_bound(block) + 1);
+    job->comp_len = (size_t*)arena_alloc((job->nblocks + 1) * sizeof(size_t));
+    job->out = (uint8_t*)arena_alloc(V ? V : 1);
+    if (!job->comp || !job->comp_len || !job->out) return 0;
+    for (int t = 0; t < team; ++t) {
+        job->work[t] = lz_work_create(block);
+        if (!job->work[t]) return 0;
+        job->nwork = t + 1;
+    }
+    prepared_gen = arena_generation();
+    return 1;
+}
 
-    // init (not timed)
-    for (size_t i = 0; i < V; ++i) in[i] = (uint8_t)((i * 7u) ^ (i >> 3));
+static CodecJob* codec_job(Corpus c, Phase phase) {
+    if (!compress_prepare()) return NULL;
+    prepared.corpus = c;
+    prepared.in = get_corpus(c, prepared.V);
+    if (!prepared.in) return NULL;
+    prepared.phase = phase;
+    prepared.failed = 0;
 
-    timer_start();
+    // A time-boxed sample may ask for a slice of the blocks; every thread keeps one
+    const size_t team = (size_t)pool_team();
+    size_t active = (size_t)((double)prepared.nblocks * suite_work_fraction() + 0.999);
+    if (active < team) active = team;
+    if (active > prepared.nblocks || active < 1) active = prepared.nblocks;
+    prepared.active = active;
+    return &prepared;
+}
 
-    // "compress": scan & encode short runs (toy placeholder)
-    size_t w = 0;
-    for (size_t i = 0; i < V; ) {
-        uint8_t b = in[i];
-        size_t run = 1;
-        while (i + run < V && in[i + run] == b && run < 255) run++;
-        if (w + 2 > TMP_CAP) break;        // safety guard (shouldnt trigger with 2*V)
-        tmp[w++] = b;
-        tmp[w++] = (uint8_t)run;
-        i += run;
+// Round trip must reproduce the corpus, otherwise the figure is meaningless
+static int codec_verified(const CodecJob* job) {
+    int same = !job->failed;
+    for (size_t i = 0; same && i < job->active; ++i) {
+        const size_t off = active_block(job, i) * job->block;
+        same = memcmp(job->in + off, job->out + off, block_len(job, active_block(job, i))) == 0;
+    }
+    if (!same) {
+        fprintf(stderr, "[CMP] round-trip mismatch, result discarded\n");
+        return 0;
     }
+    return 1;
+}
+
+static double codec_ratio(const CodecJob* job) {
+    double raw = 0.0, comp = 0.0;
+    for (size_t i = 0; i < job->active; ++i) {
+        const size_t b = active_block(job, i);
+        raw += (double)block_len(job, b);
+        comp += (double)job->comp_len[b];
+    }
+    return (comp > 0.0) ? raw / comp : 0.0;
+}
+
+// comp now holds the active blocks of corpus c (or nothing, on failure)
+static void mark_encoded(CodecJob* job, Corpus c) {
+    job->comp_of = job->failed ? CORPUS_COUNT : c;
+    job->comp_active = job->active;
+}
+
+static double compress_corpus_once(Corpus c) {
+    CodecJob* job = codec_job(c, PHASE_COMPRESS);
+    if (!job) return 0.0;
+    pool_run(codec_worker, job);
+    mark_encoded(job, c);
+    return job->failed ? 0.0 : pool_last_stats(NULL);
+}
+
+static double decompress_corpus_once(Corpus c) {
+    CodecJob* job = codec_job(c, PHASE_COMPRESS);
+    if (!job) return 0.0;
 
-    // "decompress": expand back
-    size_t r = 0;
-    for (size_t i = 0; i + 1 < w; i += 2) {
-        uint8_t b = tmp[i];
-        size_t cnt = (size_t)tmp[i + 1];
-        if (r + cnt > V) cnt = V - r;      // clamp to out buffer
-        memset(out + r, b, cnt);
-        r += cnt;
-        if (r >= V) break;
+    // Encode once (untimed) when comp holds another corpus, then time decompression alone
+    if (job->comp_of != c || job->comp_active != job->active) {
+        pool_run(codec_worker, job);
+        mark_encoded(job, c);
+        if (job->failed) return 0.0;
     }
+    job->phase = PHASE_DECOMPRESS;
+    pool_run(codec_worker, job);
+    const double mbps = pool_last_stats(NULL);
+    return codec_verified(job) ? mbps : 0.0;
+}
 
-    double dt = timer_elapsed_seconds();
+double compress_mbps_once(void) {
+    CodecJob* job = codec_job(CORPUS_MIXED, PHASE_BOTH);
+    if (!job) return 0.0;
 
-    volatile uint8_t sink = out[r ? (r - 1) : 0]; (void)sink; // keep side effects
-    free(in); free(tmp); free(out);
+    // Compress + decompress timed together, as the graded CMP row always was
+    pool_run(codec_worker, job);
+    mark_encoded(job, CORPUS_MIXED);
+    const double mbps = pool_last_stats(NULL);
+    return codec_verified(job) ? mbps : 0.0;
+}
+
+double compress_text_mbps_once(void)    { return compress_corpus_once(CORPUS_TEXT); }
+double compress_json_mbps_once(void)    { return compress_corpus_once(CORPUS_JSON); }
+double compress_binary_mbps_once(void)  { return compress_corpus_once(CORPUS_BINARY); }
+double decompress_text_mbps_once(void)  { return decompress_corpus_once(CORPUS_TEXT); }
+double decompress_json_mbps_once(void)  { return decompress_corpus_once(CORPUS_JSON); }
+double decompress_binary_mbps_once(void) { return decompress_corpus_once(CORPUS_BINARY); }
 
-    const double bytes = (double)V + (double)r;   // compress + decompress
-    return (bytes / dt) / (1024.0 * 1024.0);      // MB/s
+int compress_ratio_sweep(SweepPoint* out, int cap) {
+    int count = 0;
+    for (int c = 0; c < CORPUS_COUNT && count < cap; ++c) {
+        CodecJob* job = codec_job((Corpus)c, PHASE_COMPRESS);
+        if (!job) break;
+        pool_run(codec_worker, job);
+        mark_encoded(job, (Corpus)c);
+        SweepPoint* pt = &out[count++];
+        snprintf(pt->label, sizeof(pt->label), "%s", CORPUS_NAME[c]);
+        pt->x = (double)c;
+        pt->value = job->failed ? 0.0 : codec_ratio(job);
+    }
+    compress_teardown();
+    return count;
 }
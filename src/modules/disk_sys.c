@@ -1,50 +1,501 @@
+#if !defined(_WIN32)
+#define _GNU_SOURCE   // O_DIRECT
+#endif
 #include "disk_sys.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include "timer.h"
 #include "config.h"
+#include "util.h"
+#include "pagemem.h"
+#include "threadpool.h"
+#include "aio_ring.h"
 
-double disk_benchmark_mbps_once(void) {
+#define SEQ_CHUNK   (1024u * 1024u)   // sequential transfer size
+#define RAND_BLOCK  4096u             // random transfer size (and O_DIRECT alignment)
+#define RAND_OPS    16384u            // random I/Os per pass, split across the queue
+#define RAND_SECONDS  2.0             // ...or until this much time has passed
+#define SWEEP_OPS   65536u            // per queue-depth point of the sweep
+#define SWEEP_SECONDS 1.0
+#define FILE_NAME   "scs_bench_temp.dat"
+
+// ---------------------------------------------------------------------------
+// Minimal positional, cache-bypassing file layer
+// ---------------------------------------------------------------------------
+
+// WINDOWS IMPLEMENTATION
+#if defined(_WIN32)
+#include <windows.h>
+
+typedef HANDLE DiskFile;
+#define DISK_BAD INVALID_HANDLE_VALUE
+
+// NO_BUFFERING bypasses the cache manager; WRITE_THROUGH keeps the device cache honest
+static DiskFile disk_open(const char* path, int create, int direct, int* got_direct) {
+    const DWORD flags = direct ? (FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH) : FILE_ATTRIBUTE_NORMAL;
+    HANDLE h = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+        create ? CREATE_ALWAYS : OPEN_EXISTING, flags, NULL);
+    *got_direct = (h != INVALID_HANDLE_VALUE) && direct;
+    return h;
+}
+
+static int disk_pio(DiskFile f, void* buf, size_t n, uint64_t off, int write) {
+    OVERLAPPED ov;
+    DWORD done = 0;
+    memset(&ov, 0, sizeof(ov));
+    ov.Offset = (DWORD)off;
+    ov.OffsetHigh = (DWORD)(off >> 32);
+    const BOOL ok = write ? WriteFile(f, buf, (DWORD)n, &done, &ov) : ReadFile(f, buf, (DWORD)n, &done, &ov);
+    return ok && done == (DWORD)n;
+}
+
+static int  disk_sync(DiskFile f) { return FlushFileBuffers(f) != 0; }
+static void disk_drop_cache(DiskFile f) { (void)f; }   // unbuffered handles never populate it
+static void disk_close(DiskFile f) { CloseHandle(f); }
+
+// LINUX & MACOS IMPLEMENTATION
+#else
+#include <fcntl.h>
+#include <unistd.h>
+
+typedef int DiskFile;
+#define DISK_BAD (-1)
+
+static DiskFile disk_open(const char* path, int create, int direct, int* got_direct) {
+    const int mode = O_RDWR | (create ? (O_CREAT | O_TRUNC) : 0);
+    int fd = -1;
+    *got_direct = 0;
+#ifdef O_DIRECT
+    // tmpfs and some network filesystems reject O_DIRECT; fall back to fadvise below
+    if (direct) {
+        fd = open(path, mode | O_DIRECT, 0644);
+        if (fd >= 0) *got_direct = 1;
+    }
+#endif
+    if (fd < 0) fd = open(path, mode, 0644);
+#ifdef F_NOCACHE
+    if (fd >= 0 && direct && fcntl(fd, F_NOCACHE, 1) == 0) *got_direct = 1;
+#endif
+    return fd;
+}
+
+static int disk_pio(DiskFile f, void* buf, size_t n, uint64_t off, int write) {
+    const ssize_t r = write ? pwrite(f, buf, n, (off_t)off) : pread(f, buf, n, (off_t)off);
+    return r == (ssize_t)n;
+}
+
+static int disk_sync(DiskFile f) { return fsync(f) == 0; }
+
+// Buffered fallback: written pages must be clean (synced) before they can be dropped
+static void disk_drop_cache(DiskFile f) {
+#ifdef POSIX_FADV_DONTNEED
+    (void)fsync(f);
+    (void)posix_fadvise(f, 0, 0, POSIX_FADV_DONTNEED);
+#else
+    (void)f;
+#endif
+}
+
+static void disk_close(DiskFile f) { close(f); }
+#endif
+
+// ---------------------------------------------------------------------------
+// Test file shared by the read and random-write passes
+// ---------------------------------------------------------------------------
+
+static char   file_path[512];
+static size_t file_bytes;       // size of the prepared file, 0 = none yet
+static int    reported;
+
+static void disk_path(char* out, size_t n) {
     const BenchConfig* cfg = bench_config_defaults();
-    const size_t FILE_SIZE = cfg->disk_bytes;
-    const size_t CHUNK_SIZE = 4096; // 4KB blocks
-    const char* filename = "scs_bench_temp.dat";
+    const char* dir = cfg->disk_dir[0] ? cfg->disk_dir : ".";
+    const size_t len = strlen(dir);
+    const int slash = (dir[len - 1] == '/' || dir[len - 1] == '\\');
+    snprintf(out, n, "%s%s%s", dir, slash ? "" : "/", FILE_NAME);
+}
 
-    char* buffer = (char*)malloc(CHUNK_SIZE);
-    if (!buffer) return 0.0;
+static void remove_file(void) {
+    if (file_bytes) remove(file_path);
+    file_bytes = 0;
+}
 
-    // Write
-    FILE* f = fopen(filename, "wb");
-    if (!f) { free(buffer); return 0.0; }
+// Rounds the configured size down to whole sequential chunks (min one chunk)
+static size_t disk_size(void) {
+    const size_t n = bench_config_defaults()->disk_bytes / SEQ_CHUNK * SEQ_CHUNK;
+    return n ? n : SEQ_CHUNK;
+}
 
+// Fills an aligned buffer with incompressible data, so compressing or
+// deduplicating storage cannot short-cut the transfer
+static void fill_random(uint8_t* buf, size_t n, uint64_t seed) {
+    for (size_t i = 0; i + 8 <= n; i += 8) {
+        const uint64_t v = splitmix64(&seed);
+        memcpy(buf + i, &v, 8);
+    }
+}
+
+// Sequential write of the whole file; returns seconds including the final fsync
+static double write_file(const char* path, size_t bytes, int* got_direct) {
+    const BenchConfig* cfg = bench_config_defaults();
+    uint8_t* buf = (uint8_t*)page_alloc(SEQ_CHUNK, PAGE_SMALL, NULL);
+    if (!buf) return 0.0;
+    fill_random(buf, SEQ_CHUNK, 0x5EED);
+
+    DiskFile f = disk_open(path, 1, cfg->disk_direct, got_direct);
+    if (f == DISK_BAD) { page_free(buf, SEQ_CHUNK); return 0.0; }
+
+    int ok = 1;
     timer_start();
-    for (size_t i = 0; i < FILE_SIZE; i += CHUNK_SIZE) {
-        fwrite(buffer, 1, CHUNK_SIZE, f);
+    for (size_t off = 0; ok && off < bytes; off += SEQ_CHUNK) {
+        buf[0] = (uint8_t)(off >> 20);   // no two chunks identical
+        ok = disk_pio(f, buf, SEQ_CHUNK, off, 1);
+    }
+    ok = ok && disk_sync(f);
+    const double t = timer_elapsed_seconds();
+
+    if (!*got_direct) disk_drop_cache(f);
+    disk_close(f);
+    page_free(buf, SEQ_CHUNK);
+    return ok ? t : 0.0;
+}
+
+// Makes sure a file of the configured size exists for the read/random passes
+static int prepare_file(void) {
+    const size_t bytes = disk_size();
+    char path[512];
+    disk_path(path, sizeof(path));
+    if (file_bytes == bytes && strcmp(path, file_path) == 0) return 1;
+
+    remove_file();
+    int direct = 0;
+    if (write_file(path, bytes, &direct) <= 0.0) { remove(path); return 0; }
+    snprintf(file_path, sizeof(file_path), "%s", path);
+    file_bytes = bytes;
+
+    if (!reported) {
+        printf("[DSK] %s, %s I/O\n", file_path,
+            direct ? "direct (cache bypass)" : "buffered + cache drop");
+        atexit(remove_file);
+        reported = 1;
     }
-    double t_write = timer_elapsed_seconds();
-    fclose(f);
+    return 1;
+}
 
-    // Read
-    f = fopen(filename, "rb");
-    if (!f) { free(buffer); return 0.0; }
+// ---------------------------------------------------------------------------
+// Passes
+// ---------------------------------------------------------------------------
 
+static double seq_write_seconds(size_t* bytes) {
+    char path[512];
+    int direct = 0;
+    *bytes = disk_size();
+    // The prepared file is rewritten in place, which is exactly a sequential write
+    if (!prepare_file()) return 0.0;
+    snprintf(path, sizeof(path), "%s", file_path);
+    return write_file(path, *bytes, &direct);
+}
+
+static double seq_read_seconds(size_t* bytes) {
+    const BenchConfig* cfg = bench_config_defaults();
+    *bytes = 0;
+    if (!prepare_file()) return 0.0;
+
+    uint8_t* buf = (uint8_t*)page_alloc(SEQ_CHUNK, PAGE_SMALL, NULL);
+    if (!buf) return 0.0;
+    int direct = 0;
+    DiskFile f = disk_open(file_path, 0, cfg->disk_direct, &direct);
+    if (f == DISK_BAD) { page_free(buf, SEQ_CHUNK); return 0.0; }
+    if (!direct) disk_drop_cache(f);
+
+    int ok = 1;
     timer_start();
-    while (fread(buffer, 1, CHUNK_SIZE, f) == CHUNK_SIZE) {
-        // consume data
+    for (size_t off = 0; ok && off < file_bytes; off += SEQ_CHUNK) {
+        ok = disk_pio(f, buf, SEQ_CHUNK, off, 0);
     }
-    double t_read = timer_elapsed_seconds();
-    fclose(f);
+    const double t = timer_elapsed_seconds();
+
+    volatile uint8_t sink = buf[0]; (void)sink;
+    disk_close(f);
+    page_free(buf, SEQ_CHUNK);
+    *bytes = file_bytes;
+    return ok ? t : 0.0;
+}
+
+// ---------------------------------------------------------------------------
+// Random 4 KiB I/O at a fixed queue depth
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    double iops;
+    double mbps;
+    double p50, p99, p999;      // completion latency, microseconds
+    int    threads;             // submitter threads the requests were spread over
+} QdResult;
+
+typedef struct {
+    DiskFile f;
+    size_t   blocks;            // 4 KiB blocks in the file
+    size_t   ops;               // I/O budget across all submitters
+    int      write;
+    int      depth;             // requests each submitter keeps in flight
+    int      async;             // 1 = one aio ring per submitter, 0 = one sync stream per thread
+    double   time_cap;          // seconds; slow devices end the pass early
+    double*  lat;               // per-I/O completion latency (s), ops slots
+    size_t   lat_n[POOL_MAX_THREADS];
+    int      failed;
+} QdJob;
+
+static int async_state = -1;    // -1 = not probed yet, 0 = threads, 1 = aio ring
 
-    // Cleanup
-    remove(filename);
-    free(buffer);
+static AioRing* disk_ring(DiskFile f, unsigned depth) {
+#if defined(_WIN32)
+    (void)f; (void)depth;
+    return NULL;
+#else
+    return aio_ring_create(f, depth);
+#endif
+}
 
-    // Calculate Combined Throughput (Total Bytes / Total Time)
-    // We processed FILE_SIZE twice (Write + Read)
-    double total_bytes = (double)FILE_SIZE * 2.0;
-    double total_time = t_write + t_read;
+static void qd_worker(int tid, int nthreads, void* arg) {
+    QdJob* job = (QdJob*)arg;
+    const size_t begin = job->ops * (size_t)tid / (size_t)nthreads;
+    const size_t quota = job->ops * (size_t)(tid + 1) / (size_t)nthreads - begin;
+    const int depth = job->async ? job->depth : 1;
+    double* lat = job->lat + begin;
+    uint64_t rng = 0x9E3779B97F4A7C15ull * (uint64_t)(tid + 1);
 
-    if (total_time <= 0.0) return 0.0;
+    uint8_t* bufs = (uint8_t*)page_alloc((size_t)depth * RAND_BLOCK, PAGE_SMALL, NULL);
+    double* t_sub = (double*)malloc((size_t)depth * sizeof(double));
+    AioCompletion* cq = (AioCompletion*)malloc((size_t)depth * sizeof(AioCompletion));
+    AioRing* ring = job->async ? disk_ring(job->f, (unsigned)depth) : NULL;
+    int ok = bufs && t_sub && cq && (ring || !job->async);
+    if (bufs) fill_random(bufs, (size_t)depth * RAND_BLOCK, rng);
 
-    return (total_bytes / total_time) / (1024.0 * 1024.0); // MB/s
-}
\ No newline at end of file
+    size_t issued = 0, done = 0;
+    pool_timed_begin(tid);
+    const double deadline = timer_now_seconds() + job->time_cap;
+    if (ok && ring) {
+        // Slot index is the tag: a completed slot is immediately refilled
+        for (int s = 0; s < depth && issued < quota; ++s, ++issued) {
+            t_sub[s] = timer_now_seconds();
+            aio_ring_queue(ring, job->write, bufs + (size_t)s * RAND_BLOCK, RAND_BLOCK,
+                (splitmix64(&rng) % job->blocks) * RAND_BLOCK, (uint64_t)s);
+        }
+        while (ok && done < issued) {
+            const int n = aio_ring_reap(ring, cq, depth, 1);
+            if (n < 0) { ok = 0; break; }
+            const double now = timer_now_seconds();
+            for (int i = 0; i < n; ++i) {
+                const int s = (int)cq[i].tag;
+                if (cq[i].result != (long)RAND_BLOCK) ok = 0;
+                lat[done++] = now - t_sub[s];
+                if (ok && issued < quota && now < deadline) {
+                    t_sub[s] = now;
+                    aio_ring_queue(ring, job->write, bufs + (size_t)s * RAND_BLOCK, RAND_BLOCK,
+                        (splitmix64(&rng) % job->blocks) * RAND_BLOCK, (uint64_t)s);
+                    ++issued;
+                }
+            }
+        }
+    }
+    else if (ok) {
+        while (ok && done < quota) {
+            const double t0 = timer_now_seconds();
+            ok = disk_pio(job->f, bufs, RAND_BLOCK, (splitmix64(&rng) % job->blocks) * RAND_BLOCK, job->write);
+            const double t1 = timer_now_seconds();
+            lat[done++] = t1 - t0;
+            if (t1 >= deadline) break;
+        }
+    }
+    // Writes are only done once they are durable, so the flush is part of the pass
+    if (job->write) {
+        pool_sync();
+        if (tid == 0) ok = disk_sync(job->f) && ok;
+    }
+    pool_timed_end(tid, (double)done);
+
+    job->lat_n[tid] = done;
+    if (!ok) job->failed = 1;
+    aio_ring_destroy(ring);
+    free(cq);
+    free(t_sub);
+    if (bufs) page_free(bufs, (size_t)depth * RAND_BLOCK);
+}
+
+static int cmp_double(const void* a, const void* b) {
+    const double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of a sorted sample, in microseconds
+static double percentile_us(const double* v, size_t n, double p) {
+    if (n == 0) return 0.0;
+    size_t k = (size_t)(p * (double)n + 0.999999);
+    if (k < 1) k = 1;
+    if (k > n) k = n;
+    return v[k - 1] * 1e6;
+}
+
+// One pass of random 4 KiB I/O with `qd` requests in flight in total
+static int qd_run(int write, int qd, size_t max_ops, double time_cap, QdResult* res) {
+    const BenchConfig* cfg = bench_config_defaults();
+    memset(res, 0, sizeof(*res));
+    if (!prepare_file()) return 0;
+
+    QdJob job;
+    int direct = 0;
+    memset(&job, 0, sizeof(job));
+    job.f = disk_open(file_path, 0, cfg->disk_direct, &direct);
+    if (job.f == DISK_BAD) return 0;
+    if (!direct) disk_drop_cache(job.f);
+
+    if (async_state < 0) {
+        AioRing* probe = disk_ring(job.f, 1);
+        async_state = (probe != NULL);
+        printf("[DSK] queue engine: %s\n", aio_ring_engine(probe));
+        aio_ring_destroy(probe);
+    }
+
+    // Submitters share the queue; without an aio ring every in-flight request is a thread
+    int jobs = cfg->disk_jobs < 1 ? 1 : cfg->disk_jobs;
+    if (qd < 1) qd = 1;
+    if (jobs > qd) jobs = qd;
+    job.async = async_state;
+    job.depth = (qd + jobs - 1) / jobs;
+    job.blocks = file_bytes / RAND_BLOCK;
+    job.ops = (job.blocks < max_ops) ? job.blocks : max_ops;
+    job.write = write;
+    job.time_cap = time_cap;
+    job.lat = (double*)malloc(job.ops * sizeof(double));
+    if (!job.lat) { disk_close(job.f); return 0; }
+
+    // Queue depth is a property of this test, not of the suite's thread setting
+    const int team = pool_team();
+    pool_set_team(job.async ? jobs : qd);
+    pool_run(qd_worker, &job);
+    const int used = pool_team();
+    pool_set_team(team);
+    res->threads = used;
+    res->iops = pool_last_stats(NULL);
+    res->mbps = res->iops * (double)RAND_BLOCK / (1024.0 * 1024.0);
+
+    // Each thread filled the front of its own slice; compact, then rank
+    size_t n = 0;
+    for (int t = 0; t < used; ++t) {
+        const size_t begin = job.ops * (size_t)t / (size_t)used;
+        memmove(job.lat + n, job.lat + begin, job.lat_n[t] * sizeof(double));
+        n += job.lat_n[t];
+    }
+    qsort(job.lat, n, sizeof(double), cmp_double);
+    res->p50 = percentile_us(job.lat, n, 0.50);
+    res->p99 = percentile_us(job.lat, n, 0.99);
+    res->p999 = percentile_us(job.lat, n, 0.999);
+
+    free(job.lat);
+    if (write && !direct) disk_drop_cache(job.f);
+    disk_close(job.f);
+    return !job.failed;
+}
+
+static double rand_iops_once(int write) {
+    QdResult r;
+    const int ok = qd_run(write, bench_config_defaults()->disk_queue_depth, RAND_OPS, RAND_SECONDS, &r);
+    return ok ? r.iops : 0.0;
+}
+
+// Queue-depth sweep: measured once, reported as IOPS, MB/s and latency rows
+#define QD_MAX_POINTS 16
+
+static QdResult qd_points[QD_MAX_POINTS];
+static int      qd_depths[QD_MAX_POINTS];
+static int      qd_count = -1;
+
+static void qd_sweep_run(void) {
+    const int max_qd = bench_config_defaults()->disk_sweep_max_qd;
+    qd_count = 0;
+    for (int qd = 1; qd <= max_qd && qd_count < QD_MAX_POINTS; qd *= 2) {
+        QdResult r;
+        if (!qd_run(0, qd, SWEEP_OPS, SWEEP_SECONDS, &r)) break;
+        qd_depths[qd_count] = qd;
+        qd_points[qd_count++] = r;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Public entry points
+// ---------------------------------------------------------------------------
+
+// The test file is written once and shared by every disk row; it is removed at exit
+int disk_prepare(void) { return prepare_file(); }
+
+static double mbps(size_t bytes, double t) {
+    return (t > 0.0) ? ((double)bytes / t) / (1024.0 * 1024.0) : 0.0;
+}
+
+double disk_seq_write_mbps_once(void) {
+    size_t bytes = 0;
+    const double t = seq_write_seconds(&bytes);
+    return mbps(bytes, t);
+}
+
+double disk_seq_read_mbps_once(void) {
+    size_t bytes = 0;
+    const double t = seq_read_seconds(&bytes);
+    return mbps(bytes, t);
+}
+
+double disk_rand_read_iops_once(void)  { return rand_iops_once(0); }
+double disk_rand_write_iops_once(void) { return rand_iops_once(1); }
+
+double disk_benchmark_mbps_once(void) {
+    size_t wbytes = 0, rbytes = 0;
+    const double t_write = seq_write_seconds(&wbytes);
+    const double t_read = seq_read_seconds(&rbytes);
+    if (t_write <= 0.0 || t_read <= 0.0) return 0.0;
+
+    // Combined throughput: both passes over the file / total time
+    return mbps(wbytes + rbytes, t_write + t_read);
+}
+
+int disk_qd_iops_sweep(SweepPoint* out, int cap) {
+    qd_sweep_run();
+    int n = 0;
+    for (int i = 0; i < qd_count && n < cap; ++i, ++n) {
+        snprintf(out[n].label, sizeof(out[n].label), "QD%d", qd_depths[i]);
+        out[n].x = (double)qd_depths[i];
+        out[n].value = qd_points[i].iops;
+        out[n].threads = qd_points[i].threads;
+    }
+    return n;
+}
+
+int disk_qd_mbps_sweep(SweepPoint* out, int cap) {
+    if (qd_count < 0) qd_sweep_run();
+    int n = 0;
+    for (int i = 0; i < qd_count && n < cap; ++i, ++n) {
+        snprintf(out[n].label, sizeof(out[n].label), "QD%d", qd_depths[i]);
+        out[n].x = (double)qd_depths[i];
+        out[n].value = qd_points[i].mbps;
+        out[n].threads = qd_points[i].threads;
+    }
+    return n;
+}
+
+int disk_qd_latency_sweep(SweepPoint* out, int cap) {
+    if (qd_count < 0) qd_sweep_run();
+    int n = 0;
+    for (int i = 0; i < qd_count && n + 3 <= cap; ++i) {
+        const double v[3] = { qd_points[i].p50, qd_points[i].p99, qd_points[i].p999 };
+        static const char* P[3] = { "p50", "p99", "p99.9" };
+        for (int k = 0; k < 3; ++k, ++n) {
+            snprintf(out[n].label, sizeof(out[n].label), "QD%d_%s", qd_depths[i], P[k]);
+            out[n].x = (double)qd_depths[i];
+            out[n].value = v[k];
+            out[n].threads = qd_points[i].threads;
+        }
+    }
+    return n;
+}
@@ -1,35 +1,153 @@
-#include <stdlib.h>
+#include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include "timer.h"
 #include "config.h"
+#include "threadpool.h"
+#include "arena.h"
+#include "float_simd.h"
+#include "float_dot.h"
 
-double float_mflops_once(void) {
+typedef enum { K_DOT32, K_DOT64, K_FMA32, K_FMA64, K_COUNT } FloatKernel;
+
+static const char* const kernel_names[K_COUNT] = { "DOT32", "DOT64", "FMA32", "FMA64" };
+
+// FMA rounds per element of float_N; keeps the peak kernels near the dot's duration
+#define FMA_ROUNDS_PER_ELEM 4
+
+typedef struct {
+    FloatKernel   kind;
+    SimdIsa       isa;
+    const float*  a32;
+    const float*  b32;
+    const double* a64;
+    const double* b64;
+    size_t        N;
+    size_t        rounds;   // FMA rounds for the whole team
+} FloatJob;
+
+static void float_worker(int tid, int nthreads, void* arg) {
+    const FloatJob* job = (const FloatJob*)arg;
+    const size_t total = (job->kind == K_FMA32 || job->kind == K_FMA64) ? job->rounds : job->N;
+    const size_t begin = total * (size_t)tid / (size_t)nthreads;
+    const size_t end = total * (size_t)(tid + 1) / (size_t)nthreads;
+    const size_t n = end - begin;
+
+    // Time only the math loop
+    double sum = 0.0, flops = 0.0;
+    pool_timed_begin(tid);
+    switch (job->kind) {
+    case K_DOT32:
+        sum = simd_dot_f32(job->isa, job->a32 + begin, job->b32 + begin, n);
+        flops = 2.0 * (double)n;   // mul + add per element
+        break;
+    case K_DOT64:
+        sum = simd_dot_f64(job->isa, job->a64 + begin, job->b64 + begin, n);
+        flops = 2.0 * (double)n;
+        break;
+    case K_FMA32:
+        sum = simd_fma_f32(job->isa, n);
+        flops = simd_fma_flops_per_iter(job->isa, 0) * (double)n;
+        break;
+    case K_FMA64:
+        sum = simd_fma_f64(job->isa, n);
+        flops = simd_fma_flops_per_iter(job->isa, 1) * (double)n;
+        break;
+    default:
+        break;
+    }
+    pool_timed_end(tid, flops / 1e6);
+
+    // Prevent optimization
+    volatile double sink = sum; (void)sink;
+}
+
+// Inputs live in the arena and survive across repetitions
+static FloatJob prepared;
+static unsigned prepared_gen;
+
+int float_prepare(void) {
     const BenchConfig* cfg = bench_config_defaults();
     const size_t N = cfg->float_N;
+    prepared.isa = simd_configured_isa();
+    prepared.rounds = N * FMA_ROUNDS_PER_ELEM;
+    if (prepared_gen == arena_generation() && prepared.N == N) return 1;
 
-    float* a = (float*)malloc(N * sizeof(float));
-    float* b = (float*)malloc(N * sizeof(float));
-    if (!a || !b) { free(a); free(b); return 0.0; }
+    float* a32 = (float*)arena_alloc(N * sizeof(float));
+    float* b32 = (float*)arena_alloc(N * sizeof(float));
+    double* a64 = (double*)arena_alloc(N * sizeof(double));
+    double* b64 = (double*)arena_alloc(N * sizeof(double));
+    if (!a32 || !b32 || !a64 || !b64) return 0;
 
     // Deterministic init (kept outside timing)
     for (size_t i = 0; i < N; ++i) {
-        a[i] = (float)((i % 97) * 0.01);
-        b[i] = (float)(((i * 3) % 89) * 0.01);
+        a32[i] = (float)((i % 97) * 0.01);
+        b32[i] = (float)(((i * 3) % 89) * 0.01);
+        a64[i] = (double)a32[i];
+        b64[i] = (double)b32[i];
     }
 
-    // Time only the math loop
-    volatile double sum = 0.0;
-    timer_start();
-    for (size_t i = 0; i < N; ++i) {
-        sum += (double)a[i] * (double)b[i];  // 2 FLOPs per element (mul + add)
+    // Report the dispatch decision once per process
+    static int announced;
+    if (!announced) {
+        char avail[64] = "";
+        for (int i = 0; i < SIMD_ISA_COUNT; ++i) {
+            if (!simd_isa_available((SimdIsa)i)) continue;
+            if (avail[0]) strncat(avail, " ", sizeof(avail) - strlen(avail) - 1);
+            strncat(avail, simd_isa_name((SimdIsa)i), sizeof(avail) - strlen(avail) - 1);
+        }
+        printf("[FP] SIMD dispatch: %s (available: %s)\n", simd_isa_name(prepared.isa), avail);
+        announced = 1;
     }
-    double dt = timer_elapsed_seconds();
 
-    // Prevent optimization
-    (void)sum;
+    prepared.a32 = a32;
+    prepared.b32 = b32;
+    prepared.a64 = a64;
+    prepared.b64 = b64;
+    prepared.N = N;
+    prepared_gen = arena_generation();
+    return 1;
+}
+
+void float_teardown(void) { prepared_gen = 0; }
 
-    free(a); free(b);
+static double float_once(FloatKernel kind) {
+    if (!float_prepare()) return 0.0;
+    prepared.kind = kind;
+    pool_run(float_worker, &prepared);
+    return pool_last_stats(NULL);   // MFLOPS
+}
+
+double float_mflops_once(void)       { return float_once(K_DOT32); }
+double float_dot64_mflops_once(void) { return float_once(K_DOT64); }
+double float_fma32_mflops_once(void) { return float_once(K_FMA32); }
+double float_fma64_mflops_once(void) { return float_once(K_FMA64); }
+
+int float_isa_sweep(SweepPoint* out, int cap) {
+    int count = 0;
+    if (!float_prepare()) return 0;
+    const int saved_team = pool_team();
+    const SimdIsa saved_isa = prepared.isa;
+
+    // One thread, every kernel on every ISA this CPU supports
+    pool_set_team(1);
+    for (int i = 0; i < SIMD_ISA_COUNT; ++i) {
+        if (!simd_isa_available((SimdIsa)i)) continue;
+        prepared.isa = (SimdIsa)i;
+        for (int k = 0; k < K_COUNT && count < cap; ++k) {
+            prepared.kind = (FloatKernel)k;
+            pool_run(float_worker, &prepared);   // warm-up
+            pool_run(float_worker, &prepared);
+
+            SweepPoint* pt = &out[count++];
+            snprintf(pt->label, sizeof(pt->label), "%s_%s", simd_isa_name((SimdIsa)i), kernel_names[k]);
+            pt->x = (double)(i * K_COUNT + k);
+            pt->value = pool_last_stats(NULL);
+            pt->threads = 1;
+        }
+    }
 
-    const double flops = 2.0 * (double)N;
-    return (flops / dt) / 1e6;   // MFLOPS
+    prepared.isa = saved_isa;
+    pool_set_team(saved_team);
+    return count;
 }
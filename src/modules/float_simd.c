@@ -0,0 +1,316 @@
+#include <stdio.h>
+#include <stdint.h>
+#include "float_simd.h"
+#include "cpu_features.h"
+#include "config.h"
+#include "timer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define SIMD_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET(x) __attribute__((target(x)))
+#else
+#define TARGET(x)
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SIMD_ARM 1
+#include <arm_neon.h>
+#endif
+
+#define NO_TARGET
+
+// ---------------------------------------------------------------------------
+// Kernel templates
+// ---------------------------------------------------------------------------
+
+// Dot product: four vector accumulators, fused or separate multiply-add
+#define DEFINE_DOT(NAME, ATTR, VEC, T, LANES, ZERO, LOADU, MACC, ADD, STOREU)   \
+    ATTR static double NAME(const T* a, const T* b, size_t n) {                 \
+        VEC s0 = ZERO(), s1 = ZERO(), s2 = ZERO(), s3 = ZERO();                 \
+        size_t i = 0;                                                           \
+        for (; i + 4 * (LANES) <= n; i += 4 * (LANES)) {                        \
+            s0 = MACC(s0, LOADU(a + i), LOADU(b + i));                          \
+            s1 = MACC(s1, LOADU(a + i + (LANES)), LOADU(b + i + (LANES)));      \
+            s2 = MACC(s2, LOADU(a + i + 2 * (LANES)), LOADU(b + i + 2 * (LANES))); \
+            s3 = MACC(s3, LOADU(a + i + 3 * (LANES)), LOADU(b + i + 3 * (LANES))); \
+        }                                                                       \
+        T lanes[LANES];                                                         \
+        STOREU(lanes, ADD(ADD(s0, s1), ADD(s2, s3)));                           \
+        double sum = 0.0;                                                       \
+        for (int l = 0; l < (LANES); ++l) sum += (double)lanes[l];              \
+        for (; i < n; ++i) sum += (double)a[i] * (double)b[i];                  \
+        return sum;                                                             \
+    }
+
+// Peak kernel: FMA_CHAINS independent x = x*m + c chains held in registers.
+// Twelve chains cover FMA latency (4-5 cycles) x two FMA ports with margin.
+#define FMA_CHAINS 12
+
+#define DEFINE_FMA(NAME, ATTR, VEC, T, LANES, SET1, MADD, STOREU)               \
+    ATTR static double NAME(size_t iters) {                                     \
+        const VEC m = SET1((T)0.999999), c = SET1((T)1e-6);                     \
+        VEC x0 = SET1((T)0), x1 = SET1((T)1), x2 = SET1((T)2), x3 = SET1((T)3); \
+        VEC x4 = SET1((T)4), x5 = SET1((T)5), x6 = SET1((T)6), x7 = SET1((T)7); \
+        VEC x8 = SET1((T)8), x9 = SET1((T)9), x10 = SET1((T)10), x11 = SET1((T)11); \
+        for (size_t i = 0; i < iters; ++i) {                                    \
+            x0 = MADD(x0, m, c); x1 = MADD(x1, m, c); x2 = MADD(x2, m, c);      \
+            x3 = MADD(x3, m, c); x4 = MADD(x4, m, c); x5 = MADD(x5, m, c);      \
+            x6 = MADD(x6, m, c); x7 = MADD(x7, m, c); x8 = MADD(x8, m, c);      \
+            x9 = MADD(x9, m, c); x10 = MADD(x10, m, c); x11 = MADD(x11, m, c);  \
+        }                                                                       \
+        const VEC all[FMA_CHAINS] = { x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11 }; \
+        T lanes[LANES];                                                         \
+        double sum = 0.0;                                                       \
+        for (int k = 0; k < FMA_CHAINS; ++k) {                                  \
+            STOREU(lanes, all[k]);                                              \
+            for (int l = 0; l < (LANES); ++l) sum += (double)lanes[l];          \
+        }                                                                       \
+        return sum;                                                             \
+    }
+
+// ---------------------------------------------------------------------------
+// Scalar (every platform)
+// ---------------------------------------------------------------------------
+
+#define SC_ZERO()            0
+#define SC_LOAD(p)           (*(p))
+#define SC_MACC(s, x, y)     ((s) + (x) * (y))
+#define SC_ADD(x, y)         ((x) + (y))
+#define SC_STORE(p, v)       ((p)[0] = (v))
+#define SC_SET1(v)           (v)
+#define SC_MADD(x, m, c)     ((x) * (m) + (c))
+
+DEFINE_DOT(dot_f32_scalar, NO_TARGET, float, float, 1, SC_ZERO, SC_LOAD, SC_MACC, SC_ADD, SC_STORE)
+DEFINE_DOT(dot_f64_scalar, NO_TARGET, double, double, 1, SC_ZERO, SC_LOAD, SC_MACC, SC_ADD, SC_STORE)
+DEFINE_FMA(fma_f32_scalar, NO_TARGET, float, float, 1, SC_SET1, SC_MADD, SC_STORE)
+DEFINE_FMA(fma_f64_scalar, NO_TARGET, double, double, 1, SC_SET1, SC_MADD, SC_STORE)
+
+// ---------------------------------------------------------------------------
+// x86: SSE2, AVX2+FMA, AVX-512F
+// ---------------------------------------------------------------------------
+#ifdef SIMD_X86
+
+// SSE2 has no FMA: separate multiply and add (still 2 FLOPs per lane)
+TARGET("sse2") static inline __m128 sse_macc_ps(__m128 s, __m128 x, __m128 y) { return _mm_add_ps(s, _mm_mul_ps(x, y)); }
+TARGET("sse2") static inline __m128d sse_macc_pd(__m128d s, __m128d x, __m128d y) { return _mm_add_pd(s, _mm_mul_pd(x, y)); }
+TARGET("sse2") static inline __m128 sse_madd_ps(__m128 x, __m128 m, __m128 c) { return _mm_add_ps(_mm_mul_ps(x, m), c); }
+TARGET("sse2") static inline __m128d sse_madd_pd(__m128d x, __m128d m, __m128d c) { return _mm_add_pd(_mm_mul_pd(x, m), c); }
+
+DEFINE_DOT(dot_f32_sse2, TARGET("sse2"), __m128, float, 4, _mm_setzero_ps, _mm_loadu_ps, sse_macc_ps, _mm_add_ps, _mm_storeu_ps)
+DEFINE_DOT(dot_f64_sse2, TARGET("sse2"), __m128d, double, 2, _mm_setzero_pd, _mm_loadu_pd, sse_macc_pd, _mm_add_pd, _mm_storeu_pd)
+DEFINE_FMA(fma_f32_sse2, TARGET("sse2"), __m128, float, 4, _mm_set1_ps, sse_madd_ps, _mm_storeu_ps)
+DEFINE_FMA(fma_f64_sse2, TARGET("sse2"), __m128d, double, 2, _mm_set1_pd, sse_madd_pd, _mm_storeu_pd)
+
+#define AVX_MACC_PS(s, x, y) _mm256_fmadd_ps((x), (y), (s))
+#define AVX_MACC_PD(s, x, y) _mm256_fmadd_pd((x), (y), (s))
+
+DEFINE_DOT(dot_f32_avx2, TARGET("avx2,fma"), __m256, float, 8, _mm256_setzero_ps, _mm256_loadu_ps, AVX_MACC_PS, _mm256_add_ps, _mm256_storeu_ps)
+DEFINE_DOT(dot_f64_avx2, TARGET("avx2,fma"), __m256d, double, 4, _mm256_setzero_pd, _mm256_loadu_pd, AVX_MACC_PD, _mm256_add_pd, _mm256_storeu_pd)
+DEFINE_FMA(fma_f32_avx2, TARGET("avx2,fma"), __m256, float, 8, _mm256_set1_ps, _mm256_fmadd_ps, _mm256_storeu_ps)
+DEFINE_FMA(fma_f64_avx2, TARGET("avx2,fma"), __m256d, double, 4, _mm256_set1_pd, _mm256_fmadd_pd, _mm256_storeu_pd)
+
+#define AVX512_MACC_PS(s, x, y) _mm512_fmadd_ps((x), (y), (s))
+#define AVX512_MACC_PD(s, x, y) _mm512_fmadd_pd((x), (y), (s))
+
+DEFINE_DOT(dot_f32_avx512, TARGET("avx512f"), __m512, float, 16, _mm512_setzero_ps, _mm512_loadu_ps, AVX512_MACC_PS, _mm512_add_ps, _mm512_storeu_ps)
+DEFINE_DOT(dot_f64_avx512, TARGET("avx512f"), __m512d, double, 8, _mm512_setzero_pd, _mm512_loadu_pd, AVX512_MACC_PD, _mm512_add_pd, _mm512_storeu_pd)
+DEFINE_FMA(fma_f32_avx512, TARGET("avx512f"), __m512, float, 16, _mm512_set1_ps, _mm512_fmadd_ps, _mm512_storeu_ps)
+DEFINE_FMA(fma_f64_avx512, TARGET("avx512f"), __m512d, double, 8, _mm512_set1_pd, _mm512_fmadd_pd, _mm512_storeu_pd)
+#endif
+
+// ---------------------------------------------------------------------------
+// AArch64: NEON (baseline)
+// ---------------------------------------------------------------------------
+#ifdef SIMD_ARM
+
+#define NEON_ZERO_F32()         vdupq_n_f32(0.0f)
+#define NEON_ZERO_F64()         vdupq_n_f64(0.0)
+#define NEON_MADD_F32(x, m, c)  vfmaq_f32((c), (x), (m))
+#define NEON_MADD_F64(x, m, c)  vfmaq_f64((c), (x), (m))
+
+DEFINE_DOT(dot_f32_neon, NO_TARGET, float32x4_t, float, 4, NEON_ZERO_F32, vld1q_f32, vfmaq_f32, vaddq_f32, vst1q_f32)
+DEFINE_DOT(dot_f64_neon, NO_TARGET, float64x2_t, double, 2, NEON_ZERO_F64, vld1q_f64, vfmaq_f64, vaddq_f64, vst1q_f64)
+DEFINE_FMA(fma_f32_neon, NO_TARGET, float32x4_t, float, 4, vdupq_n_f32, NEON_MADD_F32, vst1q_f32)
+DEFINE_FMA(fma_f64_neon, NO_TARGET, float64x2_t, double, 2, vdupq_n_f64, NEON_MADD_F64, vst1q_f64)
+#endif
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+
+int simd_isa_available(SimdIsa isa) {
+    const CpuFeatures* f = cpu_features();
+    switch (isa) {
+    case SIMD_SCALAR: return 1;
+#ifdef SIMD_X86
+    case SIMD_SSE2:   return f->sse2;
+    case SIMD_AVX2:   return f->avx2 && f->fma;
+    case SIMD_AVX512: return f->avx512f;
+#endif
+#ifdef SIMD_ARM
+    case SIMD_NEON:   return 1;
+#endif
+    default:          (void)f; return 0;
+    }
+}
+
+SimdIsa simd_best_isa(void) {
+    for (int i = SIMD_ISA_COUNT - 1; i > SIMD_SCALAR; --i) {
+        if (simd_isa_available((SimdIsa)i)) return (SimdIsa)i;
+    }
+    return SIMD_SCALAR;
+}
+
+SimdIsa simd_configured_isa(void) {
+    const int want = bench_config_defaults()->simd_isa;
+    if (want < 0 || want >= SIMD_ISA_COUNT) return simd_best_isa();
+    if (!simd_isa_available((SimdIsa)want)) {
+        static int warned;
+        if (!warned) {
+            fprintf(stderr, "[SIMD] %s not supported on this CPU, using %s\n",
+                simd_isa_name((SimdIsa)want), simd_isa_name(simd_best_isa()));
+            warned = 1;
+        }
+        return simd_best_isa();
+    }
+    return (SimdIsa)want;
+}
+
+const char* simd_isa_name(SimdIsa isa) {
+    switch (isa) {
+    case SIMD_SSE2:   return "SSE2";
+    case SIMD_AVX2:   return "AVX2";
+    case SIMD_AVX512: return "AVX512";
+    case SIMD_NEON:   return "NEON";
+    default:          return "SCALAR";
+    }
+}
+
+static int lanes(SimdIsa isa, int dp) {
+    switch (isa) {
+    case SIMD_SSE2:
+    case SIMD_NEON:   return dp ? 2 : 4;
+    case SIMD_AVX2:   return dp ? 4 : 8;
+    case SIMD_AVX512: return dp ? 8 : 16;
+    default:          return 1;
+    }
+}
+
+double simd_fma_flops_per_iter(SimdIsa isa, int dp) {
+    return 2.0 * FMA_CHAINS * (double)lanes(isa, dp);   // multiply + add per lane and chain
+}
+
+double simd_peak_flops_per_cycle(SimdIsa isa, int dp) {
+    // Two pipes either way: 2 FMAs (4 FLOPs) or 1 mul + 1 add (2 FLOPs) per lane and cycle
+    const int fused = (isa == SIMD_AVX2 || isa == SIMD_AVX512 || isa == SIMD_NEON);
+    return (fused ? 4.0 : 2.0) * (double)lanes(isa, dp);
+}
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__aarch64__))
+// Register + register adds in one asm block, so the chain survives any optimization
+// level (recent cores fold add-immediate chains at rename)
+#if defined(__x86_64__)
+#define ADD1 "add %1, %0\n\t"
+#else
+#define ADD1 "add %0, %0, %1\n\t"
+#endif
+#define ADD8  ADD1 ADD1 ADD1 ADD1 ADD1 ADD1 ADD1 ADD1
+#define ADD64 ADD8 ADD8 ADD8 ADD8 ADD8 ADD8 ADD8 ADD8
+
+static double measure_ghz(void) {
+    const uint64_t rounds = 1u << 19;   // 64 adds each: ~33M cycles
+    double best = 0.0;
+    for (int rep = 0; rep < 3; ++rep) {
+        uint64_t x = 0;
+        const uint64_t one = 1;
+        const double t0 = timer_now_seconds();
+        for (uint64_t i = 0; i < rounds; ++i) {
+            __asm__ volatile(ADD64 : "+r"(x) : "r"(one));
+        }
+        const double dt = timer_now_seconds() - t0;
+        const double ghz = (dt > 0.0) ? (double)x / dt / 1e9 : 0.0;
+        if (ghz > best) best = ghz;   // first pass may still be ramping the clock
+    }
+    return best;
+}
+#elif defined(_WIN32)
+static double measure_ghz(void) {
+    HKEY key;
+    DWORD mhz = 0, len = sizeof(mhz);
+    if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, "HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0",
+        0, KEY_QUERY_VALUE, &key) == ERROR_SUCCESS) {
+        RegQueryValueExA(key, "~MHz", NULL, NULL, (LPBYTE)&mhz, &len);
+        RegCloseKey(key);
+    }
+    return (double)mhz / 1000.0;
+}
+#else
+static double measure_ghz(void) { return 0.0; }
+#endif
+
+double simd_clock_ghz(void) {
+    static double ghz = -1.0;
+    if (ghz < 0.0) ghz = measure_ghz();
+    return ghz;
+}
+
+double simd_dot_f32(SimdIsa isa, const float* a, const float* b, size_t n) {
+    switch (isa) {
+#ifdef SIMD_X86
+    case SIMD_SSE2:   return dot_f32_sse2(a, b, n);
+    case SIMD_AVX2:   return dot_f32_avx2(a, b, n);
+    case SIMD_AVX512: return dot_f32_avx512(a, b, n);
+#endif
+#ifdef SIMD_ARM
+    case SIMD_NEON:   return dot_f32_neon(a, b, n);
+#endif
+    default:          return dot_f32_scalar(a, b, n);
+    }
+}
+
+double simd_dot_f64(SimdIsa isa, const double* a, const double* b, size_t n) {
+    switch (isa) {
+#ifdef SIMD_X86
+    case SIMD_SSE2:   return dot_f64_sse2(a, b, n);
+    case SIMD_AVX2:   return dot_f64_avx2(a, b, n);
+    case SIMD_AVX512: return dot_f64_avx512(a, b, n);
+#endif
+#ifdef SIMD_ARM
+    case SIMD_NEON:   return dot_f64_neon(a, b, n);
+#endif
+    default:          return dot_f64_scalar(a, b, n);
+    }
+}
+
+double simd_fma_f32(SimdIsa isa, size_t iters) {
+    switch (isa) {
+#ifdef SIMD_X86
+    case SIMD_SSE2:   return fma_f32_sse2(iters);
+    case SIMD_AVX2:   return fma_f32_avx2(iters);
+    case SIMD_AVX512: return fma_f32_avx512(iters);
+#endif
+#ifdef SIMD_ARM
+    case SIMD_NEON:   return fma_f32_neon(iters);
+#endif
+    default:          return fma_f32_scalar(iters);
+    }
+}
+
+double simd_fma_f64(SimdIsa isa, size_t iters) {
+    switch (isa) {
+#ifdef SIMD_X86
+    case SIMD_SSE2:   return fma_f64_sse2(iters);
+    case SIMD_AVX2:   return fma_f64_avx2(iters);
+    case SIMD_AVX512: return fma_f64_avx512(iters);
+#endif
+#ifdef SIMD_ARM
+    case SIMD_NEON:   return fma_f64_neon(iters);
+#endif
+    default:          return fma_f64_scalar(iters);
+    }
+}
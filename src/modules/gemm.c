@@ -0,0 +1,356 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "config.h"
+#include "threadpool.h"
+#include "arena.h"
+#include "float_simd.h"
+#include "gemm.h"
+#include "topology.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define GEMM_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET(x) __attribute__((target(x)))
+#else
+#define TARGET(x)
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define GEMM_ARM 1
+#include <arm_neon.h>
+#endif
+
+#define NO_TARGET
+
+// Blocking (elements). A block MC x KC stays in L2, a KC x NR panel of B in L1,
+// the packed KC x NC block of B in L2/L3. MC and NC are multiples of every MR / NR.
+#define MR 6
+#define MC 96
+#define KC 256
+#define NC 512
+#define NR_MAX 32
+
+// ---------------------------------------------------------------------------
+// Micro-kernels: T[MR][NR] = sum over kc of a[k][0..MR) (x) b[k][0..NR),
+// NR = two vectors, so MR x 2 accumulators stay in registers
+// ---------------------------------------------------------------------------
+
+#define DEFINE_UKERNEL(NAME, ATTR, T, VEC, LANES, ZERO, LOADU, BCAST, MACC, STOREU) \
+    ATTR static void NAME(size_t kc, const T* a, const T* b, T* t) {            \
+        VEC c00 = ZERO(), c01 = ZERO(), c10 = ZERO(), c11 = ZERO();             \
+        VEC c20 = ZERO(), c21 = ZERO(), c30 = ZERO(), c31 = ZERO();             \
+        VEC c40 = ZERO(), c41 = ZERO(), c50 = ZERO(), c51 = ZERO();             \
+        for (size_t k = 0; k < kc; ++k, a += MR, b += 2 * (LANES)) {            \
+            const VEC b0 = LOADU(b), b1 = LOADU(b + (LANES));                   \
+            VEC ar;                                                             \
+            ar = BCAST(a[0]); c00 = MACC(c00, ar, b0); c01 = MACC(c01, ar, b1); \
+            ar = BCAST(a[1]); c10 = MACC(c10, ar, b0); c11 = MACC(c11, ar, b1); \
+            ar = BCAST(a[2]); c20 = MACC(c20, ar, b0); c21 = MACC(c21, ar, b1); \
+            ar = BCAST(a[3]); c30 = MACC(c30, ar, b0); c31 = MACC(c31, ar, b1); \
+            ar = BCAST(a[4]); c40 = MACC(c40, ar, b0); c41 = MACC(c41, ar, b1); \
+            ar = BCAST(a[5]); c50 = MACC(c50, ar, b0); c51 = MACC(c51, ar, b1); \
+        }                                                                       \
+        const size_t nr = 2 * (LANES);                                          \
+        STOREU(t + 0 * nr, c00); STOREU(t + 0 * nr + (LANES), c01);             \
+        STOREU(t + 1 * nr, c10); STOREU(t + 1 * nr + (LANES), c11);             \
+        STOREU(t + 2 * nr, c20); STOREU(t + 2 * nr + (LANES), c21);             \
+        STOREU(t + 3 * nr, c30); STOREU(t + 3 * nr + (LANES), c31);             \
+        STOREU(t + 4 * nr, c40); STOREU(t + 4 * nr + (LANES), c41);             \
+        STOREU(t + 5 * nr, c50); STOREU(t + 5 * nr + (LANES), c51);             \
+    }
+
+#define SC_ZERO()         0
+#define SC_LOAD(p)        (*(p))
+#define SC_BCAST(v)       (v)
+#define SC_MACC(s, x, y)  ((s) + (x) * (y))
+#define SC_STORE(p, v)    ((p)[0] = (v))
+
+DEFINE_UKERNEL(uk_f64_scalar, NO_TARGET, double, double, 1, SC_ZERO, SC_LOAD, SC_BCAST, SC_MACC, SC_STORE)
+DEFINE_UKERNEL(uk_f32_scalar, NO_TARGET, float, float, 1, SC_ZERO, SC_LOAD, SC_BCAST, SC_MACC, SC_STORE)
+
+#ifdef GEMM_X86
+TARGET("sse2") static inline __m128d sse_macc_pd(__m128d s, __m128d x, __m128d y) { return _mm_add_pd(s, _mm_mul_pd(x, y)); }
+TARGET("sse2") static inline __m128 sse_macc_ps(__m128 s, __m128 x, __m128 y) { return _mm_add_ps(s, _mm_mul_ps(x, y)); }
+
+DEFINE_UKERNEL(uk_f64_sse2, TARGET("sse2"), double, __m128d, 2, _mm_setzero_pd, _mm_loadu_pd, _mm_set1_pd, sse_macc_pd, _mm_storeu_pd)
+DEFINE_UKERNEL(uk_f32_sse2, TARGET("sse2"), float, __m128, 4, _mm_setzero_ps, _mm_loadu_ps, _mm_set1_ps, sse_macc_ps, _mm_storeu_ps)
+
+#define AVX_MACC_PD(s, x, y) _mm256_fmadd_pd((x), (y), (s))
+#define AVX_MACC_PS(s, x, y) _mm256_fmadd_ps((x), (y), (s))
+
+DEFINE_UKERNEL(uk_f64_avx2, TARGET("avx2,fma"), double, __m256d, 4, _mm256_setzero_pd, _mm256_loadu_pd, _mm256_set1_pd, AVX_MACC_PD, _mm256_storeu_pd)
+DEFINE_UKERNEL(uk_f32_avx2, TARGET("avx2,fma"), float, __m256, 8, _mm256_setzero_ps, _mm256_loadu_ps, _mm256_set1_ps, AVX_MACC_PS, _mm256_storeu_ps)
+
+#define AVX512_MACC_PD(s, x, y) _mm512_fmadd_pd((x), (y), (s))
+#define AVX512_MACC_PS(s, x, y) _mm512_fmadd_ps((x), (y), (s))
+
+DEFINE_UKERNEL(uk_f64_avx512, TARGET("avx512f"), double, __m512d, 8, _mm512_setzero_pd, _mm512_loadu_pd, _mm512_set1_pd, AVX512_MACC_PD, _mm512_storeu_pd)
+DEFINE_UKERNEL(uk_f32_avx512, TARGET("avx512f"), float, __m512, 16, _mm512_setzero_ps, _mm512_loadu_ps, _mm512_set1_ps, AVX512_MACC_PS, _mm512_storeu_ps)
+#endif
+
+#ifdef GEMM_ARM
+#define NEON_ZERO_F64()       vdupq_n_f64(0.0)
+#define NEON_ZERO_F32()       vdupq_n_f32(0.0f)
+
+DEFINE_UKERNEL(uk_f64_neon, NO_TARGET, double, float64x2_t, 2, NEON_ZERO_F64, vld1q_f64, vdupq_n_f64, vfmaq_f64, vst1q_f64)
+DEFINE_UKERNEL(uk_f32_neon, NO_TARGET, float, float32x4_t, 4, NEON_ZERO_F32, vld1q_f32, vdupq_n_f32, vfmaq_f32, vst1q_f32)
+#endif
+
+typedef void (*UkernelF64)(size_t kc, const double* a, const double* b, double* t);
+typedef void (*UkernelF32)(size_t kc, const float* a, const float* b, float* t);
+
+typedef struct {
+    UkernelF64 f64;
+    UkernelF32 f32;
+    int nr_f64, nr_f32;
+} Ukernel;
+
+static Ukernel ukernel_for(SimdIsa isa) {
+    switch (isa) {
+#ifdef GEMM_X86
+    case SIMD_SSE2:   return (Ukernel){ uk_f64_sse2, uk_f32_sse2, 4, 8 };
+    case SIMD_AVX2:   return (Ukernel){ uk_f64_avx2, uk_f32_avx2, 8, 16 };
+    case SIMD_AVX512: return (Ukernel){ uk_f64_avx512, uk_f32_avx512, 16, 32 };
+#endif
+#ifdef GEMM_ARM
+    case SIMD_NEON:   return (Ukernel){ uk_f64_neon, uk_f32_neon, 4, 8 };
+#endif
+    default:          return (Ukernel){ uk_f64_scalar, uk_f32_scalar, 2, 2 };
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Packing and the macro-tile loop, once per element type
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    int      dp;
+    SimdIsa  isa;
+    Ukernel  uk;
+    size_t   n;
+    const void* A;
+    const void* B;
+    void*    C;
+    void*    pack[POOL_MAX_THREADS];   // per thread: MC x KC of A, then KC x NC of B
+    size_t   npack;
+} GemmJob;
+
+#define DEFINE_GEMM(T, SUF)                                                     \
+    /* MR-row panels, k-major, zero-padded past the last row */                 \
+    static void pack_a_##SUF(const T* A, size_t lda, size_t mc, size_t kc, T* dst) { \
+        for (size_t i = 0; i < mc; i += MR) {                                   \
+            for (size_t k = 0; k < kc; ++k) {                                   \
+                for (size_t r = 0; r < MR; ++r)                                 \
+                    *dst++ = (i + r < mc) ? A[(i + r) * lda + k] : (T)0;        \
+            }                                                                   \
+        }                                                                       \
+    }                                                                           \
+    /* NR-column panels, k-major, zero-padded past the last column */           \
+    static void pack_b_##SUF(const T* B, size_t ldb, size_t kc, size_t nc, size_t nr, T* dst) { \
+        for (size_t j = 0; j < nc; j += nr) {                                   \
+            const size_t w = (nc - j < nr) ? nc - j : nr;                       \
+            for (size_t k = 0; k < kc; ++k) {                                   \
+                const T* src = B + k * ldb + j;                                 \
+                size_t c = 0;                                                   \
+                for (; c < w; ++c) *dst++ = src[c];                             \
+                for (; c < nr; ++c) *dst++ = (T)0;                              \
+            }                                                                   \
+        }                                                                       \
+    }                                                                           \
+    /* C[:, jc..] = A * B[:, jc..] for the MC x NC macro-tiles of column block    \
+       jc owned by this thread (tile index % nthreads == tid). Each KC x NC       \
+       block of B is packed once and reused by all of those tiles. */           \
+    static double gemm_panel_##SUF(const GemmJob* job, size_t jc, int tid, int nthreads, T* pack) { \
+        const size_t n = job->n;                                                \
+        const size_t nr = (size_t)job->uk.nr_##SUF;                             \
+        const size_t nc = (n - jc < NC) ? n - jc : NC;                          \
+        const size_t mt = (n + MC - 1) / MC;                                    \
+        const size_t t0 = (jc / NC) * mt;                                       \
+        const T* A = (const T*)job->A;                                          \
+        const T* B = (const T*)job->B;                                          \
+        T* C = (T*)job->C;                                                      \
+        T* pa = pack;                                                           \
+        T* pb = pack + MC * KC;                                                 \
+        T tile[MR * NR_MAX];                                                    \
+        double flops = 0.0;                                                     \
+        for (size_t pc = 0; pc < n; pc += KC) {                                 \
+            const size_t kc = (n - pc < KC) ? n - pc : KC;                      \
+            int packed = 0;                                                     \
+            for (size_t it = 0; it < mt; ++it) {                                \
+                if ((t0 + it) % (size_t)nthreads != (size_t)tid) continue;      \
+                const size_t ic = it * MC;                                      \
+                const size_t mc = (n - ic < MC) ? n - ic : MC;                  \
+                if (!packed) { pack_b_##SUF(B + pc * n + jc, n, kc, nc, nr, pb); packed = 1; } \
+                pack_a_##SUF(A + ic * n + pc, n, mc, kc, pa);                   \
+                for (size_t jr = 0; jr < nc; jr += nr) {                        \
+                    const size_t w = (nc - jr < nr) ? nc - jr : nr;             \
+                    for (size_t ir = 0; ir < mc; ir += MR) {                    \
+                        const size_t h = (mc - ir < MR) ? mc - ir : MR;         \
+                        job->uk.SUF(kc, pa + ir * kc, pb + jr * kc, tile);      \
+                        for (size_t r = 0; r < h; ++r) {                        \
+                            T* crow = C + (ic + ir + r) * n + jc + jr;          \
+                            const T* trow = tile + r * nr;                      \
+                            if (pc == 0) for (size_t c = 0; c < w; ++c) crow[c] = trow[c]; \
+                            else         for (size_t c = 0; c < w; ++c) crow[c] += trow[c]; \
+                        }                                                       \
+                    }                                                           \
+                }                                                               \
+                flops += 2.0 * (double)mc * (double)nc * (double)kc;            \
+            }                                                                   \
+        }                                                                       \
+        return flops;                                                           \
+    }
+
+DEFINE_GEMM(double, f64)
+DEFINE_GEMM(float, f32)
+
+static void gemm_worker(int tid, int nthreads, void* arg) {
+    const GemmJob* job = (const GemmJob*)arg;
+    double flops = 0.0;
+
+    // Macro-tiles are dealt round-robin; each thread packs its own blocks
+    pool_timed_begin(tid);
+    for (size_t jc = 0; jc < job->n; jc += NC) {
+        flops += job->dp ? gemm_panel_f64(job, jc, tid, nthreads, (double*)job->pack[tid])
+                         : gemm_panel_f32(job, jc, tid, nthreads, (float*)job->pack[tid]);
+    }
+    pool_timed_end(tid, flops / 1e9);
+}
+
+// ---------------------------------------------------------------------------
+// Buffers
+// ---------------------------------------------------------------------------
+
+// Fills A and B with small values (exact in f32) and sets up pack buffers for the team
+static int gemm_alloc(GemmJob* job, size_t n, int dp) {
+    const size_t es = dp ? sizeof(double) : sizeof(float);
+    void* A = arena_alloc(n * n * es);
+    void* B = arena_alloc(n * n * es);
+    void* C = arena_alloc(n * n * es);
+    if (!A || !B || !C) return 0;
+
+    for (size_t i = 0; i < n * n; ++i) {
+        const double a = ((double)(i % 17) - 8.0) * 0.125;
+        const double b = ((double)((i * 7) % 13) - 6.0) * 0.25;
+        if (dp) { ((double*)A)[i] = a; ((double*)B)[i] = b; }
+        else    { ((float*)A)[i] = (float)a; ((float*)B)[i] = (float)b; }
+    }
+
+    const int team = pool_team();
+    for (int t = 0; t < team; ++t) {
+        job->pack[t] = arena_alloc((MC * KC + KC * NC) * es);
+        if (!job->pack[t]) return 0;
+    }
+    job->npack = (size_t)team;
+    job->A = A;
+    job->B = B;
+    job->C = C;
+    job->n = n;
+    job->dp = dp;
+    job->isa = simd_configured_isa();
+    job->uk = ukernel_for(job->isa);
+    return 1;
+}
+
+static double gemm_run(GemmJob* job) {
+    pool_run(gemm_worker, job);
+
+    // Prevent optimization
+    volatile double sink = job->dp ? ((const double*)job->C)[job->n * job->n / 2]
+                                   : (double)((const float*)job->C)[job->n * job->n / 2];
+    (void)sink;
+    return pool_last_stats(NULL);   // GFLOPS
+}
+
+static GemmJob prepared[2];   // [0] f32, [1] f64
+static unsigned prepared_gen;
+
+int gemm_prepare(void) {
+    const size_t N = bench_config_defaults()->gemm_N;
+    const size_t team = (size_t)pool_team();
+    if (prepared_gen == arena_generation() && prepared[1].n == N &&
+        prepared[0].npack >= team && prepared[1].npack >= team) return 1;
+
+    if (!gemm_alloc(&prepared[0], N, 0) || !gemm_alloc(&prepared[1], N, 1)) return 0;
+    prepared_gen = arena_generation();
+    return 1;
+}
+
+void gemm_teardown(void) { prepared_gen = 0; }
+
+double gemm_dgemm_gflops_once(void) { return gemm_prepare() ? gemm_run(&prepared[1]) : 0.0; }
+double gemm_sgemm_gflops_once(void) { return gemm_prepare() ? gemm_run(&prepared[0]) : 0.0; }
+
+// SMT siblings share one core's FMA ports, so threads past the physical core
+// count add no peak
+static int peak_cores(void) {
+    const int cores = topology_get()->ncores;
+    const int team = pool_team();
+    return (cores > 0 && team > cores) ? cores : team;
+}
+
+double gemm_peak_gflops(int dp) {
+    return (double)peak_cores() * simd_clock_ghz() *
+        simd_peak_flops_per_cycle(simd_configured_isa(), dp);
+}
+
+// ---------------------------------------------------------------------------
+// Size sweep (measured once, reported as GFLOPS and as % of peak)
+// ---------------------------------------------------------------------------
+
+#define SWEEP_MAX_SIZES 16
+
+typedef struct {
+    size_t n;
+    double gflops[2];   // [0] f32, [1] f64
+} GemmPoint;
+
+static GemmPoint sweep_points[SWEEP_MAX_SIZES];
+static int       sweep_count = -1;
+
+static void gemm_sweep_run(void) {
+    const size_t max_n = bench_config_defaults()->gemm_sweep_max;
+    sweep_count = 0;
+    for (size_t n = 128; n <= max_n && sweep_count < SWEEP_MAX_SIZES; n *= 2) {
+        GemmPoint* pt = &sweep_points[sweep_count++];
+        pt->n = n;
+        for (int dp = 0; dp < 2; ++dp) {
+            // Every size gets fresh arena buffers; other modules re-prepare by generation
+            GemmJob job;
+            memset(&job, 0, sizeof(job));
+            arena_reset();
+            if (!gemm_alloc(&job, n, dp)) { pt->gflops[dp] = 0.0; continue; }
+            (void)gemm_run(&job);   // warm-up
+            pt->gflops[dp] = gemm_run(&job);
+        }
+    }
+    arena_reset();
+}
+
+static int gemm_sweep_fill(SweepPoint* out, int cap, int pct) {
+    int n = 0;
+    const double peak[2] = { gemm_peak_gflops(0), gemm_peak_gflops(1) };
+    for (int i = 0; i < sweep_count; ++i) {
+        for (int dp = 1; dp >= 0 && n < cap; --dp, ++n) {
+            snprintf(out[n].label, sizeof(out[n].label), "%c%zu", dp ? 'D' : 'S', sweep_points[i].n);
+            out[n].x = (double)sweep_points[i].n;
+            out[n].value = pct ? (peak[dp] > 0.0 ? 100.0 * sweep_points[i].gflops[dp] / peak[dp] : 0.0)
+                               : sweep_points[i].gflops[dp];
+        }
+    }
+    return n;
+}
+
+int gemm_gflops_sweep(SweepPoint* out, int cap) {
+    gemm_sweep_run();
+    printf("[GEMM] %s micro-kernel, theoretical peak %.1f GFLOPS f64 / %.1f f32 "
+        "(%d cores x %.2f GHz, %d threads)\n", simd_isa_name(simd_configured_isa()),
+        gemm_peak_gflops(1), gemm_peak_gflops(0), peak_cores(), simd_clock_ghz(), pool_team());
+    return gemm_sweep_fill(out, cap, 0);
+}
+
+int gemm_peak_pct_sweep(SweepPoint* out, int cap) {
+    if (sweep_count < 0) gemm_sweep_run();
+    return gemm_sweep_fill(out, cap, 1);
+}
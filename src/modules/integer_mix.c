@@ -1,8 +1,28 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include "timer.h"
 #include "util.h"
 #include "metric_units.h"
+#include "config.h"
+#include "threadpool.h"
+#include "arena.h"
+#include "cpu_features.h"
+#include "float_simd.h"
+#include "integer_mix.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define INT_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET(x) __attribute__((target(x)))
+#else
+#define TARGET(x)
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define INT_ARM 1
+#include <arm_neon.h>
+#endif
 
 void integer_demo_run(void) {
     const size_t N = 50 * 1000 * 1000ULL; // 50M byte-like steps
@@ -19,26 +39,450 @@ void integer_demo_run(void) {
     printf("[Integer] ~%.1f %s (acc=%llu)\\n", mips, UNIT_MIPS, (unsigned long long)acc);
 }
 
+// One chain step per 64-bit word of the block, every pass
+static size_t chain_iterations(void) {
+    const BenchConfig* cfg = bench_config_defaults();
+    const int passes = cfg->integer_passes > 0 ? cfg->integer_passes : 1;
+    return cfg->integer_block_bytes / sizeof(uint64_t) * (size_t)passes;
+}
+
+// ---------------------------------------------------------------------------
+// Chains: one dependent chain (latency), eight independent ones (throughput)
+// ---------------------------------------------------------------------------
+
+#define C1 0x2545F4914F6CDD1DULL
+#define CHAIN_STEP(acc, i) do { (acc) ^= (uint64_t)(i); (acc) *= C1; (acc) = rotl64((acc), 13); } while (0)
+
+// Each thread runs its own xor-mul-rotate chain over a slice of the iterations
+static void integer_worker(int tid, int nthreads, void* arg) {
+    const size_t   N = *(const size_t*)arg;
+    const size_t   begin = N * (size_t)tid / (size_t)nthreads;
+    const size_t   end = N * (size_t)(tid + 1) / (size_t)nthreads;
+
+    uint64_t acc = 0x9e3779b97f4a7c15ULL ^ (uint64_t)tid;
+
+    pool_timed_begin(tid);
+    for (size_t i = begin; i < end; ++i) {
+        CHAIN_STEP(acc, i);     // xor, multiply, rotate
+    }
+    // xor + mul + rot = 3 ops, reported in millions
+    pool_timed_end(tid, (double)(end - begin) * 3.0 / 1e6);
+
+    // prevent the compiler from discarding the work
+    volatile uint64_t sink = acc; (void)sink;
+}
+
+// Same steps spread over eight independent chains: bound by multiplier throughput
+static void integer_ilp_worker(int tid, int nthreads, void* arg) {
+    const size_t   N = *(const size_t*)arg / 8;
+    const size_t   begin = N * (size_t)tid / (size_t)nthreads;
+    const size_t   end = N * (size_t)(tid + 1) / (size_t)nthreads;
+
+    uint64_t a0 = 1 ^ (uint64_t)tid, a1 = 2, a2 = 3, a3 = 4, a4 = 5, a5 = 6, a6 = 7, a7 = 8;
+
+    pool_timed_begin(tid);
+    for (size_t i = begin; i < end; ++i) {
+        CHAIN_STEP(a0, i); CHAIN_STEP(a1, i); CHAIN_STEP(a2, i); CHAIN_STEP(a3, i);
+        CHAIN_STEP(a4, i); CHAIN_STEP(a5, i); CHAIN_STEP(a6, i); CHAIN_STEP(a7, i);
+    }
+    pool_timed_end(tid, (double)(end - begin) * 8.0 * 3.0 / 1e6);
+
+    volatile uint64_t sink = a0 ^ a1 ^ a2 ^ a3 ^ a4 ^ a5 ^ a6 ^ a7; (void)sink;
+}
 
 double integer_mips_once(void) {
-    const uint64_t C1 = 0x2545F4914F6CDD1DULL;
-    const size_t   N = 50ull * 1000ull * 1000ull; // 50M iterations
+    size_t N = chain_iterations();        // split across the team
+    pool_run(integer_worker, &N);
+    return pool_last_stats(NULL);         // millions of ops per second
+}
 
-    uint64_t acc = 0x9e3779b97f4a7c15ULL;
+double integer_ilp_mips_once(void) {
+    size_t N = chain_iterations();
+    pool_run(integer_ilp_worker, &N);
+    return pool_last_stats(NULL);
+}
 
-    // time the loop
-    timer_start();
-    for (size_t i = 0; i < N; ++i) {
-        acc ^= (uint64_t)i;     // xor
-        acc *= C1;              // multiply
-        acc = rotl64(acc, 13);  // rotate
+// ---------------------------------------------------------------------------
+// Sort: branchy quicksort on 64Ki-key chunks (L2-sized)
+// ---------------------------------------------------------------------------
+
+#define SORT_CHUNK 65536u
+
+// The branchy kernels run ~100x slower per byte than the streaming ones, so they
+// cover one pass over a fixed share of the block instead of integer_passes passes
+#define SORT_SHARE  16   // 1/16 of the block as uint32 keys
+#define PROBE_SHARE 4    // 1/4 of the block as probe words
+
+static void insertion_sort_u32(uint32_t* a, size_t n) {
+    for (size_t i = 1; i < n; ++i) {
+        const uint32_t v = a[i];
+        size_t j = i;
+        while (j > 0 && a[j - 1] > v) { a[j] = a[j - 1]; --j; }
+        a[j] = v;
+    }
+}
+
+static void quicksort_u32(uint32_t* a, size_t n) {
+    while (n > 16) {
+        // Median of three as pivot, Hoare partition
+        const uint32_t x = a[0], y = a[n / 2], z = a[n - 1];
+        const uint32_t p = (x < y) ? ((y < z) ? y : (x < z ? z : x)) : ((x < z) ? x : (y < z ? z : y));
+        size_t i = 0, j = n - 1;
+        for (;;) {
+            while (a[i] < p) ++i;
+            while (a[j] > p) --j;
+            if (i >= j) break;
+            const uint32_t t = a[i]; a[i] = a[j]; a[j] = t;
+            ++i; --j;
+        }
+        // Recurse into the smaller half, loop on the larger
+        const size_t left = j + 1;
+        if (left < n - left) { quicksort_u32(a, left); a += left; n -= left; }
+        else { quicksort_u32(a + left, n - left); n = left; }
+    }
+    insertion_sort_u32(a, n);
+}
+
+// ---------------------------------------------------------------------------
+// Hash-table probe: open addressing, linear probing, 50% load, half hits
+// ---------------------------------------------------------------------------
+
+#define HT_BITS  18                          // 256Ki slots, 1 MiB of keys
+#define HT_SLOTS (1u << HT_BITS)
+#define HT_KEYS  (HT_SLOTS / 2)
+
+static inline uint32_t ht_slot(uint32_t key) { return (key * 0x9E3779B1u) >> (32 - HT_BITS); }
+
+static void ht_build(uint32_t* table, uint32_t* keys) {
+    uint64_t s = 0x5EED0F7AB1Eull;
+    memset(table, 0, HT_SLOTS * sizeof(uint32_t));
+    for (uint32_t i = 0; i < HT_KEYS; ++i) {
+        const uint32_t k = (uint32_t)splitmix64(&s) | 1u;   // 0 marks an empty slot
+        uint32_t h = ht_slot(k);
+        while (table[h] != 0 && table[h] != k) h = (h + 1) & (HT_SLOTS - 1);
+        table[h] = k;
+        keys[i] = k;
+    }
+}
+
+static uint64_t ht_probe(const uint32_t* table, const uint32_t* keys, const uint32_t* w, size_t n) {
+    uint64_t hits = 0;
+    for (size_t i = 0; i < n; ++i) {
+        // Odd words look up a stored key, even words a (mostly) absent one
+        const uint32_t k = (w[i] & 1u) ? keys[(w[i] >> 1) & (HT_KEYS - 1)] : (w[i] | 1u);
+        uint32_t h = ht_slot(k);
+        for (;;) {
+            const uint32_t t = table[h];
+            if (t == k) { hits++; break; }
+            if (t == 0) break;
+            h = (h + 1) & (HT_SLOTS - 1);
+        }
+    }
+    return hits;
+}
+
+// ---------------------------------------------------------------------------
+// CRC32C (SSE4.2 instruction, else slicing-by-8) and XXH64
+// ---------------------------------------------------------------------------
+
+static uint32_t crc_table[8][256];
+
+static void crc_init_tables(void) {
+    if (crc_table[0][1]) return;
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = (c >> 1) ^ (0x82F63B78u & (0u - (c & 1u)));
+        crc_table[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (int t = 1; t < 8; ++t)
+            crc_table[t][i] = (crc_table[t - 1][i] >> 8) ^ crc_table[0][crc_table[t - 1][i] & 0xFF];
+    }
+}
+
+static uint32_t crc32c_sw(uint32_t crc, const uint8_t* p, size_t n) {
+    crc = ~crc;
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        v ^= crc;   // little-endian byte order
+        crc = crc_table[7][v & 0xFF] ^ crc_table[6][(v >> 8) & 0xFF] ^
+              crc_table[5][(v >> 16) & 0xFF] ^ crc_table[4][(v >> 24) & 0xFF] ^
+              crc_table[3][(v >> 32) & 0xFF] ^ crc_table[2][(v >> 40) & 0xFF] ^
+              crc_table[1][(v >> 48) & 0xFF] ^ crc_table[0][v >> 56];
+    }
+    while (n--) crc = (crc >> 8) ^ crc_table[0][(crc ^ *p++) & 0xFF];
+    return ~crc;
+}
+
+#if defined(INT_X86) && (defined(__x86_64__) || defined(_M_X64))
+TARGET("sse4.2") static uint32_t crc32c_hw(uint32_t crc, const uint8_t* p, size_t n) {
+    uint64_t c = ~crc;
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        c = _mm_crc32_u64(c, v);
+    }
+    uint32_t c32 = (uint32_t)c;
+    while (n--) c32 = _mm_crc32_u8(c32, *p++);
+    return ~c32;
+}
+#define HAVE_CRC32C_HW 1
+#endif
+
+static uint32_t crc32c(uint32_t crc, const uint8_t* p, size_t n) {
+#ifdef HAVE_CRC32C_HW
+    if (cpu_features()->sse42) return crc32c_hw(crc, p, n);
+#endif
+    return crc32c_sw(crc, p, n);
+}
+
+#define XXP1 0x9E3779B185EBCA87ULL
+#define XXP2 0xC2B2AE3D27D4EB4FULL
+#define XXP3 0x165667B19E3779F9ULL
+#define XXP4 0x85EBCA77C2B2AE63ULL
+#define XXP5 0x27D4EB2F165667C5ULL
+
+static inline uint64_t xxh_round(uint64_t acc, uint64_t in) {
+    acc += in * XXP2;
+    acc = rotl64(acc, 31);
+    return acc * XXP1;
+}
+
+static inline uint64_t xxh_merge(uint64_t acc, uint64_t v) {
+    acc ^= xxh_round(0, v);
+    return acc * XXP1 + XXP4;
+}
+
+static uint64_t xxh64(const uint8_t* p, size_t n, uint64_t seed) {
+    const uint8_t* const end = p + n;
+    uint64_t h;
+    if (n >= 32) {
+        uint64_t v1 = seed + XXP1 + XXP2, v2 = seed + XXP2, v3 = seed, v4 = seed - XXP1;
+        for (; p + 32 <= end; p += 32) {
+            uint64_t w[4];
+            memcpy(w, p, 32);
+            v1 = xxh_round(v1, w[0]); v2 = xxh_round(v2, w[1]);
+            v3 = xxh_round(v3, w[2]); v4 = xxh_round(v4, w[3]);
+        }
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxh_merge(h, v1); h = xxh_merge(h, v2); h = xxh_merge(h, v3); h = xxh_merge(h, v4);
+    } else {
+        h = seed + XXP5;
+    }
+    h += (uint64_t)n;
+    for (; p + 8 <= end; p += 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h ^= xxh_round(0, w);
+        h = rotl64(h, 27) * XXP1 + XXP4;
+    }
+    if (p + 4 <= end) {
+        uint32_t w;
+        memcpy(&w, p, 4);
+        h ^= (uint64_t)w * XXP1;
+        h = rotl64(h, 23) * XXP2 + XXP3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h ^= (*p) * XXP5;
+        h = rotl64(h, 11) * XXP1;
+    }
+    h ^= h >> 33; h *= XXP2;
+    h ^= h >> 29; h *= XXP3;
+    return h ^ (h >> 32);
+}
+
+// ---------------------------------------------------------------------------
+// Vector integer mix: per 32-bit lane h = (h ^ v) + (h << 5), h ^= h >> 7,
+// four independent vector accumulators
+// ---------------------------------------------------------------------------
+
+static uint32_t vmix_scalar(const uint32_t* w, size_t n) {
+    uint32_t h0 = 1, h1 = 2, h2 = 3, h3 = 4;
+    size_t i = 0;
+#define VMIX1(h, v) do { (h) ^= (v); (h) += (h) << 5; (h) ^= (h) >> 7; } while (0)
+    for (; i + 4 <= n; i += 4) { VMIX1(h0, w[i]); VMIX1(h1, w[i + 1]); VMIX1(h2, w[i + 2]); VMIX1(h3, w[i + 3]); }
+    for (; i < n; ++i) VMIX1(h0, w[i]);
+#undef VMIX1
+    return h0 ^ h1 ^ h2 ^ h3;
+}
+
+#define DEFINE_VMIX(NAME, ATTR, VEC, LANES, LOADU, SET1, XOR, ADD, SLLI, SRLI, STOREU) \
+    ATTR static uint32_t NAME(const uint32_t* w, size_t n) {                    \
+        VEC h0 = SET1(1), h1 = SET1(2), h2 = SET1(3), h3 = SET1(4);             \
+        size_t i = 0;                                                           \
+        for (; i + 4 * (LANES) <= n; i += 4 * (LANES)) {                        \
+            h0 = XOR(h0, LOADU(w + i));                                         \
+            h1 = XOR(h1, LOADU(w + i + (LANES)));                               \
+            h2 = XOR(h2, LOADU(w + i + 2 * (LANES)));                           \
+            h3 = XOR(h3, LOADU(w + i + 3 * (LANES)));                           \
+            h0 = ADD(h0, SLLI(h0, 5)); h1 = ADD(h1, SLLI(h1, 5));               \
+            h2 = ADD(h2, SLLI(h2, 5)); h3 = ADD(h3, SLLI(h3, 5));               \
+            h0 = XOR(h0, SRLI(h0, 7)); h1 = XOR(h1, SRLI(h1, 7));               \
+            h2 = XOR(h2, SRLI(h2, 7)); h3 = XOR(h3, SRLI(h3, 7));               \
+        }                                                                       \
+        uint32_t lanes[LANES];                                                  \
+        STOREU(lanes, XOR(XOR(h0, h1), XOR(h2, h3)));                           \
+        uint32_t h = vmix_scalar(w + i, n - i);                                 \
+        for (int l = 0; l < (LANES); ++l) h ^= lanes[l];                        \
+        return h;                                                               \
+    }
+
+#ifdef INT_X86
+#define SSE_LOADU(p)     _mm_loadu_si128((const __m128i*)(p))
+#define SSE_STOREU(p, v) _mm_storeu_si128((__m128i*)(p), (v))
+#define AVX_LOADU(p)     _mm256_loadu_si256((const __m256i*)(p))
+#define AVX_STOREU(p, v) _mm256_storeu_si256((__m256i*)(p), (v))
+#define AVX512_LOADU(p)     _mm512_loadu_si512((const void*)(p))
+#define AVX512_STOREU(p, v) _mm512_storeu_si512((void*)(p), (v))
+
+DEFINE_VMIX(vmix_sse2, TARGET("sse2"), __m128i, 4, SSE_LOADU, _mm_set1_epi32, _mm_xor_si128, _mm_add_epi32, _mm_slli_epi32, _mm_srli_epi32, SSE_STOREU)
+DEFINE_VMIX(vmix_avx2, TARGET("avx2"), __m256i, 8, AVX_LOADU, _mm256_set1_epi32, _mm256_xor_si256, _mm256_add_epi32, _mm256_slli_epi32, _mm256_srli_epi32, AVX_STOREU)
+DEFINE_VMIX(vmix_avx512, TARGET("avx512f"), __m512i, 16, AVX512_LOADU, _mm512_set1_epi32, _mm512_xor_si512, _mm512_add_epi32, _mm512_slli_epi32, _mm512_srli_epi32, AVX512_STOREU)
+#endif
+
+#ifdef INT_ARM
+#define NEON_SET1_U32(v)   vdupq_n_u32((uint32_t)(v))
+#define NEON_SLLI_U32(x, s) vshlq_n_u32((x), (s))
+#define NEON_SRLI_U32(x, s) vshrq_n_u32((x), (s))
+
+DEFINE_VMIX(vmix_neon, , uint32x4_t, 4, vld1q_u32, NEON_SET1_U32, veorq_u32, vaddq_u32, NEON_SLLI_U32, NEON_SRLI_U32, vst1q_u32)
+#endif
+
+static uint32_t vmix(SimdIsa isa, const uint32_t* w, size_t n) {
+    switch (isa) {
+#ifdef INT_X86
+    case SIMD_SSE2:   return vmix_sse2(w, n);
+    case SIMD_AVX2:   return vmix_avx2(w, n);
+    case SIMD_AVX512: return vmix_avx512(w, n);
+#endif
+#ifdef INT_ARM
+    case SIMD_NEON:   return vmix_neon(w, n);
+#endif
+    default:          return vmix_scalar(w, n);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Block workloads
+// ---------------------------------------------------------------------------
+
+typedef enum { B_SORT, B_PROBE, B_CRC, B_XXH, B_VMIX } BlockKernel;
+
+typedef struct {
+    BlockKernel     kind;
+    const uint32_t* data;     // integer_block_bytes of pseudo-random words
+    uint32_t*       work;     // sort scratch for the sorted share
+    const uint32_t* table;    // hash table slots
+    const uint32_t* keys;     // keys stored in the table
+    size_t          words;
+    int             passes;
+    SimdIsa         isa;
+} BlockJob;
+
+static void block_worker(int tid, int nthreads, void* arg) {
+    const BlockJob* job = (const BlockJob*)arg;
+    uint64_t acc = 0;
+    double units = 0.0;
+
+    if (job->kind == B_SORT) {
+        // Whole chunks per thread; restore the unsorted keys before timing
+        const size_t keys = job->words / SORT_SHARE;
+        const size_t chunks = (keys + SORT_CHUNK - 1) / SORT_CHUNK;
+        const size_t c0 = chunks * (size_t)tid / (size_t)nthreads;
+        const size_t c1 = chunks * (size_t)(tid + 1) / (size_t)nthreads;
+        const size_t begin = c0 * SORT_CHUNK;
+        const size_t end = (c1 * SORT_CHUNK < keys) ? c1 * SORT_CHUNK : keys;
+        if (end > begin) memcpy(job->work + begin, job->data + begin, (end - begin) * sizeof(uint32_t));
+
+        pool_timed_begin(tid);
+        for (size_t i = begin; i < end; i += SORT_CHUNK) {
+            const size_t n = (end - i < SORT_CHUNK) ? end - i : SORT_CHUNK;
+            quicksort_u32(job->work + i, n);
+        }
+        units = (double)(end - begin) / 1e6;   // Mkeys
+        pool_timed_end(tid, units);
+        if (end > begin) acc = job->work[begin];
+    } else {
+        // 64-byte aligned slices of the block (or of its probe share)
+        const int probe = (job->kind == B_PROBE);
+        const size_t words = probe ? job->words / PROBE_SHARE : job->words;
+        const int passes = probe ? 1 : job->passes;
+        const size_t lines = words / 16;
+        const size_t begin = lines * (size_t)tid / (size_t)nthreads * 16;
+        const size_t end = (tid + 1 == nthreads) ? words : lines * (size_t)(tid + 1) / (size_t)nthreads * 16;
+        const uint32_t* w = job->data + begin;
+        const size_t n = end - begin;
+        const size_t bytes = n * sizeof(uint32_t);
+
+        pool_timed_begin(tid);
+        for (int p = 0; p < passes; ++p) {
+            switch (job->kind) {
+            case B_PROBE: acc += ht_probe(job->table, job->keys, w, n); break;
+            case B_CRC:   acc += crc32c((uint32_t)p, (const uint8_t*)w, bytes); break;
+            case B_XXH:   acc += xxh64((const uint8_t*)w, bytes, (uint64_t)p); break;
+            case B_VMIX:  acc += vmix(job->isa, w, n); break;
+            default: break;
+            }
+        }
+        units = probe ? (double)n / 1e6                                 // Mprobes
+                      : (double)bytes * passes / (1024.0 * 1024.0);     // MB (MiB)
+        pool_timed_end(tid, units);
     }
-    double dt = timer_elapsed_seconds();
 
     // prevent the compiler from discarding the work
     volatile uint64_t sink = acc; (void)sink;
+}
+
+// Block, sort scratch and hash table live in the arena across repetitions
+static BlockJob prepared;
+static unsigned prepared_gen;
+
+int integer_prepare(void) {
+    const BenchConfig* cfg = bench_config_defaults();
+    const size_t words = cfg->integer_block_bytes / sizeof(uint32_t);
+    prepared.passes = cfg->integer_passes > 0 ? cfg->integer_passes : 1;
+    prepared.isa = simd_configured_isa();
+    if (prepared_gen == arena_generation() && prepared.words == words) return 1;
+
+    uint32_t* data = (uint32_t*)arena_alloc(words * sizeof(uint32_t) + 1);
+    uint32_t* work = (uint32_t*)arena_alloc(words / SORT_SHARE * sizeof(uint32_t) + 1);
+    uint32_t* table = (uint32_t*)arena_alloc(HT_SLOTS * sizeof(uint32_t));
+    uint32_t* keys = (uint32_t*)arena_alloc(HT_KEYS * sizeof(uint32_t));
+    if (!data || !work || !table || !keys) return 0;
+
+    // Deterministic pseudo-random block (kept outside timing)
+    uint64_t s = 0x1B7E6E5Dull;
+    for (size_t i = 0; i + 1 < words; i += 2) {
+        const uint64_t r = splitmix64(&s);
+        data[i] = (uint32_t)r;
+        data[i + 1] = (uint32_t)(r >> 32);
+    }
+    if (words & 1) data[words - 1] = (uint32_t)splitmix64(&s);
+    ht_build(table, keys);
+    crc_init_tables();
+
+    prepared.data = data;
+    prepared.work = work;
+    prepared.table = table;
+    prepared.keys = keys;
+    prepared.words = words;
+    prepared_gen = arena_generation();
+    return 1;
+}
+
+void integer_teardown(void) { prepared_gen = 0; }
+
+static double block_once(BlockKernel kind) {
+    if (!integer_prepare()) return 0.0;
+    prepared.kind = kind;
+    pool_run(block_worker, &prepared);
+    return pool_last_stats(NULL);
+}
 
-    const double ops = (double)N * 3.0;   // xor + mul + rot = 3 ops
-    const double mips = (ops / dt) / 1e6;  // millions of ops per second
-    return mips;
-}
\ No newline at end of file
+double integer_sort_mkeys_once(void)    { return block_once(B_SORT); }
+double integer_probe_mops_once(void)    { return block_once(B_PROBE); }
+double integer_crc32c_mbps_once(void)   { return block_once(B_CRC); }
+double integer_xxh64_mbps_once(void)    { return block_once(B_XXH); }
+double integer_vector_mbps_once(void)   { return block_once(B_VMIX); }
@@ -0,0 +1,445 @@
+#include <stdlib.h>
+#include <string.h>
+#include "lz_codec.h"
+
+#define MIN_MATCH   3
+#define MAX_MATCH   258
+#define WINDOW      32768
+#define HASH_BITS   15
+#define MAX_BITS    15          // longest Huffman code
+#define NUM_LITLEN  286         // 0-255 literals, 256 end of block, 257-285 lengths
+#define NUM_DIST    30
+#define END_BLOCK   256
+
+#define BLOCK_STORED  0
+#define BLOCK_HUFFMAN 1
+
+// DEFLATE (RFC 1951) length and distance code tables
+static const uint16_t LEN_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t LEN_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// Match finder effort per level: chain depth, lazy evaluation, "good enough" length
+static const struct { int chain; int lazy; int nice; } LEVELS[LZ_LEVEL_MAX + 1] = {
+    { 0, 0, 0 },
+    { 4, 0, 16 }, { 8, 0, 32 }, { 16, 0, 32 }, { 16, 1, 32 }, { 32, 1, 64 },
+    { 128, 1, 128 }, { 256, 1, 258 }, { 1024, 1, 258 }, { 4096, 1, 258 }
+};
+
+typedef struct { uint16_t lit_or_len; uint16_t dist; } Token;   // dist == 0: literal
+
+struct LzWork {
+    size_t   max_block;
+    int32_t  head[1 << HASH_BITS];
+    int32_t* prev;      // previous position with the same hash, per block offset
+    Token*   tokens;
+    uint8_t  len_code[MAX_MATCH + 1];
+    uint16_t lit_table[1 << MAX_BITS];    // decoder lookup tables
+    uint16_t dist_table[1 << MAX_BITS];
+};
+
+static int len_code_slow(unsigned len) {
+    int c = 0;
+    while (c < 28 && LEN_BASE[c + 1] <= len) ++c;
+    return c;
+}
+
+LzWork* lz_work_create(size_t max_block) {
+    LzWork* w = (LzWork*)calloc(1, sizeof(LzWork));
+    if (!w) return NULL;
+    w->max_block = max_block;
+    w->prev = (int32_t*)malloc((max_block ? max_block : 1) * sizeof(int32_t));
+    w->tokens = (Token*)malloc((max_block + 1) * sizeof(Token));
+    if (!w->prev || !w->tokens) { lz_work_destroy(w); return NULL; }
+    for (unsigned l = MIN_MATCH; l <= MAX_MATCH; ++l) w->len_code[l] = (uint8_t)len_code_slow(l);
+    return w;
+}
+
+void lz_work_destroy(LzWork* w) {
+    if (!w) return;
+    free(w->prev);
+    free(w->tokens);
+    free(w);
+}
+
+size_t lz_bound(size_t n) { return n + LZ_BLOCK_HEADER; }
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+static uint32_t get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// ---------------------------------------------------------------------------
+// Match finder
+// ---------------------------------------------------------------------------
+
+static uint32_t hash3(const uint8_t* p) {
+    const uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static int dist_code(unsigned dist) {
+    const unsigned x = dist - 1;
+    if (x < 4) return (int)x;
+    int lg = 31;
+    while (!(x >> lg)) --lg;
+    return 2 * lg + (int)((x >> (lg - 1)) & 1);
+}
+
+static size_t tokenize(LzWork* w, int level, const uint8_t* src, size_t n) {
+    const int max_chain = LEVELS[level].chain;
+    const int lazy = LEVELS[level].lazy;
+    const unsigned nice = (unsigned)LEVELS[level].nice;
+    Token* tok = w->tokens;
+    size_t nt = 0, inserted = 0, p = 0;
+    int have_prev = 0;
+    unsigned prev_len = 0, prev_dist = 0;
+
+    for (size_t i = 0; i < ((size_t)1 << HASH_BITS); ++i) w->head[i] = -1;
+
+    while (p < n) {
+        // Chains hold every position before p
+        for (; inserted < p && inserted + MIN_MATCH <= n; ++inserted) {
+            const uint32_t h = hash3(src + inserted);
+            w->prev[inserted] = w->head[h];
+            w->head[h] = (int32_t)inserted;
+        }
+
+        unsigned best_len = 0, best_dist = 0;
+        if (p + MIN_MATCH <= n) {
+            const unsigned max_len = (n - p < MAX_MATCH) ? (unsigned)(n - p) : MAX_MATCH;
+            int32_t cand = w->head[hash3(src + p)];
+            int chain = max_chain;
+            while (cand >= 0 && p - (size_t)cand <= WINDOW && chain-- > 0) {
+                const uint8_t* a = src + cand;
+                const uint8_t* b = src + p;
+                if (a[best_len] == b[best_len] || best_len == 0) {
+                    unsigned l = 0;
+                    while (l < max_len && a[l] == b[l]) ++l;
+                    if (l > best_len) {
+                        best_len = l;
+                        best_dist = (unsigned)(p - (size_t)cand);
+                        if (l >= nice || l == max_len) break;
+                    }
+                }
+                cand = w->prev[cand];
+            }
+            if (best_len < MIN_MATCH) best_len = 0;
+        }
+
+        if (have_prev) {
+            if (best_len <= prev_len) {
+                tok[nt].lit_or_len = (uint16_t)prev_len; tok[nt++].dist = (uint16_t)prev_dist;
+                p = p - 1 + prev_len;
+                have_prev = 0;
+                continue;
+            }
+            tok[nt].lit_or_len = src[p - 1]; tok[nt++].dist = 0;   // deferred literal
+        }
+
+        if (best_len) {
+            if (lazy && best_len < nice && p + 1 < n) {
+                have_prev = 1; prev_len = best_len; prev_dist = best_dist;
+                ++p;
+                continue;
+            }
+            tok[nt].lit_or_len = (uint16_t)best_len; tok[nt++].dist = (uint16_t)best_dist;
+            p += best_len;
+            have_prev = 0;
+            continue;
+        }
+        have_prev = 0;
+        tok[nt].lit_or_len = src[p]; tok[nt++].dist = 0;
+        ++p;
+    }
+    if (have_prev) { tok[nt].lit_or_len = (uint16_t)prev_len; tok[nt++].dist = (uint16_t)prev_dist; }
+    return nt;
+}
+
+// ---------------------------------------------------------------------------
+// Huffman code construction (length-limited by frequency halving)
+// ---------------------------------------------------------------------------
+
+static void huff_lengths(const uint32_t* freq_in, int n, uint8_t* lens) {
+    uint32_t freq[NUM_LITLEN];
+    int parent[2 * NUM_LITLEN];
+    uint64_t weight[2 * NUM_LITLEN];
+    int used = 0, last = 0;
+
+    memcpy(freq, freq_in, (size_t)n * sizeof(uint32_t));
+    for (int i = 0; i < n; ++i) if (freq[i]) { used++; last = i; }
+    memset(lens, 0, (size_t)n);
+    if (used == 0) return;
+    if (used == 1) { lens[last] = 1; return; }
+
+    for (;;) {
+        int alive[2 * NUM_LITLEN], na = 0, nodes = n;
+        for (int i = 0; i < n; ++i) {
+            parent[i] = -1;
+            weight[i] = freq[i];
+            if (freq[i]) alive[na++] = i;
+        }
+        // O(n^2) pairing is fine for <= 286 symbols per block
+        while (na > 1) {
+            int a = 0, b = 1;
+            if (weight[alive[b]] < weight[alive[a]]) { a = 1; b = 0; }
+            for (int i = 2; i < na; ++i) {
+                if (weight[alive[i]] < weight[alive[a]]) { b = a; a = i; }
+                else if (weight[alive[i]] < weight[alive[b]]) { b = i; }
+            }
+            const int na_id = alive[a], nb_id = alive[b];
+            weight[nodes] = weight[na_id] + weight[nb_id];
+            parent[nodes] = -1;
+            parent[na_id] = parent[nb_id] = nodes;
+            const int hi = (a > b) ? a : b, lo = (a > b) ? b : a;
+            alive[hi] = alive[--na];
+            alive[lo] = nodes++;
+        }
+
+        int max_len = 0;
+        for (int i = 0; i < n; ++i) {
+            if (!freq[i]) continue;
+            int d = 0;
+            for (int x = i; parent[x] >= 0; x = parent[x]) ++d;
+            lens[i] = (uint8_t)d;
+            if (d > max_len) max_len = d;
+        }
+        if (max_len <= MAX_BITS) return;
+        for (int i = 0; i < n; ++i) if (freq[i]) freq[i] = (freq[i] >> 1) | 1;
+    }
+}
+
+// Canonical codes (RFC 1951 3.2.2), bit-reversed for LSB-first output
+static void huff_codes(const uint8_t* lens, int n, uint16_t* codes) {
+    uint16_t bl_count[MAX_BITS + 1] = { 0 }, next[MAX_BITS + 1];
+    for (int i = 0; i < n; ++i) bl_count[lens[i]]++;
+    bl_count[0] = 0;
+    uint16_t code = 0;
+    for (int b = 1; b <= MAX_BITS; ++b) {
+        code = (uint16_t)((code + bl_count[b - 1]) << 1);
+        next[b] = code;
+    }
+    for (int i = 0; i < n; ++i) {
+        const int l = lens[i];
+        if (!l) { codes[i] = 0; continue; }
+        uint16_t c = next[l]++, r = 0;
+        for (int k = 0; k < l; ++k) { r = (uint16_t)((r << 1) | (c & 1)); c >>= 1; }
+        codes[i] = r;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Bit I/O
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    uint8_t* p;
+    uint8_t* end;
+    uint64_t acc;
+    int      bits;
+    int      overflow;
+} BitWriter;
+
+static void bw_put(BitWriter* bw, uint32_t v, int n) {
+    bw->acc |= (uint64_t)v << bw->bits;
+    bw->bits += n;
+    while (bw->bits >= 8) {
+        if (bw->p >= bw->end) { bw->overflow = 1; bw->bits = 0; bw->acc = 0; return; }
+        *bw->p++ = (uint8_t)bw->acc;
+        bw->acc >>= 8;
+        bw->bits -= 8;
+    }
+}
+
+static void bw_flush(BitWriter* bw) {
+    if (bw->bits > 0) bw_put(bw, 0, 8 - bw->bits);
+}
+
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+    uint64_t acc;
+    int      bits;
+} BitReader;
+
+static void br_refill(BitReader* br) {
+    while (br->bits <= 56) {
+        const uint64_t byte = (br->p < br->end) ? *br->p : 0;   // zero padding past the end
+        br->p++;
+        br->acc |= byte << br->bits;
+        br->bits += 8;
+    }
+}
+
+static uint32_t br_get(BitReader* br, int n) {
+    if (br->bits < n) br_refill(br);
+    const uint32_t v = (uint32_t)(br->acc & ((1ull << n) - 1));
+    br->acc >>= n;
+    br->bits -= n;
+    return v;
+}
+
+// ---------------------------------------------------------------------------
+// Block encode / decode
+// ---------------------------------------------------------------------------
+
+static size_t store_block(const uint8_t* src, size_t n, uint8_t* dst) {
+    dst[0] = BLOCK_STORED;
+    put_u32(dst + 1, (uint32_t)n);
+    put_u32(dst + 5, (uint32_t)n);
+    memcpy(dst + LZ_BLOCK_HEADER, src, n);
+    return LZ_BLOCK_HEADER + n;
+}
+
+size_t lz_compress_block(LzWork* w, int level, const uint8_t* src, size_t n, uint8_t* dst, size_t cap) {
+    if (cap < lz_bound(n) || n > w->max_block || n > 0xFFFFFFFFu) return 0;
+    if (level < LZ_LEVEL_MIN) level = LZ_LEVEL_MIN;
+    if (level > LZ_LEVEL_MAX) level = LZ_LEVEL_MAX;
+
+    const size_t nt = tokenize(w, level, src, n);
+    const Token* tok = w->tokens;
+
+    uint32_t lf[NUM_LITLEN] = { 0 }, df[NUM_DIST] = { 0 };
+    for (size_t i = 0; i < nt; ++i) {
+        if (tok[i].dist == 0) lf[tok[i].lit_or_len]++;
+        else {
+            lf[257 + w->len_code[tok[i].lit_or_len]]++;
+            df[dist_code(tok[i].dist)]++;
+        }
+    }
+    lf[END_BLOCK] = 1;
+
+    uint8_t ll[NUM_LITLEN], dl[NUM_DIST];
+    uint16_t lc[NUM_LITLEN], dc[NUM_DIST];
+    huff_lengths(lf, NUM_LITLEN, ll);
+    huff_lengths(df, NUM_DIST, dl);
+    huff_codes(ll, NUM_LITLEN, lc);
+    huff_codes(dl, NUM_DIST, dc);
+
+    // Payload may not exceed the raw size, otherwise the stored form wins
+    BitWriter bw = { dst + LZ_BLOCK_HEADER, dst + LZ_BLOCK_HEADER + n, 0, 0, 0 };
+    for (int i = 0; i < NUM_LITLEN; ++i) bw_put(&bw, ll[i], 4);
+    for (int i = 0; i < NUM_DIST; ++i) bw_put(&bw, dl[i], 4);
+    for (size_t i = 0; i < nt && !bw.overflow; ++i) {
+        if (tok[i].dist == 0) {
+            bw_put(&bw, lc[tok[i].lit_or_len], ll[tok[i].lit_or_len]);
+        }
+        else {
+            const int c = w->len_code[tok[i].lit_or_len];
+            bw_put(&bw, lc[257 + c], ll[257 + c]);
+            if (LEN_EXTRA[c]) bw_put(&bw, tok[i].lit_or_len - LEN_BASE[c], LEN_EXTRA[c]);
+            const int d = dist_code(tok[i].dist);
+            bw_put(&bw, dc[d], dl[d]);
+            if (DIST_EXTRA[d]) bw_put(&bw, tok[i].dist - DIST_BASE[d], DIST_EXTRA[d]);
+        }
+    }
+    bw_put(&bw, lc[END_BLOCK], ll[END_BLOCK]);
+    bw_flush(&bw);
+    if (bw.overflow) return store_block(src, n, dst);
+
+    const size_t payload = (size_t)(bw.p - (dst + LZ_BLOCK_HEADER));
+    dst[0] = BLOCK_HUFFMAN;
+    put_u32(dst + 1, (uint32_t)n);
+    put_u32(dst + 5, (uint32_t)payload);
+    return LZ_BLOCK_HEADER + payload;
+}
+
+// Single-level decode table: entry = symbol << 4 | code length
+static int build_decode_table(const uint8_t* lens, int n, uint16_t* table, int* bits_out) {
+    uint16_t codes[NUM_LITLEN];
+    int max_len = 0, used = 0;
+    for (int i = 0; i < n; ++i) {
+        if (lens[i] > MAX_BITS) return 0;
+        if (lens[i] > max_len) max_len = lens[i];
+        if (lens[i]) used++;
+    }
+    *bits_out = max_len;
+    if (!used) return 1;
+    huff_codes(lens, n, codes);
+    const size_t size = (size_t)1 << max_len;
+    memset(table, 0, size * sizeof(uint16_t));
+    for (int i = 0; i < n; ++i) {
+        if (!lens[i]) continue;
+        for (size_t j = codes[i]; j < size; j += (size_t)1 << lens[i]) {
+            table[j] = (uint16_t)((i << 4) | lens[i]);
+        }
+    }
+    return 1;
+}
+
+static int decode_sym(BitReader* br, const uint16_t* table, int bits) {
+    if (br->bits < bits) br_refill(br);
+    const uint16_t e = table[br->acc & ((1ull << bits) - 1)];
+    const int len = e & 15;
+    if (!len) return -1;   // code not assigned: corrupt stream
+    br->acc >>= len;
+    br->bits -= len;
+    return e >> 4;
+}
+
+size_t lz_decompress_block(LzWork* w, const uint8_t* src, size_t avail, size_t* consumed,
+    uint8_t* dst, size_t cap) {
+    const size_t BAD = (size_t)-1;
+    if (avail < LZ_BLOCK_HEADER) return BAD;
+    const size_t raw = get_u32(src + 1);
+    const size_t payload = get_u32(src + 5);
+    if (payload > avail - LZ_BLOCK_HEADER || raw > cap) return BAD;
+    if (consumed) *consumed = LZ_BLOCK_HEADER + payload;
+
+    const uint8_t* in = src + LZ_BLOCK_HEADER;
+    if (src[0] == BLOCK_STORED) {
+        if (payload != raw) return BAD;
+        memcpy(dst, in, raw);
+        return raw;
+    }
+    if (src[0] != BLOCK_HUFFMAN) return BAD;
+
+    BitReader br = { in, in + payload, 0, 0 };
+    uint8_t ll[NUM_LITLEN], dl[NUM_DIST];
+    for (int i = 0; i < NUM_LITLEN; ++i) ll[i] = (uint8_t)br_get(&br, 4);
+    for (int i = 0; i < NUM_DIST; ++i) dl[i] = (uint8_t)br_get(&br, 4);
+
+    uint16_t* lt = w->lit_table;
+    uint16_t* dt = w->dist_table;
+    int lbits = 0, dbits = 0;
+    size_t out = 0;
+    if (!build_decode_table(ll, NUM_LITLEN, lt, &lbits) || !build_decode_table(dl, NUM_DIST, dt, &dbits) || !lbits) {
+        return BAD;
+    }
+
+    for (;;) {
+        const int sym = decode_sym(&br, lt, lbits);
+        if (sym < 0 || br.p > br.end + 8) { out = BAD; break; }
+        if (sym < 256) {
+            if (out >= raw) { out = BAD; break; }
+            dst[out++] = (uint8_t)sym;
+            continue;
+        }
+        if (sym == END_BLOCK) break;
+        const int c = sym - 257;
+        if (c >= 29 || !dbits) { out = BAD; break; }
+        const size_t len = LEN_BASE[c] + br_get(&br, LEN_EXTRA[c]);
+        const int d = decode_sym(&br, dt, dbits);
+        if (d < 0 || d >= NUM_DIST) { out = BAD; break; }
+        const size_t dist = DIST_BASE[d] + br_get(&br, DIST_EXTRA[d]);
+        if (dist > out || len > raw - out) { out = BAD; break; }
+
+        // Byte copy: overlapping matches (dist < len) replicate the run
+        const uint8_t* from = dst + out - dist;
+        uint8_t* to = dst + out;
+        for (size_t k = 0; k < len; ++k) to[k] = from[k];
+        out += len;
+    }
+    return (out == raw) ? out : BAD;
+}
@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <stdint.h>
+#include "memory_bandwidth.h"
+#include "threadpool.h"
+#include "pagemem.h"
+#include "config.h"
+#include "sysinfo.h"
+
+#define LINE_WORDS   8                      // 64-byte line of 64-bit words
+#define MIN_BYTES    (4ull * 1024ull)
+#define PASS_BYTES   (256ull << 20)         // traffic per timed run, small sizes loop over the buffer
+#define BW_RUNS      3                      // timed runs per point, the fastest is kept
+
+static const char*  pattern_names[BW_PATTERNS]  = { "RD", "WR", "RMW", "S64", "S128", "S4K", "REV" };
+static const size_t pattern_stride[BW_PATTERNS] = { 0, 0, 0, 64, 128, 4096, 0 };
+
+typedef struct {
+    BwPattern pattern;
+    uint64_t* buf;
+    size_t    words;
+    size_t    passes;
+    uint64_t  sink[POOL_MAX_THREADS];
+} BwJob;
+
+static uint64_t read_fwd(const uint64_t* p, size_t n) {
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (size_t i = 0; i + 4 <= n; i += 4) {
+        s0 += p[i]; s1 += p[i + 1]; s2 += p[i + 2]; s3 += p[i + 3];
+    }
+    return s0 + s1 + s2 + s3;
+}
+
+static uint64_t read_rev(const uint64_t* p, size_t n) {
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (size_t i = n; i >= 4; i -= 4) {
+        s0 += p[i - 1]; s1 += p[i - 2]; s2 += p[i - 3]; s3 += p[i - 4];
+    }
+    return s0 + s1 + s2 + s3;
+}
+
+// One word per stride; the start shifts a line at a time until every line of
+// the slice has been visited, so the footprint matches the sequential patterns
+static uint64_t read_strided(const uint64_t* p, size_t n, size_t stride_words) {
+    uint64_t s = 0;
+    for (size_t phase = 0; phase < stride_words && phase < n; phase += LINE_WORDS) {
+        for (size_t i = phase; i < n; i += stride_words) s += p[i];
+    }
+    return s;
+}
+
+static uint64_t bw_pass(BwPattern pattern, uint64_t* p, size_t n, uint64_t v) {
+    switch (pattern) {
+    case BW_READ:    return read_fwd(p, n);
+    case BW_WRITE:   for (size_t i = 0; i < n; ++i) p[i] = i ^ v; return 0;
+    case BW_RMW:     for (size_t i = 0; i < n; ++i) p[i] += v; return 0;
+    case BW_REVERSE: return read_rev(p, n);
+    default:         return read_strided(p, n, pattern_stride[pattern] / sizeof(uint64_t));
+    }
+}
+
+static void bw_worker(int tid, int nthreads, void* arg) {
+    BwJob* job = (BwJob*)arg;
+    // Line-aligned slices; the last thread takes the remainder
+    const size_t lines = job->words / LINE_WORDS;
+    const size_t begin = lines * (size_t)tid / (size_t)nthreads * LINE_WORDS;
+    const size_t end = (tid == nthreads - 1) ? job->words
+        : lines * (size_t)(tid + 1) / (size_t)nthreads * LINE_WORDS;
+    uint64_t* p = job->buf + begin;
+    const size_t n = end - begin;
+
+    // Untimed fill: first touch of new pages, and leaves cache-sized slices warm
+    for (size_t i = 0; i < n; ++i) p[i] = begin + i;
+
+    pool_timed_begin(tid);
+    uint64_t s = 0;
+    for (size_t r = 0; r < job->passes; ++r) s += bw_pass(job->pattern, p, n, r + 1);
+    const double bytes = (double)n * sizeof(uint64_t) * (double)job->passes;
+    pool_timed_end(tid, bytes / (1024.0 * 1024.0));
+    job->sink[tid] = s;
+}
+
+// Best of BW_RUNS over the first `bytes` of buf, MB/s (MiB/s)
+static double bw_run(BwPattern pattern, uint64_t* buf, size_t bytes) {
+    BwJob job = { 0 };
+    job.pattern = pattern;
+    job.buf = buf;
+    job.words = bytes / sizeof(uint64_t);
+    job.passes = (bytes < PASS_BYTES) ? (size_t)(PASS_BYTES / bytes) : 1;
+
+    double best = 0.0;
+    for (int r = 0; r < BW_RUNS; ++r) {
+        pool_run(bw_worker, &job);
+        const double mbps = pool_last_stats(NULL);
+        if (mbps > best) best = mbps;
+    }
+
+    // Prevent optimization
+    volatile uint64_t sink = job.sink[0] + buf[job.words / 2]; (void)sink;
+    return best;
+}
+
+double memory_bandwidth_mbps(BwPattern pattern, size_t bytes, int huge) {
+    if (bytes < MIN_BYTES) bytes = MIN_BYTES;
+    uint64_t* buf = (uint64_t*)page_alloc(bytes, huge ? PAGE_HUGE : PAGE_SMALL, NULL);
+    if (!buf) return 0.0;
+    const double mbps = bw_run(pattern, buf, bytes);
+    page_free(buf, bytes);
+    return mbps;
+}
+
+// bwm_max_bytes, or 16x the combined last-level cache (64 MiB if unknown),
+// held to half the available memory
+static size_t max_bytes(const BenchConfig* cfg) {
+    if (cfg->bwm_max_bytes) return cfg->bwm_max_bytes;
+    const SystemInfo* si = sysinfo_get();
+    size_t llc = si->llc_bytes * (size_t)(si->llc_instances > 0 ? si->llc_instances : 1);
+    size_t bytes = llc ? 16 * llc : (64ull << 20);
+    if (si->ram_available_bytes > 0 && bytes > (size_t)(si->ram_available_bytes / 2)) {
+        bytes = (size_t)(si->ram_available_bytes / 2);
+    }
+    return bytes;
+}
+
+static void size_label(char* out, size_t n, size_t bytes) {
+    if (bytes < (1ull << 20))      snprintf(out, n, "%zuK", bytes >> 10);
+    else if (bytes < (1ull << 30)) snprintf(out, n, "%zuM", bytes >> 20);
+    else                           snprintf(out, n, "%zuG", bytes >> 30);
+}
+
+int memory_bandwidth_sweep(SweepPoint* out, int cap) {
+    const BenchConfig* cfg = bench_config_defaults();
+    const size_t max = max_bytes(cfg);
+
+    // One buffer at the largest size; smaller points use its head
+    size_t sizes[64];
+    int nsizes = 0;
+    for (size_t b = MIN_BYTES; b <= max && nsizes < 64 && (nsizes + 1) * BW_PATTERNS <= cap; b *= 2) {
+        sizes[nsizes++] = b;
+    }
+    if (nsizes == 0) return 0;
+
+    const size_t top = sizes[nsizes - 1];
+    int huge = 0;
+    uint64_t* buf = (uint64_t*)page_alloc(top, cfg->bwm_hugepages ? PAGE_HUGE : PAGE_SMALL, &huge);
+    if (!buf) return 0;
+    char top_label[16];
+    size_label(top_label, sizeof(top_label), top);
+    printf("[BWM] 4K to %s, %s pages, %d thread%s\n", top_label,
+        huge ? "2M" : "4K", pool_team(), pool_team() == 1 ? "" : "s");
+    if (cfg->bwm_hugepages && !huge) {
+        fprintf(stderr, "[BWM] huge pages unavailable (vm.nr_hugepages / THP), using 4K pages\n");
+    }
+
+    // Pattern-major, so each pattern's rows form one bandwidth-vs-size curve
+    int count = 0;
+    for (int p = 0; p < BW_PATTERNS; ++p) {
+        for (int k = 0; k < nsizes; ++k) {
+            SweepPoint* pt = &out[count++];
+            char sz[16];
+            size_label(sz, sizeof(sz), sizes[k]);
+            snprintf(pt->label, sizeof(pt->label), "%s_%s", pattern_names[p], sz);
+            pt->x = (double)sizes[k];
+            pt->value = bw_run((BwPattern)p, buf, sizes[k]);
+        }
+    }
+
+    page_free(buf, top);
+    return count;
+}
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdint.h>
+#include "memory_latency.h"
+#include "pagemem.h"
+#include "arena.h"
+#include "timer.h"
+#include "config.h"
+#include "util.h"
+#include "suite.h"
+
+#define LINE_BYTES   64               // one node per cache line
+#define CHASE_LOADS  (4ull << 20)     // dependent loads per timed lap
+#define MIN_BYTES    (4ull * 1024ull)
+#define MIN_LOADS    (64ull << 10)    // shortest timed lap of a time-boxed sample
+
+// Links every cache line of the buffer into one random cycle (Sattolo's
+// algorithm), so each load address depends on the previous load and neither
+// the prefetcher nor the out-of-order core can run ahead.
+static void build_chain(uint8_t* base, size_t lines) {
+    uint32_t* next = (uint32_t*)base;   // scratch: permutation stored in line heads
+    for (size_t i = 0; i < lines; ++i) next[i * (LINE_BYTES / 4)] = (uint32_t)i;
+
+    uint64_t seed = 42;
+    for (size_t i = lines - 1; i > 0; --i) {
+        size_t j = (size_t)(splitmix64(&seed) % i);
+        uint32_t* a = &next[i * (LINE_BYTES / 4)];
+        uint32_t* b = &next[j * (LINE_BYTES / 4)];
+        uint32_t t = *a; *a = *b; *b = t;
+    }
+
+    // Each line reads only its own slot before overwriting it, so a single
+    // forward pass turns the indices into pointers to the successor line
+    for (size_t i = 0; i < lines; ++i) {
+        uint8_t* line = base + i * LINE_BYTES;
+        const uint32_t succ = *(uint32_t*)line;
+        *(void**)line = base + (size_t)succ * LINE_BYTES;
+    }
+}
+
+static void* chase(void* p, size_t loads) {
+    // Unrolled so loop overhead stays off the critical path
+    for (size_t i = 0; i < loads; i += 8) {
+        p = *(void**)p; p = *(void**)p; p = *(void**)p; p = *(void**)p;
+        p = *(void**)p; p = *(void**)p; p = *(void**)p; p = *(void**)p;
+    }
+    return p;
+}
+
+static size_t chain_lines(size_t bytes) {
+    if (bytes < MIN_BYTES) bytes = MIN_BYTES;
+    const size_t lines = bytes / LINE_BYTES;
+    return (lines > UINT32_MAX) ? UINT32_MAX : lines;
+}
+
+// One timed lap of `loads` dependent loads over a built chain, ns per load
+static double chase_ns(uint8_t* base, size_t lines, size_t loads) {
+    loads = (loads + 7) & ~(size_t)7;
+    // One unmeasured lap warms caches and TLB to steady state for this size
+    void* p = chase(base, lines < loads ? ((lines + 7) & ~(size_t)7) : loads);
+
+    timer_start();
+    p = chase(p, loads);
+    const double dt = timer_elapsed_seconds();
+
+    void* volatile sink = p; (void)sink;   // the pointer itself must be volatile, or the chase is dead code
+    return (dt * 1e9) / (double)loads;
+}
+
+double memory_latency_ns(size_t bytes, int huge) {
+    const size_t lines = chain_lines(bytes);
+    uint8_t* base = (uint8_t*)page_alloc(lines * LINE_BYTES, huge ? PAGE_HUGE : PAGE_SMALL, NULL);
+    if (!base) return 0.0;
+    build_chain(base, lines);
+    const double ns = chase_ns(base, lines, CHASE_LOADS);
+    page_free(base, lines * LINE_BYTES);
+    return ns;
+}
+
+// The graded test's chain is built once; the chase never modifies it.
+// latency_hugepages asks for its own huge mapping, otherwise it comes from the arena.
+static uint8_t* prepared_base;
+static size_t   prepared_lines;
+static unsigned prepared_gen;
+static int      prepared_own;     // 1 = page_alloc'd here, freed by teardown
+
+void memory_random_teardown(void) {
+    if (prepared_own) page_free(prepared_base, prepared_lines * LINE_BYTES);
+    prepared_own = 0;
+    prepared_gen = 0;
+}
+
+int memory_random_prepare(void) {
+    const BenchConfig* cfg = bench_config_defaults();
+    // Same footprint the old gather test used: N floats + N indices
+    const size_t lines = chain_lines(cfg->triad_N * 8);
+    const int own = cfg->latency_hugepages != 0;
+    const int valid = own ? (prepared_gen != 0) : (prepared_gen == arena_generation());
+    if (valid && prepared_lines == lines && prepared_own == own) return 1;
+
+    memory_random_teardown();
+    prepared_base = own ? (uint8_t*)page_alloc(lines * LINE_BYTES, PAGE_HUGE, NULL)
+                        : (uint8_t*)arena_alloc(lines * LINE_BYTES);
+    if (!prepared_base) return 0;
+    build_chain(prepared_base, lines);
+    prepared_lines = lines;
+    prepared_own = own;
+    prepared_gen = arena_generation();
+    return 1;
+}
+
+double memory_random_mops_once(void) {
+    if (!memory_random_prepare()) return 0.0;
+    // Time-boxed samples may shorten the lap, never below MIN_LOADS
+    size_t loads = (size_t)((double)CHASE_LOADS * suite_work_fraction());
+    if (loads < MIN_LOADS) loads = MIN_LOADS;
+    const double ns = chase_ns(prepared_base, prepared_lines, loads);
+
+    // Million dependent loads per second (1000 / MOPS = ns per access)
+    return (ns > 0.0) ? (1e3 / ns) : 0.0;
+}
+
+static void size_label(char* out, size_t n, size_t bytes) {
+    if (bytes < (1ull << 20))      snprintf(out, n, "%zuK", bytes >> 10);
+    else if (bytes < (1ull << 30)) snprintf(out, n, "%gM", (double)bytes / (1 << 20));
+    else                           snprintf(out, n, "%gG", (double)bytes / (1 << 30));
+}
+
+int memory_latency_sweep(SweepPoint* out, int cap) {
+    const BenchConfig* cfg = bench_config_defaults();
+    int count = 0;
+
+    // Two points per octave (2^k and 1.5 * 2^k) to locate each cache/TLB cliff
+    for (size_t pow2 = MIN_BYTES; pow2 <= cfg->latency_max_bytes && count < cap; pow2 *= 2) {
+        const size_t sizes[2] = { pow2, pow2 + pow2 / 2 };
+        for (int k = 0; k < 2 && count < cap; ++k) {
+            if (sizes[k] > cfg->latency_max_bytes) break;
+            SweepPoint* pt = &out[count++];
+            size_label(pt->label, sizeof(pt->label), sizes[k]);
+            pt->x = (double)sizes[k];
+            pt->value = memory_latency_ns(sizes[k], cfg->latency_hugepages);
+            pt->threads = 1;
+        }
+    }
+    return count;
+}
@@ -1,84 +1,234 @@
+#include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include "timer.h"
 #include "config.h"
-#include <stdint.h>
 #include "memory_triad.h"
+#include "threadpool.h"
+#include "pagemem.h"
+#include "numa_nodes.h"
+#include "sysinfo.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAVE_STREAM_STORES 1
+#endif
+
+// STREAM kernels, all writing A:
+//   COPY  A = B          SCALE A = s*B
+//   ADD   A = B + C      TRIAD A = B + s*C
+typedef enum { K_COPY, K_SCALE, K_ADD, K_TRIAD } StreamKernel;
+
+// Arrays touched per element (reads + the write), as STREAM counts them
+static const int kernel_arrays[] = { 2, 2, 3, 3 };
+
+typedef struct {
+    StreamKernel kind;
+    float* A;
+    float* B;
+    float* C;
+    size_t N;
+    int    nt;          // non-temporal stores for A
+    const int* init_cpus;  // optional pinning for the init phase (NUMA placement)
+    int    init_ncpus;
+    const int* run_cpus;   // optional pinning for the timed phase
+    int    run_ncpus;
+    int    init;        // fill the arrays (threaded, each thread its own slice)
+    int    run;         // run the timed kernel
+} StreamJob;
+
+#define STREAM_LOOP(EXPR) \
+    for (size_t i = begin; i < end; ++i) A[i] = (EXPR)
+
+#ifdef HAVE_STREAM_STORES
+// Scalar head up to 16-byte alignment, streaming body, scalar tail
+#define STREAM_LOOP_NT(VEXPR, EXPR) do {                                   \
+        size_t i = begin;                                                  \
+        for (; i < end && ((uintptr_t)(A + i) & 15u); ++i) A[i] = (EXPR);  \
+        for (; i + 4 <= end; i += 4) _mm_stream_ps(A + i, (VEXPR));        \
+        for (; i < end; ++i) A[i] = (EXPR);                                \
+        _mm_sfence();                                                      \
+    } while (0)
+#endif
+
+static void stream_kernel(const StreamJob* job, size_t begin, size_t end) {
+    float* A = job->A;
+    const float* B = job->B;
+    const float* C = job->C;
+    const float s = 2.0f;
 
-// for fast deterministic pseudo-random numbers
-static inline uint32_t fast_rand(uint32_t* seed) {
-    *seed = *seed * 1103515245 + 12345;
-    return (*seed / 65536) % 32768;
+#ifdef HAVE_STREAM_STORES
+    if (job->nt) {
+        const __m128 vs = _mm_set1_ps(s);
+        switch (job->kind) {
+        case K_COPY:  STREAM_LOOP_NT(_mm_loadu_ps(B + i), B[i]); break;
+        case K_SCALE: STREAM_LOOP_NT(_mm_mul_ps(vs, _mm_loadu_ps(B + i)), s * B[i]); break;
+        case K_ADD:   STREAM_LOOP_NT(_mm_add_ps(_mm_loadu_ps(B + i), _mm_loadu_ps(C + i)), B[i] + C[i]); break;
+        case K_TRIAD: STREAM_LOOP_NT(_mm_add_ps(_mm_loadu_ps(B + i), _mm_mul_ps(vs, _mm_loadu_ps(C + i))), B[i] + s * C[i]); break;
+        }
+        return;
+    }
+#endif
+
+    switch (job->kind) {
+    case K_COPY:  STREAM_LOOP(B[i]); break;
+    case K_SCALE: STREAM_LOOP(s * B[i]); break;
+    case K_ADD:   STREAM_LOOP(B[i] + C[i]); break;
+    case K_TRIAD: STREAM_LOOP(B[i] + s * C[i]); break;
+    }
 }
 
-double memory_random_mops_once(void) {
-    const BenchConfig* cfg = bench_config_defaults();
-    const size_t N = cfg->triad_N; // Use same array size
+static void stream_worker(int tid, int nthreads, void* arg) {
+    const StreamJob* job = (const StreamJob*)arg;
+    const size_t begin = job->N * (size_t)tid / (size_t)nthreads;
+    const size_t end = job->N * (size_t)(tid + 1) / (size_t)nthreads;
+
+    // The thread that streams a slice also fills it. The arrays are fresh
+    // mappings, so this is the first touch: pages land on the node of the thread
+    // (of init_cpus in the NUMA sweep)
+    if (job->init_cpus) pool_pin_self(job->init_cpus[tid % job->init_ncpus]);
+    if (job->init) {
+        for (size_t i = begin; i < end; ++i) {
+            job->A[i] = 0.0f;
+            job->B[i] = (float)((i % 251) * 0.01f);
+            job->C[i] = (float)(((i * 5) % 233) * 0.01f);
+        }
+    }
+    if (!job->run) return;
+    if (job->run_cpus) {
+        pool_sync();   // all pages placed before anyone migrates
+        pool_pin_self(job->run_cpus[tid % job->run_ncpus]);
+    }
+
+    pool_timed_begin(tid);
+    stream_kernel(job, begin, end);
+    const double bytes = (double)(end - begin) * kernel_arrays[job->kind] * sizeof(float);
+    pool_timed_end(tid, bytes / (1024.0 * 1024.0));
 
-    // We allocate a large array of "indices" to jump around
-    uint32_t* indices = (uint32_t*)malloc(N * sizeof(uint32_t));
-    float* data = (float*)malloc(N * sizeof(float));
+    if (job->init_cpus || job->run_cpus) pool_pin_self(-1);
+}
 
-    if (!indices || !data) { free(indices); free(data); return 0.0; }
+// NUMA placement pass: page-level allocation (no touch), pinned threaded init, timed kernel
+static double stream_run(StreamJob* job) {
+    const size_t bytes = job->N * sizeof(float);
 
-    // Pre-compute random jump pattern (Pointer Chasing setup)
-    // We create a cycle so we can just do index = indices[index]
-    // For simplicity here, we just fill random indices
-    uint32_t seed = 42;
-    for (size_t i = 0; i < N; ++i) {
-        indices[i] = fast_rand(&seed) % (uint32_t)N;
-        data[i] = (float)i;
+    job->A = (float*)page_alloc(bytes, PAGE_SMALL, NULL);
+    job->B = (float*)page_alloc(bytes, PAGE_SMALL, NULL);
+    job->C = (float*)page_alloc(bytes, PAGE_SMALL, NULL);
+    if (!job->A || !job->B || !job->C) {
+        page_free(job->A, bytes); page_free(job->B, bytes); page_free(job->C, bytes);
+        return 0.0;
     }
 
-    // Timed Random Access
-    timer_start();
-    volatile float sum = 0.0f;
-    size_t idx = 0;
-
-    // We do N accesses
-    for (size_t i = 0; i < N; ++i) {
-        // Jump to a random location determined by pre-calc table
-        // This stresses latency because CPU cannot predict 'indices[i]' easily
-        idx = indices[i];
-        sum += data[idx];
-    }
-    double dt = timer_elapsed_seconds();
+    job->init = 1;
+    job->run = 1;
+    pool_run(stream_worker, job);
+
+    // Prevent optimization
+    volatile float sink = job->A[job->N / 2]; (void)sink;
 
-    free(indices); free(data);
+    page_free(job->A, bytes); page_free(job->B, bytes); page_free(job->C, bytes);
+    return pool_last_stats(NULL);  // MB/s (MiB/s)
+}
 
-    // Result in Millions of Operations Per Second (MOPS)
-    // This is a proxy for Latency. (1/MOPS = avg latency in microseconds)
-    return ((double)N / dt) / 1e6;
+// The arrays live for one test at one team size; the kernels only write A, so
+// repetitions need no re-initialization. They are mapped here rather than taken
+// from the arena, which prefaults on the main thread and would put every page
+// on its node before the team's first touch.
+static StreamJob prepared;
+static size_t    prepared_bytes;
+
+static void prepared_free(void) {
+    page_free(prepared.A, prepared_bytes);
+    page_free(prepared.B, prepared_bytes);
+    page_free(prepared.C, prepared_bytes);
+    prepared.A = prepared.B = prepared.C = NULL;
+    prepared_bytes = 0;
 }
 
-double memory_mbps_once(void) {
+int memory_prepare(void) {
     const BenchConfig* cfg = bench_config_defaults();
     const size_t N = cfg->triad_N;
-
-    float* A = (float*)malloc(N * sizeof(float));
-    float* B = (float*)malloc(N * sizeof(float));
-    float* C = (float*)malloc(N * sizeof(float));
-    if (!A || !B || !C) { free(A); free(B); free(C); return 0.0; }
-
-    // Init (outside timing)
-    for (size_t i = 0; i < N; ++i) {
-        B[i] = (float)((i % 251) * 0.01f);
-        C[i] = (float)(((i * 5) % 233) * 0.01f);
+    if (prepared.A && prepared.N == N) return 1;
+    prepared_free();
+
+    // Below ~4x the combined LLC part of every pass hits cache instead of DRAM.
+    // Said once per size, not by every STREAM row and thread-sweep step.
+    static size_t warned_N;
+    const SystemInfo* si = sysinfo_get();
+    const size_t llc = si->llc_bytes * (size_t)(si->llc_instances > 0 ? si->llc_instances : 1);
+    if (3 * N * sizeof(float) < 4 * llc && warned_N != N) {
+        warned_N = N;
+        fprintf(stderr, "[MEM] arrays total %zu MB, under 4x the last-level cache (%zu MB); raise triad_N for DRAM bandwidth\n",
+            (3 * N * sizeof(float)) >> 20, llc >> 20);
     }
-    const float s = 2.0f;
 
-    // Time one streaming pass: A = B + s*C
-    timer_start();
-    for (size_t i = 0; i < N; ++i) {
-        A[i] = B[i] + s * C[i];
+    memset(&prepared, 0, sizeof(prepared));
+    const int kind = cfg->arena_hugepages ? PAGE_HUGE : PAGE_SMALL;
+    prepared.N = N;
+    prepared_bytes = N * sizeof(float);
+    prepared.A = (float*)page_alloc(prepared_bytes, kind, NULL);
+    prepared.B = (float*)page_alloc(prepared_bytes, kind, NULL);
+    prepared.C = (float*)page_alloc(prepared_bytes, kind, NULL);
+    if (!prepared.A || !prepared.B || !prepared.C) {
+        prepared_free();
+        return 0;
     }
-    double dt = timer_elapsed_seconds();
+
+    prepared.init = 1;
+    pool_run(stream_worker, &prepared);
+    prepared.init = 0;
+    prepared.run = 1;
+    return 1;
+}
+
+void memory_teardown(void) { prepared_free(); }
+
+static double stream_once(StreamKernel kind) {
+    if (!memory_prepare()) return 0.0;
+    prepared.kind = kind;
+    prepared.nt = bench_config_defaults()->stream_nt_stores;
+    pool_run(stream_worker, &prepared);
 
     // Prevent optimization
-    volatile float sink = A[0]; (void)sink;
+    volatile float sink = prepared.A[prepared.N / 2]; (void)sink;
+    return pool_last_stats(NULL);  // MB/s (MiB/s)
+}
 
-    free(A); free(B); free(C);
+double memory_copy_mbps_once(void)  { return stream_once(K_COPY); }
+double memory_scale_mbps_once(void) { return stream_once(K_SCALE); }
+double memory_add_mbps_once(void)   { return stream_once(K_ADD); }
+double memory_mbps_once(void)       { return stream_once(K_TRIAD); }
+
+int memory_numa_sweep(SweepPoint* out, int cap) {
+    const BenchConfig* cfg = bench_config_defaults();
+    int count = 0, nn = 0;
+    const NumaNode* nodes = numa_nodes(&nn);
+    const int saved_team = pool_team();
+
+    // Triad with every thread of CPU node c streaming memory first-touched on node m
+    for (int c = 0; c < nn; ++c) {
+        for (int m = 0; m < nn && count < cap; ++m) {
+            StreamJob job = { 0 };
+            job.kind = K_TRIAD;
+            job.N = cfg->triad_N;
+            job.nt = cfg->stream_nt_stores;
+            job.init_cpus = nodes[m].cpus;
+            job.init_ncpus = nodes[m].ncpus;
+            job.run_cpus = nodes[c].cpus;
+            job.run_ncpus = nodes[c].ncpus;
+
+            pool_set_team(nodes[c].ncpus);
+            SweepPoint* pt = &out[count++];
+            snprintf(pt->label, sizeof(pt->label), "C%dM%d%s", nodes[c].id, nodes[m].id,
+                (c == m) ? "_LOCAL" : "_REMOTE");
+            pt->x = (double)(c * nn + m);
+            pt->value = stream_run(&job);
+            pt->threads = pool_team();
+        }
+    }
 
-    // Bytes moved: read B + read C + write A (3 arrays)
-    const double bytes = (double)N * 3.0 * sizeof(float);
-    return (bytes / dt) / (1024.0 * 1024.0);  // MB/s (MiB/s)
+    pool_set_team(saved_team);
+    return count;
 }
@@ -0,0 +1,151 @@
+#include "perf_counters.h"
+#include <string.h>
+#include "timer.h"
+
+static int enabled = 1;
+
+// LINUX IMPLEMENTATION
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+typedef struct { uint32_t type; uint64_t config; } EventSpec;
+
+#define CACHE_MISS(c) ((c) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const EventSpec SPEC[PERF_EVENT_COUNT] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HW_CACHE, CACHE_MISS(PERF_COUNT_HW_CACHE_DTLB) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+};
+
+// Per-thread group, opened on the thread's first region and kept for its lifetime.
+// Pool workers are persistent, so this happens once per worker.
+typedef struct {
+    int    state;                       // 0 = not tried, 1 = open, -1 = unavailable
+    int    fd[PERF_EVENT_COUNT];        // -1 where the event failed to open
+    int    slot[PERF_EVENT_COUNT];      // position in the group read, -1 if absent
+    int    nopen;
+    int    active;                      // inside a region (end may be reached twice)
+    double t0;
+} ThreadGroup;
+
+static _Thread_local ThreadGroup tg;
+
+static int      probe_state = -1;       // -1 = not probed
+static int      event_valid[PERF_EVENT_COUNT];
+static uint64_t tot_count[PERF_EVENT_COUNT];
+static uint64_t tot_ns;
+
+static int open_event(const EventSpec* e, int group_fd) {
+    struct perf_event_attr a;
+    memset(&a, 0, sizeof(a));
+    a.size = sizeof(a);
+    a.type = e->type;
+    a.config = e->config;
+    a.disabled = (group_fd == -1);      // the leader gates the whole group
+    a.exclude_kernel = 1;               // allowed at perf_event_paranoid 2
+    a.exclude_hv = 1;
+    a.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(__NR_perf_event_open, &a, 0, -1, group_fd, 0);
+}
+
+static void group_open(ThreadGroup* g) {
+    g->state = -1;
+    g->nopen = 0;
+    for (int i = 0; i < PERF_EVENT_COUNT; ++i) { g->fd[i] = -1; g->slot[i] = -1; }
+
+    // Cycles lead the group: without them there is nothing useful to report
+    g->fd[PERF_CYCLES] = open_event(&SPEC[PERF_CYCLES], -1);
+    if (g->fd[PERF_CYCLES] < 0) return;
+    g->slot[PERF_CYCLES] = g->nopen++;
+    for (int i = 1; i < PERF_EVENT_COUNT; ++i) {
+        g->fd[i] = open_event(&SPEC[i], g->fd[PERF_CYCLES]);
+        if (g->fd[i] >= 0) g->slot[i] = g->nopen++;
+    }
+    g->state = 1;
+}
+
+int perf_available(void) {
+    if (probe_state < 0) {
+        ThreadGroup g;
+        group_open(&g);
+        probe_state = (g.state == 1);
+        for (int i = 0; i < PERF_EVENT_COUNT; ++i) {
+            event_valid[i] = (g.fd[i] >= 0);
+            if (g.fd[i] >= 0) close(g.fd[i]);
+        }
+    }
+    return probe_state;
+}
+
+void perf_region_begin(void) {
+    if (!enabled) return;
+    if (tg.state == 0) group_open(&tg);
+    tg.t0 = timer_now_seconds();
+    if (tg.state != 1) return;
+    tg.active = 1;
+    ioctl(tg.fd[PERF_CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(tg.fd[PERF_CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void perf_region_end(void) {
+    if (!enabled || tg.state != 1 || !tg.active) return;
+    tg.active = 0;
+    ioctl(tg.fd[PERF_CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    const double dt = timer_now_seconds() - tg.t0;
+
+    // { nr, time_enabled, time_running, value[nr] }
+    uint64_t buf[3 + PERF_EVENT_COUNT];
+    if (read(tg.fd[PERF_CYCLES], buf, sizeof(buf)) < (ssize_t)(3 * sizeof(uint64_t))) return;
+    const double scale = (buf[2] > 0) ? (double)buf[1] / (double)buf[2] : 0.0;   // multiplexing
+    for (int i = 0; i < PERF_EVENT_COUNT; ++i) {
+        if (tg.slot[i] < 0 || (uint64_t)tg.slot[i] >= buf[0]) continue;
+        __atomic_fetch_add(&tot_count[i], (uint64_t)((double)buf[3 + tg.slot[i]] * scale), __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_add(&tot_ns, (uint64_t)(dt * 1e9), __ATOMIC_RELAXED);
+}
+
+void perf_reset_totals(void) {
+    memset(tot_count, 0, sizeof(tot_count));
+    tot_ns = 0;
+}
+
+void perf_read_totals(PerfTotals* out) {
+    memset(out, 0, sizeof(*out));
+    if (!perf_available()) return;
+    for (int i = 0; i < PERF_EVENT_COUNT; ++i) {
+        out->count[i] = __atomic_load_n(&tot_count[i], __ATOMIC_RELAXED);
+        out->valid[i] = event_valid[i];
+    }
+    out->thread_seconds = (double)__atomic_load_n(&tot_ns, __ATOMIC_RELAXED) / 1e9;
+}
+
+// OTHER PLATFORMS: no user-space counter API we can rely on
+#else
+int  perf_available(void) { return 0; }
+void perf_region_begin(void) {}
+void perf_region_end(void) {}
+void perf_reset_totals(void) {}
+void perf_read_totals(PerfTotals* out) { memset(out, 0, sizeof(*out)); }
+#endif
+
+void perf_set_enabled(int on) { enabled = on; }
+
+void perf_summarize(const PerfTotals* t, PerfSummary* out) {
+    memset(out, 0, sizeof(*out));
+    const double cyc = (double)t->count[PERF_CYCLES];
+    const double ins = (double)t->count[PERF_INSTRUCTIONS];
+    if (!t->valid[PERF_CYCLES] || !t->valid[PERF_INSTRUCTIONS] || cyc <= 0.0 || ins <= 0.0) return;
+
+    out->valid = 1;
+    out->ipc = ins / cyc;
+    out->ghz = (t->thread_seconds > 0.0) ? cyc / t->thread_seconds / 1e9 : 0.0;
+    out->llc_mpki = t->valid[PERF_LLC_MISSES] ? 1000.0 * (double)t->count[PERF_LLC_MISSES] / ins : -1.0;
+    out->dtlb_mpki = t->valid[PERF_DTLB_MISSES] ? 1000.0 * (double)t->count[PERF_DTLB_MISSES] / ins : -1.0;
+    out->branch_mpki = t->valid[PERF_BRANCH_MISSES] ? 1000.0 * (double)t->count[PERF_BRANCH_MISSES] / ins : -1.0;
+}
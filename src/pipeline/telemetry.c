@@ -0,0 +1,521 @@
+#include "telemetry.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timer.h"
+
+// A sample this far under the test's fastest one ran throttled
+#define THROTTLE_DROP 0.90
+
+// LINUX IMPLEMENTATION
+#if defined(__linux__)
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "topology.h"
+#include "sysinfo.h"
+
+#define MAX_TEMPS 8
+#define MAX_RAPL  16
+
+// RAPL energy status registers and the unit register (energy unit in bits 12:8)
+#define MSR_RAPL_POWER_UNIT     0x606
+#define MSR_PKG_ENERGY_STATUS   0x611
+#define MSR_DRAM_ENERGY_STATUS  0x619
+#define MSR_AMD_RAPL_POWER_UNIT 0xC0010299u
+#define MSR_AMD_PKG_ENERGY      0xC001029Bu
+
+typedef struct {
+    int                fd;              // powercap energy_uj, or /dev/cpu/N/msr
+    unsigned           msr;             // register to read; 0 = powercap text attribute
+    int                dram;            // DRAM domain, else package
+    double             uj_per_count;    // 1 for powercap, the RAPL energy unit for MSRs
+    unsigned long long last;            // previous raw reading
+    unsigned long long range;           // raw value where the counter wraps
+} RaplDomain;
+
+// Sysfs attributes stay open; each reading is a pread from offset 0
+static int        freq_fd[TOPO_MAX_CPUS];
+static int        freq_cpu[TOPO_MAX_CPUS];
+static int        nfreq;
+static int        temp_fd[MAX_TEMPS];
+static int        ntemp;
+static RaplDomain rapl[MAX_RAPL];
+static int        nrapl;
+static int        have_pkg, have_dram;
+static int        throttle_fd[TOPO_MAX_CPUS];
+static int        nthrottle;
+static char       sources[128];
+
+static pthread_t       sampler;
+static pthread_mutex_t mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  wake = PTHREAD_COND_INITIALIZER;
+static int             running = 0;
+static int             sampling = 0;    // sampler thread started
+static int             stopping = 0;
+static int             interval_ms = 0;
+
+// Watched CPUs as indices into freq_fd; none = the fastest `busy` CPUs
+static int watch_idx[TOPO_MAX_CPUS];
+static int nwatch = 0;
+static int busy = 1;
+
+// Open window, under mtx
+static int             in_window = 0;
+static TelemetryWindow win;
+static double          win_t0;
+static double          mhz_sum;
+static int             mhz_ticks;
+static long            throttle0;
+
+static int read_u64(int fd, unsigned long long* out) {
+    char buf[32];
+    const ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) return 0;
+    buf[n] = '\0';
+    *out = strtoull(buf, NULL, 10);
+    return 1;
+}
+
+static int open_attr(const char* path) {
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    unsigned long long v;
+    if (fd >= 0 && !read_u64(fd, &v)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int read_name(const char* path, char* out, size_t n) {
+    FILE* f = fopen(path, "r");
+    if (!f) return 0;
+    const int ok = fgets(out, (int)n, f) != NULL;
+    fclose(f);
+    if (ok) out[strcspn(out, "\n")] = '\0';
+    return ok;
+}
+
+static int cmp_desc(const void* a, const void* b) {
+    const double x = *(const double*)a, y = *(const double*)b;
+    return (x < y) - (x > y);
+}
+
+static double read_clock_mhz(void) {
+    double khz[TOPO_MAX_CPUS];
+    int n = 0;
+    unsigned long long v;
+    if (nwatch > 0) {
+        for (int i = 0; i < nwatch && i < busy; ++i) {
+            if (read_u64(freq_fd[watch_idx[i]], &v) && v > 0) khz[n++] = (double)v;
+        }
+    } else {
+        for (int i = 0; i < nfreq; ++i) {
+            if (read_u64(freq_fd[i], &v) && v > 0) khz[n++] = (double)v;
+        }
+        qsort(khz, (size_t)n, sizeof(double), cmp_desc);
+        if (n > busy) n = busy;
+    }
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i) sum += khz[i];
+    return n > 0 ? sum / n / 1000.0 : -1.0;
+}
+
+// Millidegrees in sysfs
+static double read_temp_c(void) {
+    double hottest = -1.0;
+    unsigned long long v;
+    for (int i = 0; i < ntemp; ++i) {
+        if (read_u64(temp_fd[i], &v) && (double)v / 1000.0 > hottest) hottest = (double)v / 1000.0;
+    }
+    return hottest;
+}
+
+static int read_energy(const RaplDomain* r, unsigned long long* out) {
+    if (!r->msr) return read_u64(r->fd, out);
+    uint64_t v;
+    if (pread(r->fd, &v, sizeof(v), (off_t)r->msr) != (ssize_t)sizeof(v)) return 0;
+    *out = v & 0xffffffffu;             // 32-bit counter
+    return 1;
+}
+
+// Package and DRAM microjoules since the previous call, wrap-corrected
+static void energy_delta_uj(double* pkg, double* dram) {
+    unsigned long long v;
+    *pkg = *dram = 0.0;
+    for (int i = 0; i < nrapl; ++i) {
+        RaplDomain* r = &rapl[i];
+        if (!read_energy(r, &v)) continue;
+        double counts = 0.0;
+        if (v >= r->last) counts = (double)(v - r->last);
+        else if (r->range > r->last) counts = (double)(v + r->range - r->last);
+        r->last = v;
+        *(r->dram ? dram : pkg) += counts * r->uj_per_count;
+    }
+}
+
+static long read_throttle(void) {
+    long sum = 0;
+    unsigned long long v;
+    for (int i = 0; i < nthrottle; ++i) {
+        if (read_u64(throttle_fd[i], &v)) sum += (long)v;
+    }
+    return sum;
+}
+
+// One reading into the open window; called with mtx held
+static void take_reading(void) {
+    double pkg_uj, dram_uj;
+    energy_delta_uj(&pkg_uj, &dram_uj);
+    if (!in_window) return;
+    const double mhz = nfreq > 0 ? read_clock_mhz() : -1.0;
+    const double temp = read_temp_c();
+    win.ticks++;
+    if (mhz > 0.0) {
+        mhz_sum += mhz;
+        mhz_ticks++;
+        if (win.mhz_min < 0.0 || mhz < win.mhz_min) win.mhz_min = mhz;
+    }
+    if (temp > win.temp_c) win.temp_c = temp;
+    if (have_pkg) win.pkg_joules += pkg_uj * 1e-6;
+    if (have_dram) win.dram_joules += dram_uj * 1e-6;
+}
+
+static void* sampler_main(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&mtx);
+    while (!stopping) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += (long)(interval_ms % 1000) * 1000000L;
+        ts.tv_sec += interval_ms / 1000 + ts.tv_nsec / 1000000000L;
+        ts.tv_nsec %= 1000000000L;
+        (void)pthread_cond_timedwait(&wake, &mtx, &ts);
+        // Between windows only the energy counters are read, so they never wrap unseen
+        if (!stopping) take_reading();
+    }
+    pthread_mutex_unlock(&mtx);
+    return NULL;
+}
+
+static void add_source(const char* name) {
+    const size_t len = strlen(sources);
+    snprintf(sources + len, sizeof(sources) - len, "%s%s", len ? ", " : "", name);
+}
+
+// Package sensors first; ACPI's board zone only when there is nothing better
+static void discover_temps(void) {
+    static const char* HWMON[] = { "coretemp", "k10temp", "zenpower", "cpu_thermal", "soc_thermal" };
+    static const char* ZONES[] = { "x86_pkg_temp", "cpu-thermal", "cpu_thermal", "soc_thermal", "acpitz" };
+    char path[128], name[64];
+    for (int h = 0; h < 64 && ntemp < MAX_TEMPS; ++h) {
+        snprintf(path, sizeof(path), "/sys/class/hwmon/hwmon%d/name", h);
+        if (!read_name(path, name, sizeof(name))) continue;
+        for (size_t k = 0; k < sizeof(HWMON) / sizeof(HWMON[0]); ++k) {
+            if (strcmp(name, HWMON[k]) != 0) continue;
+            snprintf(path, sizeof(path), "/sys/class/hwmon/hwmon%d/temp1_input", h);
+            const int fd = open_attr(path);
+            if (fd < 0) break;
+            if (ntemp == 0) add_source(name);
+            temp_fd[ntemp++] = fd;
+            break;
+        }
+    }
+    for (size_t k = 0; k < sizeof(ZONES) / sizeof(ZONES[0]) && ntemp == 0; ++k) {
+        for (int z = 0; z < 64 && ntemp < MAX_TEMPS; ++z) {
+            snprintf(path, sizeof(path), "/sys/class/thermal/thermal_zone%d/type", z);
+            if (!read_name(path, name, sizeof(name)) || strcmp(name, ZONES[k]) != 0) continue;
+            snprintf(path, sizeof(path), "/sys/class/thermal/thermal_zone%d/temp", z);
+            const int fd = open_attr(path);
+            if (fd < 0) continue;
+            if (ntemp == 0) add_source(name);
+            temp_fd[ntemp++] = fd;
+        }
+    }
+}
+
+static void add_rapl(int fd, unsigned msr, int dram, double uj_per_count, unsigned long long range) {
+    if (nrapl == MAX_RAPL) {
+        close(fd);
+        return;
+    }
+    RaplDomain* r = &rapl[nrapl];
+    r->fd = fd;
+    r->msr = msr;
+    r->dram = dram;
+    r->uj_per_count = uj_per_count;
+    r->range = range;
+    if (!read_energy(r, &r->last)) {
+        close(fd);
+        return;
+    }
+    nrapl++;
+    if (dram) have_dram = 1;
+    else have_pkg = 1;
+}
+
+// Top-level powercap zones are the packages, their "dram" subzones the memory
+// (energy_uj is root-only on newer kernels)
+static void discover_powercap(void) {
+    char path[128], name[64];
+    for (int d = 0; d < MAX_RAPL; ++d) {
+        for (int sub = -1; sub < 4; ++sub) {
+            char zone[48];
+            if (sub < 0) snprintf(zone, sizeof(zone), "/sys/class/powercap/intel-rapl:%d", d);
+            else snprintf(zone, sizeof(zone), "/sys/class/powercap/intel-rapl:%d:%d", d, sub);
+            snprintf(path, sizeof(path), "%s/name", zone);
+            if (!read_name(path, name, sizeof(name))) {
+                if (sub < 0) break;
+                continue;
+            }
+            const int dram = strcmp(name, "dram") == 0;
+            if (!dram && strncmp(name, "package", 7) != 0) continue;
+            snprintf(path, sizeof(path), "%s/energy_uj", zone);
+            const int fd = open_attr(path);
+            if (fd < 0) continue;
+            unsigned long long range = 0;
+            snprintf(path, sizeof(path), "%s/max_energy_range_uj", zone);
+            const int rfd = open_attr(path);
+            if (rfd >= 0) {
+                (void)read_u64(rfd, &range);
+                close(rfd);
+            }
+            add_rapl(fd, 0, dram, 1.0, range);
+        }
+    }
+}
+
+// Without the powercap driver: the MSRs through the msr module, one CPU per package
+static void discover_msr(void) {
+    const Topology* t = topology_get();
+    const char* vendor = sysinfo_get()->cpu_vendor;
+    const int amd = strcmp(vendor, "AuthenticAMD") == 0 || strcmp(vendor, "HygonGenuine") == 0;
+    if (!amd && strcmp(vendor, "GenuineIntel") != 0) return;
+    int pkg_seen[TOPO_MAX_CPUS], npkg = 0;
+    char path[64];
+    for (int k = 0; k < t->ncpus; ++k) {
+        int seen = 0;
+        for (int p = 0; p < npkg; ++p) seen |= pkg_seen[p] == t->cpus[k].package;
+        if (seen) continue;
+        pkg_seen[npkg++] = t->cpus[k].package;
+
+        snprintf(path, sizeof(path), "/dev/cpu/%d/msr", t->cpus[k].cpu);
+        const int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+        uint64_t unit;
+        if (pread(fd, &unit, sizeof(unit), amd ? MSR_AMD_RAPL_POWER_UNIT : MSR_RAPL_POWER_UNIT) != (ssize_t)sizeof(unit)) {
+            close(fd);
+            return;
+        }
+        const double uj = 1e6 / (double)(1ull << ((unit >> 8) & 0x1f));
+        add_rapl(fd, amd ? MSR_AMD_PKG_ENERGY : MSR_PKG_ENERGY_STATUS, 0, uj, 1ull << 32);
+        // DRAM (Intel servers) shares the package's unit here; some parts use a fixed 15.3 uJ
+        if (!amd) {
+            const int dfd = open(path, O_RDONLY | O_CLOEXEC);
+            if (dfd >= 0) add_rapl(dfd, MSR_DRAM_ENERGY_STATUS, 1, uj, 1ull << 32);
+        }
+    }
+}
+
+static void discover_rapl(void) {
+    have_pkg = have_dram = 0;
+    discover_powercap();
+    const int powercap = nrapl > 0;
+    if (!powercap) discover_msr();
+    if (nrapl == 0) return;
+    add_source(powercap ? "RAPL powercap" : "RAPL MSR");
+    if (have_dram) add_source("DRAM");
+}
+
+static void discover(int sample, int energy) {
+    const Topology* t = topology_get();
+    char path[128];
+    sources[0] = '\0';
+    nfreq = ntemp = nrapl = nthrottle = 0;
+    if (energy) discover_rapl();
+    if (!sample) return;
+    for (int k = 0; k < t->ncpus; ++k) {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq", t->cpus[k].cpu);
+        const int fd = open_attr(path);
+        if (fd < 0) continue;
+        freq_cpu[nfreq] = t->cpus[k].cpu;
+        freq_fd[nfreq++] = fd;
+    }
+    if (nfreq > 0) add_source("cpufreq");
+    discover_temps();
+
+    // Intel: per-core counts plus one package count per package
+    int pkg_seen[TOPO_MAX_CPUS], npkg = 0;
+    for (int k = 0; k < t->ncpus && nthrottle < TOPO_MAX_CPUS; ++k) {
+        const TopoCpu* c = &t->cpus[k];
+        if (c->smt != 0) continue;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/thermal_throttle/core_throttle_count", c->cpu);
+        int fd = open_attr(path);
+        if (fd >= 0) throttle_fd[nthrottle++] = fd;
+        int seen = 0;
+        for (int p = 0; p < npkg; ++p) seen |= pkg_seen[p] == c->package;
+        if (seen || nthrottle >= TOPO_MAX_CPUS) continue;
+        pkg_seen[npkg++] = c->package;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/thermal_throttle/package_throttle_count", c->cpu);
+        fd = open_attr(path);
+        if (fd >= 0) throttle_fd[nthrottle++] = fd;
+    }
+    if (nthrottle > 0) add_source("throttle counts");
+}
+
+static void close_all(void) {
+    for (int i = 0; i < nfreq; ++i) close(freq_fd[i]);
+    for (int i = 0; i < ntemp; ++i) close(temp_fd[i]);
+    for (int i = 0; i < nrapl; ++i) close(rapl[i].fd);
+    for (int i = 0; i < nthrottle; ++i) close(throttle_fd[i]);
+    nfreq = ntemp = nrapl = nthrottle = 0;
+}
+
+int telemetry_start(int ms, int energy) {
+    if (running) telemetry_stop();
+    discover(ms > 0, energy);
+    if (nfreq + ntemp + nrapl + nthrottle == 0) {
+        close_all();
+        return 0;
+    }
+    interval_ms = ms;
+    stopping = 0;
+    in_window = 0;
+    // Energy alone is read at the window edges; the rest needs the sampler
+    sampling = nfreq + ntemp > 0 && pthread_create(&sampler, NULL, sampler_main, NULL) == 0;
+    if (!sampling && nrapl + nthrottle == 0) {
+        close_all();
+        return 0;
+    }
+    running = 1;
+    return 1;
+}
+
+void telemetry_stop(void) {
+    if (!running) return;
+    if (sampling) {
+        pthread_mutex_lock(&mtx);
+        stopping = 1;
+        pthread_cond_signal(&wake);
+        pthread_mutex_unlock(&mtx);
+        pthread_join(sampler, NULL);
+        sampling = 0;
+    }
+    close_all();
+    running = 0;
+}
+
+int telemetry_available(void) { return running; }
+
+const char* telemetry_sources(void) { return running ? sources : ""; }
+
+void telemetry_watch(const int* cpus, int n) {
+    pthread_mutex_lock(&mtx);
+    nwatch = 0;
+    for (int i = 0; i < n; ++i) {
+        for (int k = 0; k < nfreq; ++k) {
+            if (freq_cpu[k] == cpus[i]) watch_idx[nwatch++] = k;
+        }
+    }
+    pthread_mutex_unlock(&mtx);
+}
+
+void telemetry_window_begin(int threads) {
+    if (!running) return;
+    pthread_mutex_lock(&mtx);
+    busy = threads > 0 ? threads : 1;
+    memset(&win, 0, sizeof(win));
+    win.mhz = win.mhz_min = win.temp_c = -1.0;
+    win.pkg_joules = have_pkg ? 0.0 : -1.0;
+    win.dram_joules = have_dram ? 0.0 : -1.0;
+    mhz_sum = 0.0;
+    mhz_ticks = 0;
+    throttle0 = read_throttle();
+    double pkg_uj, dram_uj;
+    energy_delta_uj(&pkg_uj, &dram_uj); // energy counts from here
+    in_window = 1;
+    win_t0 = timer_now_seconds();
+    pthread_mutex_unlock(&mtx);
+}
+
+void telemetry_window_end(TelemetryWindow* out) {
+    memset(out, 0, sizeof(*out));
+    out->mhz = out->mhz_min = out->temp_c = out->pkg_joules = out->dram_joules = -1.0;
+    out->throttle_events = -1;
+    if (!running) return;
+    pthread_mutex_lock(&mtx);
+    const double t1 = timer_now_seconds();
+    take_reading();                     // short windows still get one reading
+    in_window = 0;
+    win.seconds = t1 - win_t0;
+    if (mhz_ticks > 0) win.mhz = mhz_sum / mhz_ticks;
+    win.throttle_events = nthrottle > 0 ? read_throttle() - throttle0 : -1;
+    win.valid = win.mhz > 0.0 || win.temp_c >= 0.0 || win.pkg_joules >= 0.0 || win.throttle_events >= 0;
+    *out = win;
+    pthread_mutex_unlock(&mtx);
+}
+
+// OTHER PLATFORMS: no sources
+#else
+int  telemetry_start(int ms, int energy) { (void)ms; (void)energy; return 0; }
+void telemetry_stop(void) {}
+int  telemetry_available(void) { return 0; }
+const char* telemetry_sources(void) { return ""; }
+void telemetry_watch(const int* cpus, int n) { (void)cpus; (void)n; }
+void telemetry_window_begin(int threads) { (void)threads; }
+void telemetry_window_end(TelemetryWindow* out) {
+    memset(out, 0, sizeof(*out));
+    out->mhz = out->mhz_min = out->temp_c = out->pkg_joules = out->dram_joules = -1.0;
+    out->throttle_events = -1;
+}
+#endif
+
+void telemetry_summarize(TelemetryWindow* w, int n, double median, TelemetrySummary* out) {
+    memset(out, 0, sizeof(*out));
+    out->mhz = out->mhz_min = out->temp_c = -1.0;
+    out->pkg_watts = out->dram_watts = out->work_per_joule = out->joules_per_work = -1.0;
+    out->n = n;
+    out->windows = w;
+
+    double best = 0.0;
+    for (int i = 0; i < n; ++i) {
+        if (w[i].valid && w[i].mhz > best) best = w[i].mhz;
+    }
+
+    double mhz_sum = 0.0, pkg_j = 0.0, pkg_s = 0.0, dram_j = 0.0, dram_s = 0.0;
+    int mhz_n = 0;
+    for (int i = 0; i < n; ++i) {
+        TelemetryWindow* s = &w[i];
+        s->throttled = 0;
+        if (!s->valid) continue;
+        out->valid = 1;
+        s->throttled = (s->mhz > 0.0 && s->mhz < THROTTLE_DROP * best) || s->throttle_events > 0;
+        out->throttled += s->throttled;
+        if (s->mhz > 0.0) {
+            mhz_sum += s->mhz;
+            mhz_n++;
+            if (out->mhz_min < 0.0 || s->mhz < out->mhz_min) out->mhz_min = s->mhz;
+        }
+        if (s->temp_c > out->temp_c) out->temp_c = s->temp_c;
+        if (s->pkg_joules >= 0.0) {
+            pkg_j += s->pkg_joules;
+            pkg_s += s->seconds;
+        }
+        if (s->dram_joules >= 0.0) {
+            dram_j += s->dram_joules;
+            dram_s += s->seconds;
+        }
+    }
+    if (mhz_n > 0) out->mhz = mhz_sum / mhz_n;
+    if (pkg_s > 0.0 && pkg_j > 0.0) out->pkg_watts = pkg_j / pkg_s;
+    if (dram_s > 0.0 && dram_j > 0.0) out->dram_watts = dram_j / dram_s;
+
+    // Work per joule = (work/s) / (J/s)
+    const double watts = out->pkg_watts + (out->dram_watts > 0.0 ? out->dram_watts : 0.0);
+    if (out->pkg_watts > 0.0 && median > 0.0) {
+        out->work_per_joule = median / watts;
+        out->joules_per_work = watts / median;
+    }
+}
@@ -0,0 +1,335 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE   // pthread_setaffinity_np
+#endif
+#include "threadpool.h"
+#include "timer.h"
+#include "perf_counters.h"
+#include <float.h>
+#include <stdint.h>
+
+// Minimal portability shim: one mutex and a few condition variables drive
+// job hand-off, completion and the start barrier.
+
+#if defined(_WIN32)
+#include <windows.h>
+typedef CRITICAL_SECTION   pool_mutex_t;
+typedef CONDITION_VARIABLE pool_cond_t;
+#define MUTEX_INIT(m)    InitializeCriticalSection(m)
+#define MUTEX_LOCK(m)    EnterCriticalSection(m)
+#define MUTEX_UNLOCK(m)  LeaveCriticalSection(m)
+#define COND_INIT(c)     InitializeConditionVariable(c)
+#define COND_WAIT(c, m)  SleepConditionVariableCS(c, m, INFINITE)
+#define COND_BCAST(c)    WakeAllConditionVariable(c)
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+typedef pthread_mutex_t pool_mutex_t;
+typedef pthread_cond_t  pool_cond_t;
+#define MUTEX_INIT(m)    pthread_mutex_init(m, NULL)
+#define MUTEX_LOCK(m)    pthread_mutex_lock(m)
+#define MUTEX_UNLOCK(m)  pthread_mutex_unlock(m)
+#define COND_INIT(c)     pthread_cond_init(c, NULL)
+#define COND_WAIT(c, m)  pthread_cond_wait(c, m)
+#define COND_BCAST(c)    pthread_cond_broadcast(c)
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define POOL_TLS __declspec(thread)
+#else
+#define POOL_TLS _Thread_local
+#endif
+
+// One job slot per group of workers. Group 0 is the default team starting at
+// worker 0; bound groups cover other worker ranges and run concurrently.
+typedef struct PoolGroup {
+    int          first;         // first worker index
+    int          width;         // workers the group owns; the team never exceeds it
+    int          team;          // workers used by pool_run
+    int          in_use;
+
+    PoolTask     job_fn;
+    void*        job_arg;
+    int          job_team;
+    int          job_done;
+    pool_cond_t  cv_done;
+
+    int          bar_count;
+    unsigned     bar_gen;
+    pool_cond_t  cv_bar;
+
+    int          pin[POOL_MAX_THREADS];       // CPU for team-local tid i % npin
+    int          npin;                        // 0 = workers float
+
+    double       t_begin[POOL_MAX_THREADS];   // by team-local tid
+    double       t_end[POOL_MAX_THREADS];
+    double       t_units[POOL_MAX_THREADS];
+    PoolStats    last;
+} PoolGroup;
+
+#define POOL_MAX_GROUPS 8
+
+static pool_mutex_t mtx;
+static pool_cond_t  cv_job;
+static int          initialized = 0;
+static unsigned char alive[POOL_MAX_THREADS];   // worker started at this index
+static PoolGroup    groups[POOL_MAX_GROUPS] = { [0] = { .first = 0, .width = POOL_MAX_THREADS, .team = 1, .in_use = 1 } };
+
+// Per-worker mailbox: a new generation hands the worker a group's job
+static unsigned     mail_gen[POOL_MAX_THREADS];
+static PoolGroup*   mail_group[POOL_MAX_THREADS];
+
+static POOL_TLS PoolGroup* bound;      // group for this thread's pool_run (NULL = default)
+static POOL_TLS PoolGroup* running;    // group whose task this worker is executing
+static POOL_TLS int        pinned = -1; // CPU this thread is pinned to (-1 = none, -2 = unknown)
+static int                 ever_pinned; // any thread was pinned since start-up
+
+#if defined(__linux__)
+static cpu_set_t proc_cpus;            // affinity at start-up (taskset, cpuset), restored on unpin
+static int       proc_cpus_ok;
+#endif
+
+static PoolGroup* current(void) { return bound ? bound : &groups[0]; }
+
+int pool_hw_threads(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    int n = (int)si.dwNumberOfProcessors;
+#else
+    int n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (n < 1) n = 1;
+    if (n > POOL_MAX_THREADS) n = POOL_MAX_THREADS;
+    return n;
+}
+
+static void worker_loop(int tid) {
+    unsigned seen = 0;
+    // Spawned by a pinned thread: the inherited mask is not ours to keep
+    if (ever_pinned) pinned = -2;
+    for (;;) {
+        MUTEX_LOCK(&mtx);
+        while (mail_gen[tid] == seen) COND_WAIT(&cv_job, &mtx);
+        seen = mail_gen[tid];
+        PoolGroup* g = mail_group[tid];
+        PoolTask fn = g->job_fn;
+        void* arg = g->job_arg;
+        int n = g->job_team;
+        const int want = g->npin ? g->pin[(tid - g->first) % g->npin] : -1;
+        MUTEX_UNLOCK(&mtx);
+
+        // Re-pinned only when the group's CPU map changed (or a task moved us)
+        if (want != pinned) pool_pin_self(want);
+        running = g;
+        fn(tid - g->first, n, arg);
+        running = NULL;
+
+        MUTEX_LOCK(&mtx);
+        if (++g->job_done == n) COND_BCAST(&g->cv_done);
+        MUTEX_UNLOCK(&mtx);
+    }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI worker_entry(LPVOID p) { worker_loop((int)(INT_PTR)p); return 0; }
+static int spawn_worker(int tid) {
+    HANDLE h = CreateThread(NULL, 0, worker_entry, (LPVOID)(INT_PTR)tid, 0, NULL);
+    if (!h) return 0;
+    CloseHandle(h);
+    return 1;
+}
+#else
+static void* worker_entry(void* p) { worker_loop((int)(intptr_t)p); return NULL; }
+static int spawn_worker(int tid) {
+    pthread_t th;
+    if (pthread_create(&th, NULL, worker_entry, (void*)(intptr_t)tid) != 0) return 0;
+    pthread_detach(th);
+    return 1;
+}
+#endif
+
+static void pool_init_once(void) {
+    if (initialized) return;
+    MUTEX_INIT(&mtx);
+    COND_INIT(&cv_job);
+#if defined(__linux__)
+    proc_cpus_ok = sched_getaffinity(0, sizeof(proc_cpus), &proc_cpus) == 0;
+#endif
+    for (int i = 0; i < POOL_MAX_GROUPS; ++i) {
+        COND_INIT(&groups[i].cv_done);
+        COND_INIT(&groups[i].cv_bar);
+    }
+    initialized = 1;
+}
+
+void pool_set_team(int nthreads) {
+    PoolGroup* g = current();
+    if (nthreads < 1) nthreads = 1;
+    if (nthreads > g->width) nthreads = g->width;
+    g->team = nthreads;
+}
+
+int pool_team(void) { return current()->team; }
+
+void pool_set_affinity(const int* cpus, int n) {
+    PoolGroup* g = current();
+    if (!cpus || n < 0) n = 0;
+    if (n > POOL_MAX_THREADS) n = POOL_MAX_THREADS;
+    pool_init_once();
+    MUTEX_LOCK(&mtx);
+    for (int i = 0; i < n; ++i) g->pin[i] = cpus[i];
+    g->npin = n;
+    MUTEX_UNLOCK(&mtx);
+}
+
+int pool_group_bind(int first_worker, int width, int nthreads) {
+    pool_init_once();
+    if (first_worker < 0 || first_worker >= POOL_MAX_THREADS || width < 1) return 0;
+    if (width > POOL_MAX_THREADS - first_worker) width = POOL_MAX_THREADS - first_worker;
+    MUTEX_LOCK(&mtx);
+    PoolGroup* g = NULL;
+    int overlap = 0;
+    for (int i = 1; i < POOL_MAX_GROUPS; ++i) {
+        const PoolGroup* o = &groups[i];
+        if (o->in_use && first_worker < o->first + o->width && o->first < first_worker + width) overlap = 1;
+        else if (!o->in_use && !g) g = &groups[i];
+    }
+    if (overlap) g = NULL;
+    if (g) {
+        g->in_use = 1;
+        g->first = first_worker;
+        g->width = width;
+    }
+    MUTEX_UNLOCK(&mtx);
+    if (!g) return 0;
+
+    bound = g;
+    pool_set_team(nthreads);
+    return 1;
+}
+
+void pool_group_unbind(void) {
+    if (!bound) return;
+    MUTEX_LOCK(&mtx);
+    bound->in_use = 0;
+    bound->npin = 0;
+    MUTEX_UNLOCK(&mtx);
+    bound = NULL;
+}
+
+void pool_run(PoolTask task, void* arg) {
+    pool_init_once();
+    PoolGroup* g = current();
+
+    MUTEX_LOCK(&mtx);
+    // Grow the pool on demand; workers persist for the life of the process
+    int n = 0;
+    for (; n < g->team; ++n) {
+        const int w = g->first + n;
+        if (!alive[w] && !(alive[w] = (unsigned char)spawn_worker(w))) break;
+    }
+
+    for (int i = 0; i < n; ++i) { g->t_begin[i] = 0.0; g->t_end[i] = 0.0; g->t_units[i] = 0.0; }
+    g->job_fn = task;
+    g->job_arg = arg;
+    g->job_team = n;
+    g->job_done = 0;
+    g->bar_count = 0;
+    for (int i = 0; i < n; ++i) {
+        mail_group[g->first + i] = g;
+        mail_gen[g->first + i]++;
+    }
+    COND_BCAST(&cv_job);
+    while (g->job_done < n) COND_WAIT(&g->cv_done, &mtx);
+    MUTEX_UNLOCK(&mtx);
+
+    // Fold per-thread stamps into the run summary
+    double first = DBL_MAX, lastend = 0.0, units = 0.0;
+    double tmin = DBL_MAX, tmax = 0.0;
+    for (int i = 0; i < n; ++i) {
+        const double dt = g->t_end[i] - g->t_begin[i];
+        if (g->t_begin[i] < first) first = g->t_begin[i];
+        if (g->t_end[i] > lastend) lastend = g->t_end[i];
+        units += g->t_units[i];
+        const double rate = (dt > 0.0) ? (g->t_units[i] / dt) : 0.0;
+        if (rate < tmin) tmin = rate;
+        if (rate > tmax) tmax = rate;
+    }
+    g->last.threads = n;
+    g->last.wall_s = (lastend > first) ? (lastend - first) : 0.0;
+    g->last.units = units;
+    g->last.thread_min = (n > 0) ? tmin : 0.0;
+    g->last.thread_max = tmax;
+}
+
+void pool_sync(void) {
+    PoolGroup* g = running;
+    MUTEX_LOCK(&mtx);
+    const unsigned gen = g->bar_gen;
+    if (++g->bar_count == g->job_team) {
+        g->bar_count = 0;
+        g->bar_gen++;
+        COND_BCAST(&g->cv_bar);
+    }
+    else {
+        while (gen == g->bar_gen) COND_WAIT(&g->cv_bar, &mtx);
+    }
+    MUTEX_UNLOCK(&mtx);
+}
+
+void pool_timed_begin(int tid) {
+    pool_sync();
+    perf_region_begin();
+    running->t_begin[tid] = timer_now_seconds();
+}
+
+void pool_timed_end(int tid, double units) {
+    running->t_end[tid] = timer_now_seconds();
+    perf_region_end();
+    running->t_units[tid] = units;
+}
+
+double pool_last_stats(PoolStats* out) {
+    const PoolStats* last = &current()->last;
+    if (out) *out = *last;
+    return (last->wall_s > 0.0) ? (last->units / last->wall_s) : 0.0;
+}
+
+int pool_pin_self(int cpu) {
+#if defined(_WIN32) || defined(__linux__)
+    if (cpu < 0 && pinned == -1) return 1;   // not pinned: already on the start-up mask
+    pool_init_once();
+#endif
+#if defined(_WIN32)
+    DWORD_PTR mask = (cpu < 0) ? (DWORD_PTR)-1 : ((DWORD_PTR)1 << (cpu % (int)(8 * sizeof(DWORD_PTR))));
+    if (cpu < 0) {
+        DWORD_PTR proc, sys;
+        if (GetProcessAffinityMask(GetCurrentProcess(), &proc, &sys)) mask = proc;
+    }
+    if (!SetThreadAffinityMask(GetCurrentThread(), mask)) return 0;
+    pinned = cpu < 0 ? -1 : cpu;
+    if (cpu >= 0) ever_pinned = 1;
+    return 1;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (cpu < 0 && proc_cpus_ok) {
+        set = proc_cpus;
+    }
+    else if (cpu < 0) {
+        const int n = (int)sysconf(_SC_NPROCESSORS_CONF);
+        for (int i = 0; i < n && i < CPU_SETSIZE; ++i) CPU_SET(i, &set);
+    }
+    else if (cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &set);
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) return 0;
+    pinned = cpu < 0 ? -1 : cpu;
+    if (cpu >= 0) ever_pinned = 1;
+    return 1;
+#else
+    (void)cpu;   // macOS exposes no hard affinity
+    return 0;
+#endif
+}
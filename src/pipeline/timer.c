@@ -1,27 +1,48 @@
 #include "timer.h"
+#include "perf_counters.h"
 
-// Platform specific high-resolution timer
+// Platform specific high-resolution timer. The start stamp is per thread, so
+// tests running side by side (mixed-load mode) keep their own.
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TIMER_TLS __declspec(thread)
+#else
+#define TIMER_TLS _Thread_local
+#endif
 
 // Windows implementation
 #if defined(_WIN32)
 #include <windows.h>
-static LARGE_INTEGER t0, freq;
+static TIMER_TLS LARGE_INTEGER t0;
+static LARGE_INTEGER freq;
 void timer_start(void) {
     if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    perf_region_begin();
     QueryPerformanceCounter(&t0);
 }
 double timer_elapsed_seconds(void) {
     LARGE_INTEGER t1; QueryPerformanceCounter(&t1);
+    perf_region_end();
     return (double)(t1.QuadPart - t0.QuadPart) / (double)freq.QuadPart;
 }
+double timer_now_seconds(void) {
+    LARGE_INTEGER f, t; QueryPerformanceFrequency(&f); QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)f.QuadPart;
+}
 
 // POSIX implementation (Linux, macOS, etc.)
 #else
 #include <time.h>
-static struct timespec t0;
-void timer_start(void) { clock_gettime(CLOCK_MONOTONIC, &t0); }
+static TIMER_TLS struct timespec t0;
+// The counter group brackets the same region as the clock
+void timer_start(void) { perf_region_begin(); clock_gettime(CLOCK_MONOTONIC, &t0); }
 double timer_elapsed_seconds(void) {
     struct timespec t1; clock_gettime(CLOCK_MONOTONIC, &t1);
+    perf_region_end();
     return (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
 }
+double timer_now_seconds(void) {
+    struct timespec t; clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + t.tv_nsec / 1e9;
+}
 #endif
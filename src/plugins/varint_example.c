@@ -0,0 +1,65 @@
+// Example plugin: a LEB128 varint decoder, the inner loop of most binary
+// wire formats. Build with -DPCBENCH_EXAMPLE_PLUGIN=ON; the library lands in
+// <build>/plugins and is picked up with --plugin-dir <build>/plugins.
+#include <stdint.h>
+#include <stdlib.h>
+#include "plugin.h"
+#include "timer.h"
+
+#define VARINT_COUNT (4u << 20)   // 4 Mi values, ~10 MB encoded
+
+static uint8_t* buf;
+static size_t   buf_len;
+static volatile uint64_t sink;
+
+static int varint_prepare(void) {
+    buf = (uint8_t*)malloc((size_t)VARINT_COUNT * 10u);
+    if (!buf) return 0;
+    // Mostly small values with a long tail, like field tags and lengths
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    size_t n = 0;
+    for (uint32_t i = 0; i < VARINT_COUNT; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        uint64_t v = x >> (x & 63);
+        do {
+            buf[n++] = (uint8_t)((v & 0x7F) | (v > 0x7F ? 0x80 : 0));
+            v >>= 7;
+        } while (v);
+    }
+    buf_len = n;
+    return 1;
+}
+
+static double varint_run_once(void) {
+    const double t0 = timer_now_seconds();
+    uint64_t sum = 0;
+    for (size_t i = 0; i < buf_len;) {
+        uint64_t v = 0;
+        unsigned shift = 0;
+        uint8_t b;
+        do {
+            b = buf[i++];
+            v |= (uint64_t)(b & 0x7F) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        sum += v;
+    }
+    sink = sum;
+    const double dt = timer_now_seconds() - t0;
+    return dt > 0.0 ? (double)VARINT_COUNT / dt / 1e6 : 0.0;   // Mvalues/s
+}
+
+static void varint_teardown(void) {
+    free(buf);
+    buf = NULL;
+}
+
+PLUGIN_EXPORT int pcbench_plugin_init(int abi, PluginAddFn add) {
+    static const TestCase tc = {
+        "VAR", "LEB128 varint decode (plugin)", "Mvals/s",
+        varint_prepare, varint_run_once, varint_teardown, 0.0, 0
+    };
+    if (abi != PLUGIN_ABI_VERSION) return 0;
+    add(&tc);   // a duplicate id is reported by the host
+    return 1;
+}
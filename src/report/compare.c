@@ -0,0 +1,360 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "compare.h"
+#include "json_read.h"
+#include "report.h"
+
+static void copy_str(char* dst, size_t n, const char* src) {
+    snprintf(dst, n, "%s", src ? src : "");
+}
+
+// Whole file, NUL-terminated
+static char* read_file(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* buf = (size >= 0) ? (char*)malloc((size_t)size + 1) : NULL;
+    if (buf) {
+        const size_t got = fread(buf, 1, (size_t)size, f);
+        buf[got] = '\0';
+    }
+    fclose(f);
+    return buf;
+}
+
+static ResultRow* find_row(ResultSet* set, const char* id, int threads) {
+    for (int i = 0; i < set->count; ++i) {
+        if (set->rows[i].threads == threads && strcmp(set->rows[i].id, id) == 0) return &set->rows[i];
+    }
+    return NULL;
+}
+
+static ResultRow* add_row(ResultSet* set, const char* id, const char* unit, int threads) {
+    ResultRow* r = find_row(set, id, threads);
+    if (r) return r;
+    ResultRow* rows = (ResultRow*)realloc(set->rows, (size_t)(set->count + 1) * sizeof(ResultRow));
+    if (!rows) return NULL;
+    set->rows = rows;
+    r = &rows[set->count++];
+    memset(r, 0, sizeof(*r));
+    copy_str(r->id, sizeof(r->id), id);
+    copy_str(r->unit, sizeof(r->unit), unit);
+    r->threads = threads;
+    return r;
+}
+
+static void add_samples(ResultRow* r, const JsonValue* arr) {
+    if (!arr || arr->type != JSON_ARRAY || arr->count == 0) return;
+    double* s = (double*)realloc(r->samples, (size_t)(r->nsamples + arr->count) * sizeof(double));
+    if (!s) return;
+    r->samples = s;
+    for (int i = 0; i < arr->count; ++i) {
+        if (arr->items[i].type == JSON_NUMBER) r->samples[r->nsamples++] = arr->items[i].number;
+    }
+}
+
+static void load_run(ResultSet* set, const JsonValue* run) {
+    copy_str(set->run_id, sizeof(set->run_id), json_get_string(run, "run_id"));
+    copy_str(set->host, sizeof(set->host), json_get_string(run, "host"));
+    copy_str(set->profile, sizeof(set->profile), json_get_string(run, "profile"));
+    set->runs++;
+}
+
+// A result object; samples accumulate across runs, the summary is the latest
+static void load_result(ResultSet* set, const JsonValue* o) {
+    const char* id = json_get_string(o, "id");
+    if (!id) return;
+    ResultRow* r = add_row(set, id, json_get_string(o, "unit"), (int)json_get_number(o, "threads", 1.0));
+    if (!r) return;
+    r->s.n = (int)json_get_number(o, "runs", 1.0);
+    r->s.median = json_get_number(o, "median", 0.0);
+    r->s.ci_lo = json_get_number(o, "ci_lo", r->s.median);
+    r->s.ci_hi = json_get_number(o, "ci_hi", r->s.median);
+    add_samples(r, json_get(o, "samples"));
+}
+
+// Drops every row loaded so far: a newer run starts and only the latest counts
+static void clear_rows(ResultSet* set) {
+    for (int i = 0; i < set->count; ++i) free(set->rows[i].samples);
+    set->count = 0;
+    set->runs = 0;
+}
+
+static int load_json(const char* text, int all_runs, ResultSet* set) {
+    const char* p = text;
+    int values = 0;
+    for (;;) {
+        while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') ++p;
+        if (!*p) break;
+        JsonValue v;
+        const char* next = json_parse(p, &v);
+        if (!next) return values > 0;   // a truncated last line still leaves the rest
+        values++;
+
+        const JsonValue* results = json_get(&v, "results");
+        const char* type = json_get_string(&v, "type");
+        const int run_start = (results && results->type == JSON_ARRAY) || (type && strcmp(type, "run") == 0);
+        if (run_start && !all_runs && set->runs > 0) clear_rows(set);
+        if (results && results->type == JSON_ARRAY) {   // REPORT_JSON document
+            load_run(set, json_get(&v, "run"));
+            for (int i = 0; i < results->count; ++i) load_result(set, &results->items[i]);
+        } else if (type && strcmp(type, "run") == 0) {
+            load_run(set, &v);
+        } else if (type && strcmp(type, "result") == 0) {
+            load_result(set, &v);
+        }
+        json_free(&v);
+        p = next;
+    }
+    return values > 0;
+}
+
+// Column index of name in a CSV header line, or -1
+static int csv_column(const char* header, const char* name) {
+    int col = 0;
+    const size_t len = strlen(name);
+    for (const char* p = header; *p; ++col) {
+        const size_t n = strcspn(p, ",\r\n");
+        if (n == len && strncmp(p, name, len) == 0) return col;
+        p += n;
+        if (*p != ',') break;
+        ++p;
+    }
+    return -1;
+}
+
+// Appended CSV runs: the last row of each (id, threads) wins; no samples
+static int load_csv(char* text, ResultSet* set) {
+    char* line = strtok(text, "\n");
+    if (!line || strncmp(line, "id,", 3) != 0) return 0;
+    const int c_unit = csv_column(line, "unit"), c_thr = csv_column(line, "threads");
+    const int c_runs = csv_column(line, "runs"), c_med = csv_column(line, "median");
+    const int c_lo = csv_column(line, "ci_lo"), c_hi = csv_column(line, "ci_hi");
+    if (c_med < 0) return 0;
+
+    while ((line = strtok(NULL, "\n")) != NULL) {
+        char* cols[32];
+        int n = 0;
+        for (char* p = line; n < 32;) {
+            cols[n++] = p;
+            p = strchr(p, ',');
+            if (!p) break;
+            *p++ = '\0';
+        }
+        if (n <= c_med) continue;
+        ResultRow* r = add_row(set, cols[0], c_unit >= 0 && c_unit < n ? cols[c_unit] : "",
+            c_thr >= 0 && c_thr < n ? atoi(cols[c_thr]) : 1);
+        if (!r) continue;
+        r->s.n = c_runs >= 0 && c_runs < n ? atoi(cols[c_runs]) : 1;
+        r->s.median = atof(cols[c_med]);
+        r->s.ci_lo = c_lo >= 0 && c_lo < n ? atof(cols[c_lo]) : r->s.median;
+        r->s.ci_hi = c_hi >= 0 && c_hi < n ? atof(cols[c_hi]) : r->s.median;
+    }
+    set->runs = 1;
+    return 1;
+}
+
+int results_load(const char* path, int all_runs, ResultSet* out) {
+    memset(out, 0, sizeof(*out));
+    copy_str(out->path, sizeof(out->path), path);
+    char* text = read_file(path);
+    if (!text) return 0;
+    const char* p = text;
+    while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t') ++p;
+    const int ok = (*p == '{') ? load_json(p, all_runs, out) : load_csv(text, out);
+    free(text);
+
+    // Pooled samples (of every run, or just the latest) replace the latest run's summary
+    for (int i = 0; i < out->count; ++i) {
+        ResultRow* r = &out->rows[i];
+        if (r->nsamples > 0) stats_summarize(r->samples, r->nsamples, &r->s);
+    }
+    if (!ok || out->count == 0) {
+        results_free(out);
+        return 0;
+    }
+    return 1;
+}
+
+void results_free(ResultSet* set) {
+    for (int i = 0; i < set->count; ++i) free(set->rows[i].samples);
+    free(set->rows);
+    set->rows = NULL;
+    set->count = 0;
+}
+
+static int lower_is_better(const char* unit) {
+    return strcmp(unit, "ns") == 0 || strcmp(unit, "us") == 0 || strcmp(unit, "ms") == 0;
+}
+
+static void describe(const char* label, const ResultSet* s) {
+    printf("%s %s (host %s, run %.8s, %s, %d run%s)\n", label, s->path,
+        s->host[0] ? s->host : "?", s->run_id[0] ? s->run_id : "?",
+        s->profile[0] ? s->profile : "profile ?", s->runs, s->runs == 1 ? "" : "s");
+}
+
+int compare_results(const ResultSet* base, const ResultSet* cand, const CompareOptions* opt) {
+    int regressions = 0, improvements = 0, unchanged = 0, untested = 0, unmatched = 0, few = 0;
+
+    describe("base:", base);
+    describe("new: ", cand);
+    if (base->profile[0] && cand->profile[0] && strcmp(base->profile, cand->profile) != 0) {
+        printf("warning: different profiles, problem sizes differ\n");
+    }
+    printf("%-16s %3s %12s %12s %8s %8s %7s  %s\n", "id", "T", "base", "new", "change", "p", "effect", "verdict");
+
+    for (int i = 0; i < cand->count; ++i) {
+        const ResultRow* c = &cand->rows[i];
+        const ResultRow* b = find_row((ResultSet*)base, c->id, c->threads);
+        if (!b) {
+            unmatched++;
+            continue;
+        }
+        const double change = (b->s.median != 0.0) ? (c->s.median - b->s.median) / fabs(b->s.median) : 0.0;
+        const double better = lower_is_better(c->unit) ? -change : change;
+
+        // A single value per side (sweep points) carries no noise estimate: shown, not judged.
+        // With too few samples the U test cannot reach alpha (3 vs 3: p >= 0.08), so
+        // those rows are judged by their confidence intervals instead.
+        double p = -1.0, effect = 0.0;
+        int significant = 0, tested = 1;
+        const int u_test = b->nsamples > 1 && c->nsamples > 1;
+        if (u_test && stats_mann_whitney_min_p(c->nsamples, b->nsamples) < opt->alpha) {
+            p = stats_mann_whitney(c->samples, c->nsamples, b->samples, b->nsamples, &effect);
+            significant = p < opt->alpha;
+        } else if (b->s.n > 1 && c->s.n > 1) {
+            if (u_test) few++;
+            significant = c->s.ci_lo > b->s.ci_hi || c->s.ci_hi < b->s.ci_lo;
+        } else {
+            tested = 0;
+        }
+
+        const char* verdict = "";
+        if (!tested) {
+            untested++;
+        } else if (significant && better <= -opt->threshold) {
+            verdict = "REGRESSION";
+            regressions++;
+        } else if (significant && better >= opt->threshold) {
+            verdict = "improvement";
+            improvements++;
+        } else {
+            unchanged++;
+        }
+
+        char pbuf[16], ebuf[16];
+        if (p >= 0.0) {
+            snprintf(pbuf, sizeof(pbuf), "%.4f", p);
+            snprintf(ebuf, sizeof(ebuf), "%+.2f", effect);
+        } else {
+            snprintf(pbuf, sizeof(pbuf), tested ? "ci" : "-");
+            snprintf(ebuf, sizeof(ebuf), "-");
+        }
+        printf("%-16s %3d %12.4g %12.4g %+7.1f%% %8s %7s  %s\n", c->id, c->threads,
+            b->s.median, c->s.median, 100.0 * change, pbuf, ebuf, verdict);
+    }
+    for (int i = 0; i < base->count; ++i) {
+        if (!find_row((ResultSet*)cand, base->rows[i].id, base->rows[i].threads)) unmatched++;
+    }
+
+    printf("%d regression%s, %d improvement%s, %d unchanged, %d single-valued (not tested), %d in one file only"
+        " (threshold %.1f%%, alpha %g)\n\n",
+        regressions, regressions == 1 ? "" : "s", improvements, improvements == 1 ? "" : "s",
+        unchanged, untested, unmatched, 100.0 * opt->threshold, opt->alpha);
+    if (few) {
+        printf("%d row%s judged by CI overlap (p = ci): too few samples for the U test to reach alpha %g\n\n",
+            few, few == 1 ? "" : "s", opt->alpha);
+    }
+    return regressions;
+}
+
+int compare_files(const char* const* paths, int n, double threshold, double alpha) {
+    if (n < 2) return -1;
+    const CompareOptions opt = { threshold, alpha };
+    ResultSet base;
+    if (!results_load(paths[0], 1, &base)) {
+        fprintf(stderr, "Cannot load results from %s\n", paths[0]);
+        return -1;
+    }
+    int total = 0;
+    for (int i = 1; i < n; ++i) {
+        ResultSet cand;
+        if (!results_load(paths[i], 0, &cand)) {
+            fprintf(stderr, "Cannot load results from %s\n", paths[i]);
+            results_free(&base);
+            return -1;
+        }
+        total += compare_results(&base, &cand, &opt);
+        results_free(&cand);
+    }
+    results_free(&base);
+    return total;
+}
+
+// COMPARE_BASELINE_DIR/<host>.<ext>; 0 if the file names no host
+static int baseline_path(const ResultSet* set, const char* ext, char* out, size_t n) {
+    if (!set->host[0]) return 0;
+    snprintf(out, n, "%s/%s.%s", COMPARE_BASELINE_DIR, set->host, ext);
+    return 1;
+}
+
+int compare_with_baseline(const char* path, double threshold, double alpha) {
+    ResultSet cand;
+    if (!results_load(path, 0, &cand)) {
+        fprintf(stderr, "Cannot load results from %s\n", path);
+        return -1;
+    }
+    char base_path[512];
+    int found = 0;
+    const char* exts[] = { "jsonl", "json" };
+    for (int i = 0; i < 2 && !found; ++i) {
+        if (!baseline_path(&cand, exts[i], base_path, sizeof(base_path))) break;
+        FILE* f = fopen(base_path, "rb");
+        if (f) {
+            fclose(f);
+            found = 1;
+        }
+    }
+    results_free(&cand);
+    if (!found) {
+        fprintf(stderr, "No baseline for this host in %s/ (see --save-baseline)\n", COMPARE_BASELINE_DIR);
+        return -1;
+    }
+    const char* paths[2] = { base_path, path };
+    return compare_files(paths, 2, threshold, alpha);
+}
+
+int save_baseline(const char* path) {
+    ResultSet set;
+    if (!results_load(path, 0, &set)) {
+        fprintf(stderr, "Cannot load results from %s\n", path);
+        return 0;
+    }
+    const size_t len = strlen(path);
+    const int lines = len > 6 && strcmp(path + len - 6, ".jsonl") == 0;
+    char dst[512], other[512];
+    const int named = baseline_path(&set, lines ? "jsonl" : "json", dst, sizeof(dst)) &&
+        baseline_path(&set, lines ? "json" : "jsonl", other, sizeof(other));
+    results_free(&set);
+    if (!named) {
+        fprintf(stderr, "%s names no host (CSV results cannot be a baseline)\n", path);
+        return 0;
+    }
+
+    char* text = read_file(path);
+    report_ensure_dir(dst);
+    FILE* f = text ? fopen(dst, "wb") : NULL;
+    const int ok = f && fputs(text, f) >= 0;
+    if (f) fclose(f);
+    free(text);
+    if (ok) {
+        remove(other);   // the lookup prefers .jsonl; keep one baseline per host
+        printf("Baseline saved to %s\n", dst);
+    }
+    else fprintf(stderr, "Cannot write %s\n", dst);
+    return ok;
+}
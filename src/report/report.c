@@ -0,0 +1,63 @@
+#include <stdlib.h>
+#include <string.h>
+#include "report.h"
+#include "report_csv.h"
+#include "report_json.h"
+#include "config.h"
+
+#if defined(_WIN32)
+#include <direct.h>
+#define MKDIR(p) _mkdir(p)   // returns -1 if exists; fine to ignore
+#else
+#include <sys/stat.h>
+#define MKDIR(p) mkdir(p, 0755)
+#endif
+
+void report_ensure_dir(const char* path) {
+    char dir[512];
+    snprintf(dir, sizeof(dir), "%s", path ? path : "");
+    char* slash = strrchr(dir, '/');
+#if defined(_WIN32)
+    char* bslash = strrchr(dir, '\\');
+    if (bslash && (!slash || bslash > slash)) slash = bslash;
+#endif
+    if (!slash || slash == dir) return;
+    *slash = '\0';
+    (void)MKDIR(dir);
+}
+
+Report* report_begin(const char* path, int format) {
+    Report* r = (Report*)calloc(1, sizeof(Report));
+    if (!r) return NULL;
+    r->format = format;
+    run_env_capture(&r->env);
+    if (format == REPORT_JSON || format == REPORT_JSONL) (void)report_json_begin(r, path);
+    else r->f = report_csv_begin(path);
+    if (!r->f) {
+        free(r);
+        return NULL;
+    }
+    return r;
+}
+
+void report_write(Report* r, const char* id, const char* title, const char* unit,
+    int threads, const SampleStats* s, const double* samples,
+    double thread_min, double thread_max, double efficiency, double index, const PerfSummary* perf,
+    const TelemetrySummary* tele) {
+    if (!r) return;
+    if (r->format == REPORT_JSON || r->format == REPORT_JSONL) {
+        report_json_write(r, id, title, unit, threads, s, samples,
+            thread_min, thread_max, efficiency, index, perf, tele);
+    } else {
+        report_csv_write(r->f, id, title, unit, threads, s,
+            thread_min, thread_max, efficiency, index, perf, tele);
+    }
+    r->rows++;
+}
+
+void report_end(Report* r) {
+    if (!r) return;
+    if (r->format == REPORT_JSON || r->format == REPORT_JSONL) report_json_end(r);
+    else report_csv_end(r->f);
+    free(r);
+}
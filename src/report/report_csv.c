@@ -1,20 +1,43 @@
 #include "report_csv.h"
+#include "report.h"
 #include <string.h>
+#include <time.h>
 
-#if defined(_WIN32)
-#include <direct.h>
-#define MKDIR(p) _mkdir(p)   // returns -1 if exists; fine to ignore
-#else
-#include <sys/stat.h>
-#define MKDIR(p) mkdir(p, 0755)
-#endif
+#define CSV_HEADER "id,title,unit,threads,runs,avg,median,stddev,cv,min,max,p5,p95,ci_lo,ci_hi," \
+    "thread_min,thread_max,efficiency,index,ipc,ghz,llc_mpki,dtlb_mpki,branch_mpki," \
+    "mhz,temp_c,pkg_watts,dram_watts,work_per_joule,joules_per_work,throttled"
 
-static void ensure_results_dir(void) {
-    (void)MKDIR("results");
+// A file written by an older build has different columns; move it aside
+// rather than appending rows that no longer line up with its header.
+static void rotate_if_outdated(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) return;
+    char line[512] = { 0 };
+    int stale = fgets(line, sizeof(line), f) != NULL &&
+        strncmp(line, CSV_HEADER "\n", sizeof(CSV_HEADER)) != 0;
+    fclose(f);
+    if (!stale) return;
+
+    // <path>.<YYYYmmddHHMMSS>.old, numbered if that exists too: earlier
+    // backups are never overwritten
+    char stamp[32] = "";
+    const time_t now = time(NULL);
+    const struct tm* t = localtime(&now);
+    if (t) strftime(stamp, sizeof(stamp), "%Y%m%d%H%M%S", t);
+    char old[512];
+    snprintf(old, sizeof(old), "%s.%s.old", path, stamp);
+    for (int n = 1; n < 1000; ++n) {
+        FILE* taken = fopen(old, "r");
+        if (!taken) break;
+        fclose(taken);
+        snprintf(old, sizeof(old), "%s.%s.old.%d", path, stamp, n);
+    }
+    if (rename(path, old) == 0) fprintf(stderr, "%s has older columns, moved to %s\n", path, old);
 }
 
 FILE* report_csv_begin(const char* path) {
-    ensure_results_dir();
+    report_ensure_dir(path);
+    rotate_if_outdated(path);
     FILE* f = fopen(path, "a+");        // append (create if missing)
     if (!f) return NULL;
 
@@ -22,7 +45,7 @@ FILE* report_csv_begin(const char* path) {
     fseek(f, 0, SEEK_END);
     long sz = ftell(f);
     if (sz == 0) {
-        fprintf(f, "id,title,unit,avg,min,max,index\n");
+        fprintf(f, CSV_HEADER "\n");
         fflush(f);
     }
     return f;
@@ -39,12 +62,39 @@ static void csv_sanitize_title(const char* in, char* out, size_t n) {
 }
 
 void report_csv_write(FILE* f, const char* id, const char* title, const char* unit,
-    double avg, double minv, double maxv, double index) {
+    int threads, const SampleStats* s,
+    double thread_min, double thread_max, double efficiency, double index, const PerfSummary* perf,
+    const TelemetrySummary* tele) {
     if (!f) return;
     char safe[256];
     csv_sanitize_title(title, safe, sizeof(safe));
-    fprintf(f, "%s,%s,%s,%.6f,%.6f,%.6f,%.6f\n",
-        id, safe, unit, avg, minv, maxv, index);
+    fprintf(f, "%s,%s,%s,%d,%d,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,",
+        id, safe, unit, threads, s->n, s->mean, s->median, s->stddev, s->cv, s->minv, s->maxv,
+        s->p5, s->p95, s->ci_lo, s->ci_hi, thread_min, thread_max, efficiency);
+    if (index > 0.0) fprintf(f, "%.6f", index);   // empty: no reference
+    if (perf && perf->valid) {
+        const double miss[3] = { perf->llc_mpki, perf->dtlb_mpki, perf->branch_mpki };
+        fprintf(f, ",%.4f,%.4f", perf->ipc, perf->ghz);
+        for (int i = 0; i < 3; ++i) {
+            if (miss[i] >= 0.0) fprintf(f, ",%.4f", miss[i]);
+            else fprintf(f, ",");
+        }
+    }
+    else {
+        fprintf(f, ",,,,,");
+    }
+    if (tele && tele->valid) {
+        const double v[6] = { tele->mhz, tele->temp_c, tele->pkg_watts, tele->dram_watts,
+                              tele->work_per_joule, tele->joules_per_work };
+        for (int i = 0; i < 6; ++i) {
+            if (v[i] >= 0.0) fprintf(f, ",%.6g", v[i]);
+            else fprintf(f, ",");
+        }
+        fprintf(f, ",%d\n", tele->throttled);
+    }
+    else {
+        fprintf(f, ",,,,,,,\n");
+    }
     fflush(f);
 }
 
@@ -0,0 +1,273 @@
+#include <math.h>
+#include <string.h>
+#include "report_json.h"
+#include "config.h"
+#include "numa_nodes.h"
+#include "topology.h"
+#include "json_read.h"
+
+// REPORT_JSON:  {"format": "pc-bench", "version": 2, "run": {...}, "results": [ {...}, ... ]}
+// REPORT_JSONL: {"type": "run", "run_id": ..., ...}
+//               {"type": "result", "run_id": ..., "id": ..., ...}   one line each
+
+#define JSON_VERSION 2
+
+// JSON has no inf/nan
+static void json_number(FILE* f, double v) {
+    if (isfinite(v)) fprintf(f, "%.9g", v);
+    else fprintf(f, "null");
+}
+
+static void json_key(FILE* f, int first, const char* key) {
+    fprintf(f, "%s\"%s\": ", first ? "" : ", ", key);
+}
+
+static void json_str_field(FILE* f, const char* key, const char* v) {
+    json_key(f, 0, key);
+    if (v && v[0]) json_write_string(f, v);
+    else fprintf(f, "null");
+}
+
+static void json_num_field(FILE* f, const char* key, double v) {
+    json_key(f, 0, key);
+    json_number(f, v);
+}
+
+// Negative = unknown
+static void json_int_field(FILE* f, const char* key, long v) {
+    json_key(f, 0, key);
+    if (v >= 0) fprintf(f, "%ld", v);
+    else fprintf(f, "null");
+}
+
+// Negative = unknown
+static void json_bool_field(FILE* f, const char* key, int v) {
+    json_key(f, 0, key);
+    if (v >= 0) fprintf(f, "%s", v ? "true" : "false");
+    else fprintf(f, "null");
+}
+
+static void write_config(FILE* f) {
+    const BenchConfig* cfg = bench_config_defaults();
+    int n = 0;
+    const ConfigField* fields = bench_config_fields(&n);
+    fprintf(f, "{");
+    for (int i = 0; i < n; ++i) {
+        const char* p = (const char*)cfg + fields[i].offset;
+        json_key(f, i == 0, fields[i].name);
+        switch (fields[i].type) {
+        case CFG_INT:    fprintf(f, "%d", *(const int*)p); break;
+        case CFG_SIZE:   fprintf(f, "%zu", *(const size_t*)p); break;
+        case CFG_DOUBLE: json_number(f, *(const double*)p); break;
+        case CFG_STR:    json_write_string(f, p); break;
+        }
+    }
+    fprintf(f, "}");
+}
+
+static void write_numa(FILE* f) {
+    int count = 0;
+    const NumaNode* nodes = numa_nodes(&count);
+    fprintf(f, "[");
+    for (int i = 0; i < count; ++i) {
+        fprintf(f, "%s{\"node\": %d, \"cpus\": [", i ? ", " : "", nodes[i].id);
+        for (int c = 0; c < nodes[i].ncpus; ++c) fprintf(f, "%s%d", c ? ", " : "", nodes[i].cpus[c]);
+        fprintf(f, "]}");
+    }
+    fprintf(f, "]");
+}
+
+static void write_topology(FILE* f) {
+    const Topology* t = topology_get();
+    fprintf(f, "{\"packages\": %d, \"cores\": %d, \"threads\": %d, \"smt\": %d, \"hybrid\": %s",
+        t->npackages, t->ncores, t->ncpus, t->smt, t->hybrid ? "true" : "false");
+    json_key(f, 0, "cpus");
+    fprintf(f, "[");
+    for (int i = 0; i < t->ncpus; ++i) {
+        const TopoCpu* c = &t->cpus[i];
+        fprintf(f, "%s{\"cpu\": %d, \"package\": %d, \"core\": %d, \"smt\": %d, \"node\": %d, \"type\": ",
+            i ? ", " : "", c->cpu, c->package, c->core, c->smt, c->node);
+        json_write_string(f, topology_type_name(c->type));
+        fprintf(f, "}");
+    }
+    fprintf(f, "]");
+    json_key(f, 0, "caches");
+    fprintf(f, "[");
+    for (int i = 0; i < t->ncaches; ++i) {
+        const TopoCache* c = &t->caches[i];
+        fprintf(f, "%s{\"level\": %d, \"size_kb\": %d, \"cpus\": ", i ? ", " : "", c->level, c->size_kb);
+        json_write_string(f, c->cpus);
+        fprintf(f, "}");
+    }
+    fprintf(f, "]}");
+}
+
+// Negative = unknown
+static void json_opt_field(FILE* f, int first, const char* key, double v) {
+    json_key(f, first, key);
+    if (v >= 0.0) json_number(f, v);
+    else fprintf(f, "null");
+}
+
+// Summary plus one entry per sample, in run order
+static void write_telemetry(FILE* f, const TelemetrySummary* t) {
+    fprintf(f, "{");
+    json_opt_field(f, 1, "mhz", t->mhz);
+    json_opt_field(f, 0, "mhz_min", t->mhz_min);
+    json_opt_field(f, 0, "temp_c", t->temp_c);
+    json_opt_field(f, 0, "pkg_watts", t->pkg_watts);
+    json_opt_field(f, 0, "dram_watts", t->dram_watts);
+    json_opt_field(f, 0, "work_per_joule", t->work_per_joule);
+    json_opt_field(f, 0, "joules_per_work", t->joules_per_work);
+    fprintf(f, ", \"throttled\": %d", t->throttled);
+    json_key(f, 0, "samples");
+    fprintf(f, "[");
+    for (int i = 0; i < t->n; ++i) {
+        const TelemetryWindow* w = &t->windows[i];
+        fprintf(f, "%s{", i ? ", " : "");
+        json_opt_field(f, 1, "mhz", w->mhz);
+        json_opt_field(f, 0, "temp_c", w->temp_c);
+        json_opt_field(f, 0, "pkg_joules", w->pkg_joules);
+        json_opt_field(f, 0, "dram_joules", w->dram_joules);
+        json_num_field(f, "seconds", w->seconds);
+        json_int_field(f, "throttle_events", w->throttle_events);
+        fprintf(f, ", \"throttled\": %s}", w->throttled ? "true" : "false");
+    }
+    fprintf(f, "]}");
+}
+
+// Members of the run object, without braces
+static void write_run_fields(FILE* f, const RunEnv* e) {
+    json_key(f, 1, "run_id");
+    json_write_string(f, e->run_id);
+    json_str_field(f, "timestamp", e->timestamp);
+    json_str_field(f, "host", e->host);
+    json_str_field(f, "profile", bench_profile_name(e->profile));
+    json_str_field(f, "os", e->os);
+    json_str_field(f, "os_version", e->os_version);
+    json_str_field(f, "arch", e->arch);
+    json_str_field(f, "compiler", e->compiler);
+    json_str_field(f, "build_type", e->build_type);
+    json_str_field(f, "build_flags", e->build_flags);
+    json_str_field(f, "cpu_vendor", e->cpu_vendor);
+    json_str_field(f, "cpu_model", e->cpu_model);
+    json_str_field(f, "cpu_flags", e->cpu_flags);
+    json_str_field(f, "governor", e->governor);
+    json_bool_field(f, "turbo", e->turbo);
+    json_int_field(f, "cpu_max_mhz", e->cpu_max_mhz);
+    json_int_field(f, "logical_cpus", e->logical_cpus);
+    json_int_field(f, "physical_cores", e->physical_cores);
+    json_int_field(f, "packages", e->packages);
+    json_bool_field(f, "smt_active", e->smt_active);
+    json_int_field(f, "l1d_kb", e->l1d_kb);
+    json_int_field(f, "l2_kb", e->l2_kb);
+    json_int_field(f, "l3_kb", e->l3_kb);
+    json_int_field(f, "ram_mb", e->ram_mb);
+    json_str_field(f, "gpu", e->gpu);
+    json_str_field(f, "thp", e->thp);
+    json_int_field(f, "hugepages_total", e->hugepages_total);
+    json_int_field(f, "hugepage_kb", e->hugepage_kb);
+    json_key(f, 0, "numa");
+    write_numa(f);
+    json_key(f, 0, "topology");
+    write_topology(f);
+    json_key(f, 0, "config");
+    write_config(f);
+}
+
+int report_json_begin(Report* r, const char* path) {
+    report_ensure_dir(path);
+    const int lines = r->format == REPORT_JSONL;
+    r->f = fopen(path, lines ? "a" : "w");
+    if (!r->f) return 0;
+    if (lines) {
+        fprintf(r->f, "{\"type\": \"run\", \"version\": %d, ", JSON_VERSION);
+        write_run_fields(r->f, &r->env);
+        fprintf(r->f, "}\n");
+    } else {
+        fprintf(r->f, "{\n  \"format\": \"pc-bench\",\n  \"version\": %d,\n  \"run\": {", JSON_VERSION);
+        write_run_fields(r->f, &r->env);
+        fprintf(r->f, "},\n  \"results\": [");
+    }
+    fflush(r->f);
+    return 1;
+}
+
+void report_json_write(Report* r, const char* id, const char* title, const char* unit,
+    int threads, const SampleStats* s, const double* samples,
+    double thread_min, double thread_max, double efficiency, double index, const PerfSummary* perf,
+    const TelemetrySummary* tele) {
+    if (!r || !r->f) return;
+    FILE* f = r->f;
+    if (r->format == REPORT_JSONL) {
+        fprintf(f, "{\"type\": \"result\", \"run_id\": ");
+        json_write_string(f, r->env.run_id);
+        fprintf(f, ", ");
+    } else {
+        fprintf(f, "%s\n    {", r->rows == 0 ? "" : ",");
+    }
+    json_key(f, 1, "id");
+    json_write_string(f, id);
+    json_str_field(f, "title", title);
+    json_str_field(f, "unit", unit);
+    fprintf(f, ", \"threads\": %d, \"runs\": %d", threads, s->n);
+    json_num_field(f, "avg", s->mean);
+    json_num_field(f, "median", s->median);
+    json_num_field(f, "stddev", s->stddev);
+    json_num_field(f, "cv", s->cv);
+    json_num_field(f, "min", s->minv);
+    json_num_field(f, "max", s->maxv);
+    json_num_field(f, "p5", s->p5);
+    json_num_field(f, "p95", s->p95);
+    json_num_field(f, "ci_lo", s->ci_lo);
+    json_num_field(f, "ci_hi", s->ci_hi);
+    json_num_field(f, "thread_min", thread_min);
+    json_num_field(f, "thread_max", thread_max);
+    json_num_field(f, "efficiency", efficiency);
+    json_key(f, 0, "index");
+    if (index > 0.0) json_number(f, index);
+    else fprintf(f, "null");   // no reference
+
+    json_key(f, 0, "samples");
+    if (samples) {
+        fprintf(f, "[");
+        for (int i = 0; i < s->n; ++i) {
+            if (i) fprintf(f, ", ");
+            json_number(f, samples[i]);
+        }
+        fprintf(f, "]");
+    } else {
+        fprintf(f, "null");
+    }
+
+    json_key(f, 0, "perf");
+    if (perf && perf->valid) {
+        const double miss[3] = { perf->llc_mpki, perf->dtlb_mpki, perf->branch_mpki };
+        const char* names[3] = { "llc_mpki", "dtlb_mpki", "branch_mpki" };
+        fprintf(f, "{");
+        json_key(f, 1, "ipc");
+        json_number(f, perf->ipc);
+        json_num_field(f, "ghz", perf->ghz);
+        for (int i = 0; i < 3; ++i) {
+            json_key(f, 0, names[i]);
+            if (miss[i] >= 0.0) json_number(f, miss[i]);
+            else fprintf(f, "null");
+        }
+        fprintf(f, "}");
+    } else {
+        fprintf(f, "null");
+    }
+
+    json_key(f, 0, "telemetry");
+    if (tele && tele->valid) write_telemetry(f, tele);
+    else fprintf(f, "null");
+    fprintf(f, r->format == REPORT_JSONL ? "}\n" : "}");
+    fflush(f);
+}
+
+void report_json_end(Report* r) {
+    if (!r || !r->f) return;
+    if (r->format == REPORT_JSON) fprintf(r->f, "\n  ]\n}\n");
+    fclose(r->f);
+    r->f = NULL;
+}
@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "run_env.h"
+#include "sysinfo.h"
+#include "config.h"
+#include "util.h"
+
+// Set by CMake for this file
+#ifndef PCBENCH_BUILD_TYPE
+#define PCBENCH_BUILD_TYPE ""
+#endif
+#ifndef PCBENCH_C_FLAGS
+#define PCBENCH_C_FLAGS ""
+#endif
+
+#if defined(_WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+static void copy_str(char* dst, size_t n, const char* src) {
+    snprintf(dst, n, "%s", src ? src : "");
+}
+
+// Without surrounding blanks (CMake joins empty flag lists with a space)
+static void copy_trimmed(char* dst, size_t n, const char* src) {
+    while (src && *src == ' ') ++src;
+    copy_str(dst, n, src);
+    size_t len = strlen(dst);
+    while (len > 0 && dst[len - 1] == ' ') dst[--len] = '\0';
+}
+
+// Kernel randomness where there is some, else time, pid and stack address mixed
+static void make_uuid(char* out, size_t n) {
+    unsigned char b[16];
+    int have = 0;
+#if !defined(_WIN32)
+    FILE* f = fopen("/dev/urandom", "rb");
+    if (f) {
+        have = fread(b, 1, sizeof(b), f) == sizeof(b);
+        fclose(f);
+    }
+#endif
+    if (!have) {
+        uint64_t s = (uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32) ^ (uint64_t)(uintptr_t)&s ^ (uint64_t)clock();
+        const uint64_t hi = splitmix64(&s), lo = splitmix64(&s);
+        memcpy(b, &hi, 8);
+        memcpy(b + 8, &lo, 8);
+    }
+    b[6] = (unsigned char)((b[6] & 0x0f) | 0x40);   // version 4
+    b[8] = (unsigned char)((b[8] & 0x3f) | 0x80);   // RFC 4122 variant
+    snprintf(out, n, "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+        b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7],
+        b[8], b[9], b[10], b[11], b[12], b[13], b[14], b[15]);
+}
+
+static void make_timestamp(char* out, size_t n) {
+    const time_t now = time(NULL);
+    struct tm utc;
+#if defined(_WIN32)
+    gmtime_s(&utc, &now);
+#else
+    gmtime_r(&now, &utc);
+#endif
+    strftime(out, n, "%Y-%m-%dT%H:%M:%SZ", &utc);
+}
+
+static void compiler_name(char* out, size_t n) {
+#if defined(__clang__)
+    snprintf(out, n, "clang %s", __clang_version__);
+#elif defined(__GNUC__)
+    snprintf(out, n, "gcc %s", __VERSION__);
+#elif defined(_MSC_VER)
+    snprintf(out, n, "msvc %d", _MSC_FULL_VER);
+#else
+    copy_str(out, n, "unknown");
+#endif
+}
+
+static const char* arch_name(void) {
+#if defined(__x86_64__) || defined(_M_X64)
+    return "x86_64";
+#elif defined(__i386__) || defined(_M_IX86)
+    return "x86";
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    return "aarch64";
+#elif defined(__arm__) || defined(_M_ARM)
+    return "arm";
+#else
+    return "unknown";
+#endif
+}
+
+void run_env_capture(RunEnv* env) {
+    memset(env, 0, sizeof(*env));
+    make_uuid(env->run_id, sizeof(env->run_id));
+    make_timestamp(env->timestamp, sizeof(env->timestamp));
+    copy_str(env->arch, sizeof(env->arch), arch_name());
+    compiler_name(env->compiler, sizeof(env->compiler));
+    copy_str(env->build_type, sizeof(env->build_type), PCBENCH_BUILD_TYPE);
+    copy_trimmed(env->build_flags, sizeof(env->build_flags), PCBENCH_C_FLAGS);
+    env->profile = bench_config_profile();
+
+    const SystemInfo* si = sysinfo_get();
+    copy_str(env->host, sizeof(env->host), si->host);
+    copy_str(env->os, sizeof(env->os), si->os);
+    copy_str(env->os_version, sizeof(env->os_version), si->os_version);
+    copy_str(env->cpu_vendor, sizeof(env->cpu_vendor), si->cpu_vendor);
+    copy_str(env->cpu_model, sizeof(env->cpu_model), si->cpu_model);
+    copy_str(env->cpu_flags, sizeof(env->cpu_flags), si->isa_flags);
+    copy_str(env->governor, sizeof(env->governor), si->governor);
+    copy_str(env->thp, sizeof(env->thp), si->thp);
+    copy_str(env->gpu, sizeof(env->gpu), si->gpu);
+    env->turbo = si->turbo;
+    env->cpu_max_mhz = si->max_mhz;
+    env->logical_cpus = si->logical_cpus;
+    env->physical_cores = si->physical_cores;
+    env->packages = si->packages;
+    env->smt_active = si->smt_active;
+    env->l1d_kb = si->l1d_bytes ? (long)(si->l1d_bytes >> 10) : -1;
+    env->l2_kb = si->l2_bytes ? (long)(si->l2_bytes >> 10) : -1;
+    env->l3_kb = si->l3_bytes ? (long)(si->l3_bytes >> 10) : -1;
+    env->ram_mb = si->ram_bytes > 0 ? (long)(si->ram_bytes >> 20) : -1;
+    env->hugepages_total = si->hugepages_total;
+    env->hugepage_kb = si->hugepage_kb;
+}
@@ -0,0 +1,288 @@
+#include "aio_ring.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ---------------------------------------------------------------------------
+// io_uring backend (no liburing: the three syscalls and ring layout only)
+// ---------------------------------------------------------------------------
+#if defined(HAVE_IO_URING)
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+typedef struct {
+    int       fd;
+    void*     sq_map;
+    void*     cq_map;
+    size_t    sq_map_len, cq_map_len;
+    struct io_uring_sqe* sqes;
+    size_t    sqes_len;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_cqe* cqes;
+    unsigned  to_submit;
+} Uring;
+
+// IORING_OP_READ/WRITE arrived in 5.6, together with the probe. On 5.1-5.5
+// io_uring_setup succeeds but every such request fails with -EINVAL, and the
+// probe itself is rejected, which is how those kernels are told apart.
+static int uring_supports_rw(int fd) {
+    const unsigned nops = 256;
+    struct io_uring_probe* probe = (struct io_uring_probe*)calloc(1,
+        sizeof(*probe) + nops * sizeof(struct io_uring_probe_op));
+    if (!probe) return 0;
+    int ok = 0;
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, nops) == 0) {
+        ok = probe->last_op >= IORING_OP_WRITE && probe->last_op >= IORING_OP_READ
+            && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED)
+            && (probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED);
+    }
+    free(probe);
+    return ok;
+}
+
+static int uring_init(Uring* u, unsigned depth) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    memset(u, 0, sizeof(*u));
+    u->fd = (int)syscall(__NR_io_uring_setup, depth, &p);
+    if (u->fd < 0) return 0;
+    if (!uring_supports_rw(u->fd)) { close(u->fd); return 0; }
+
+    u->sq_map_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    u->cq_map_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    const int single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+        if (u->cq_map_len > u->sq_map_len) u->sq_map_len = u->cq_map_len;
+        u->cq_map_len = 0;
+    }
+
+    u->sq_map = mmap(NULL, u->sq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        u->fd, IORING_OFF_SQ_RING);
+    if (u->sq_map == MAP_FAILED) { close(u->fd); return 0; }
+    u->cq_map = single ? u->sq_map
+        : mmap(NULL, u->cq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            u->fd, IORING_OFF_CQ_RING);
+    u->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    u->sqes = (struct io_uring_sqe*)mmap(NULL, u->sqes_len, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_SQES);
+    if (u->cq_map == MAP_FAILED || u->sqes == MAP_FAILED) {
+        if (u->cq_map != MAP_FAILED && !single) munmap(u->cq_map, u->cq_map_len);
+        if (u->sqes != MAP_FAILED) munmap(u->sqes, u->sqes_len);
+        munmap(u->sq_map, u->sq_map_len);
+        close(u->fd);
+        return 0;
+    }
+
+    char* sq = (char*)u->sq_map;
+    char* cq = (char*)u->cq_map;
+    u->sq_tail = (unsigned*)(sq + p.sq_off.tail);
+    u->sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+    u->sq_array = (unsigned*)(sq + p.sq_off.array);
+    u->cq_head = (unsigned*)(cq + p.cq_off.head);
+    u->cq_tail = (unsigned*)(cq + p.cq_off.tail);
+    u->cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+    u->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    return 1;
+}
+
+static void uring_free(Uring* u) {
+    munmap(u->sqes, u->sqes_len);
+    if (u->cq_map != u->sq_map) munmap(u->cq_map, u->cq_map_len);
+    munmap(u->sq_map, u->sq_map_len);
+    close(u->fd);
+}
+
+static void uring_queue(Uring* u, int fd, int write, void* buf, size_t len, uint64_t off, uint64_t tag) {
+    const unsigned tail = *u->sq_tail;   // only this thread writes the SQ tail
+    const unsigned idx = tail & *u->sq_mask;
+    struct io_uring_sqe* sqe = &u->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = (uint32_t)len;
+    sqe->off = off;
+    sqe->user_data = tag;
+    u->sq_array[idx] = idx;
+    __atomic_store_n(u->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    u->to_submit++;
+}
+
+static int uring_reap(Uring* u, AioCompletion* out, int max, int wait_min) {
+    if (u->to_submit || wait_min > 0) {
+        const unsigned flags = wait_min > 0 ? IORING_ENTER_GETEVENTS : 0;
+        int rc;
+        do {
+            rc = (int)syscall(__NR_io_uring_enter, u->fd, u->to_submit, (unsigned)wait_min, flags, NULL, 0);
+        } while (rc < 0 && errno == EINTR);
+        if (rc < 0) return -1;
+        u->to_submit -= (unsigned)rc < u->to_submit ? (unsigned)rc : u->to_submit;
+    }
+
+    int n = 0;
+    unsigned head = *u->cq_head;
+    const unsigned tail = __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail && n < max) {
+        const struct io_uring_cqe* cqe = &u->cqes[head & *u->cq_mask];
+        out[n].tag = cqe->user_data;
+        out[n].result = cqe->res;
+        ++n;
+        ++head;
+    }
+    __atomic_store_n(u->cq_head, head, __ATOMIC_RELEASE);
+    return n;
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// libaio backend
+// ---------------------------------------------------------------------------
+#if defined(HAVE_LIBAIO)
+#include <libaio.h>
+
+typedef struct {
+    io_context_t     ctx;
+    struct iocb*     cbs;        // one control block per in-flight slot
+    struct iocb**    free_cbs;   // stack of unused slots
+    struct iocb**    pending;    // queued, not yet submitted
+    struct io_event* events;
+    unsigned         nfree, npending;
+} Laio;
+
+static int laio_init(Laio* a, unsigned depth) {
+    memset(a, 0, sizeof(*a));
+    if (io_setup((int)depth, &a->ctx) != 0) return 0;
+    a->cbs = (struct iocb*)calloc(depth, sizeof(struct iocb));
+    a->free_cbs = (struct iocb**)malloc(depth * sizeof(struct iocb*));
+    a->pending = (struct iocb**)malloc(depth * sizeof(struct iocb*));
+    a->events = (struct io_event*)malloc(depth * sizeof(struct io_event));
+    if (!a->cbs || !a->free_cbs || !a->pending || !a->events) {
+        free(a->cbs); free(a->free_cbs); free(a->pending); free(a->events);
+        io_destroy(a->ctx);
+        return 0;
+    }
+    for (unsigned i = 0; i < depth; ++i) a->free_cbs[i] = &a->cbs[i];
+    a->nfree = depth;
+    return 1;
+}
+
+static void laio_free(Laio* a) {
+    io_destroy(a->ctx);
+    free(a->cbs); free(a->free_cbs); free(a->pending); free(a->events);
+}
+
+static void laio_queue(Laio* a, int fd, int write, void* buf, size_t len, uint64_t off, uint64_t tag) {
+    struct iocb* cb = a->free_cbs[--a->nfree];
+    if (write) io_prep_pwrite(cb, fd, buf, len, (long long)off);
+    else       io_prep_pread(cb, fd, buf, len, (long long)off);
+    cb->data = (void*)(uintptr_t)tag;
+    a->pending[a->npending++] = cb;
+}
+
+static int laio_reap(Laio* a, AioCompletion* out, int max, int wait_min) {
+    unsigned done = 0;
+    while (done < a->npending) {
+        const int rc = io_submit(a->ctx, (long)(a->npending - done), a->pending + done);
+        if (rc <= 0) return -1;
+        done += (unsigned)rc;
+    }
+    a->npending = 0;
+
+    const int n = io_getevents(a->ctx, wait_min, max, a->events, NULL);
+    if (n < 0) return -1;
+    for (int i = 0; i < n; ++i) {
+        struct iocb* cb = a->events[i].obj;
+        out[i].tag = (uint64_t)(uintptr_t)cb->data;
+        out[i].result = (long)a->events[i].res;
+        a->free_cbs[a->nfree++] = cb;
+    }
+    return n;
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+
+typedef enum { AIO_URING, AIO_LIBAIO } AioKind;
+
+struct AioRing {
+    AioKind  kind;
+    int      fd;
+    unsigned depth;
+    unsigned in_flight;     // queued + submitted, not yet reaped
+#if defined(HAVE_IO_URING)
+    Uring    uring;
+#endif
+#if defined(HAVE_LIBAIO)
+    Laio     laio;
+#endif
+};
+
+AioRing* aio_ring_create(int fd, unsigned depth) {
+    if (depth == 0) depth = 1;
+    AioRing* r = (AioRing*)calloc(1, sizeof(AioRing));
+    if (!r) return NULL;
+    r->fd = fd;
+    r->depth = depth;
+#if defined(HAVE_IO_URING)
+    // Blocked by seccomp in many containers, or too old for READ/WRITE (< 5.6);
+    // either way that simply means "try the next one"
+    if (uring_init(&r->uring, depth)) { r->kind = AIO_URING; return r; }
+#endif
+#if defined(HAVE_LIBAIO)
+    if (laio_init(&r->laio, depth)) { r->kind = AIO_LIBAIO; return r; }
+#endif
+    free(r);
+    return NULL;
+}
+
+void aio_ring_destroy(AioRing* r) {
+    if (!r) return;
+#if defined(HAVE_IO_URING)
+    if (r->kind == AIO_URING) uring_free(&r->uring);
+#endif
+#if defined(HAVE_LIBAIO)
+    if (r->kind == AIO_LIBAIO) laio_free(&r->laio);
+#endif
+    free(r);
+}
+
+const char* aio_ring_engine(const AioRing* r) {
+    if (!r) return "threads";
+    return (r->kind == AIO_URING) ? "io_uring" : "libaio";
+}
+
+int aio_ring_queue(AioRing* r, int write, void* buf, size_t len, uint64_t off, uint64_t tag) {
+    if (r->in_flight >= r->depth) return 0;
+#if defined(HAVE_IO_URING)
+    if (r->kind == AIO_URING) uring_queue(&r->uring, r->fd, write, buf, len, off, tag);
+#endif
+#if defined(HAVE_LIBAIO)
+    if (r->kind == AIO_LIBAIO) laio_queue(&r->laio, r->fd, write, buf, len, off, tag);
+#endif
+    (void)write; (void)buf; (void)len; (void)off; (void)tag;
+    r->in_flight++;
+    return 1;
+}
+
+int aio_ring_reap(AioRing* r, AioCompletion* out, int max, int wait_min) {
+    int n = -1;
+    if (wait_min > (int)r->in_flight) wait_min = (int)r->in_flight;
+#if defined(HAVE_IO_URING)
+    if (r->kind == AIO_URING) n = uring_reap(&r->uring, out, max, wait_min);
+#endif
+#if defined(HAVE_LIBAIO)
+    if (r->kind == AIO_LIBAIO) n = laio_reap(&r->laio, out, max, wait_min);
+#endif
+    (void)out; (void)max;
+    if (n > 0) r->in_flight -= (unsigned)n;
+    return n;
+}
@@ -0,0 +1,82 @@
+#include "arena.h"
+#include <stdint.h>
+#include "pagemem.h"
+
+#define ARENA_MAX_CHUNKS 64
+#define ARENA_MIN_CHUNK  (64ull * 1024ull * 1024ull)   // small buffers share chunks
+#define ARENA_PAGE       4096ull
+
+typedef struct {
+    uint8_t* base;
+    size_t   size;
+    size_t   used;
+} Chunk;
+
+static Chunk    chunks[ARENA_MAX_CHUNKS];
+static int      nchunks;
+static int      use_huge;
+static unsigned generation = 1;
+
+void arena_set_huge(int on) { use_huge = on; }
+
+// Writes one byte per page so the kernel backs the whole chunk now
+static void prefault(uint8_t* p, size_t n) {
+    for (size_t i = 0; i < n; i += ARENA_PAGE) p[i] = 0;
+}
+
+void* arena_alloc(size_t bytes) {
+    bytes = (bytes + ARENA_PAGE - 1) & ~(size_t)(ARENA_PAGE - 1);
+    if (bytes == 0) bytes = ARENA_PAGE;
+
+    // First fit over existing chunks: later tests reuse what earlier ones faulted in
+    for (int i = 0; i < nchunks; ++i) {
+        Chunk* c = &chunks[i];
+        if (c->size - c->used >= bytes) {
+            void* p = c->base + c->used;
+            c->used += bytes;
+            return p;
+        }
+    }
+
+    // Nothing fits: chunks untouched since the last reset are too small for this
+    // test, so they go before a larger one is mapped. The mapping then never
+    // exceeds what the current test holds plus this request (rounded up to
+    // ARENA_MIN_CHUNK), not the sum of every chunk ever created.
+    int kept = 0;
+    for (int i = 0; i < nchunks; ++i) {
+        if (chunks[i].used == 0) page_free(chunks[i].base, chunks[i].size);
+        else chunks[kept++] = chunks[i];
+    }
+    nchunks = kept;
+
+    if (nchunks == ARENA_MAX_CHUNKS) return NULL;
+    const size_t size = (bytes > ARENA_MIN_CHUNK) ? bytes : ARENA_MIN_CHUNK;
+    uint8_t* base = (uint8_t*)page_alloc(size, use_huge ? PAGE_HUGE : PAGE_SMALL, NULL);
+    if (!base) return NULL;
+    prefault(base, size);
+
+    Chunk* c = &chunks[nchunks++];
+    c->base = base;
+    c->size = size;
+    c->used = bytes;
+    return base;
+}
+
+void arena_reset(void) {
+    for (int i = 0; i < nchunks; ++i) chunks[i].used = 0;
+    generation++;
+}
+
+void arena_release(void) {
+    for (int i = 0; i < nchunks; ++i) page_free(chunks[i].base, chunks[i].size);
+    nchunks = 0;
+    generation++;
+}
+
+size_t arena_mapped_bytes(void) {
+    size_t n = 0;
+    for (int i = 0; i < nchunks; ++i) n += chunks[i].size;
+    return n;
+}
+
+unsigned arena_generation(void) { return generation; }
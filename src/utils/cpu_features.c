@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <string.h>
+#include "cpu_features.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CPU_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+static void cpuid(unsigned leaf, unsigned sub, unsigned r[4]) {
+    int v[4];
+    __cpuidex(v, (int)leaf, (int)sub);
+    r[0] = (unsigned)v[0]; r[1] = (unsigned)v[1]; r[2] = (unsigned)v[2]; r[3] = (unsigned)v[3];
+}
+static unsigned long long xgetbv0(void) { return _xgetbv(0); }
+#else
+#include <cpuid.h>
+static void cpuid(unsigned leaf, unsigned sub, unsigned r[4]) {
+    r[0] = r[1] = r[2] = r[3] = 0;
+    __cpuid_count(leaf, sub, r[0], r[1], r[2], r[3]);
+}
+static unsigned long long xgetbv0(void) {
+    unsigned lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((unsigned long long)hi << 32) | lo;
+}
+#endif
+#endif
+
+static CpuFeatures feats;
+static int probed = 0;
+
+#define BIT(r, n) (((r) >> (n)) & 1u)
+
+static void probe(void) {
+    memset(&feats, 0, sizeof(feats));
+#ifdef CPU_X86
+    unsigned r[4];
+    cpuid(0, 0, r);
+    const unsigned max_leaf = r[0];
+
+    cpuid(1, 0, r);
+    feats.sse2   = BIT(r[3], 26);
+    feats.ssse3  = BIT(r[2], 9);
+    feats.sse41  = BIT(r[2], 19);
+    feats.sse42  = BIT(r[2], 20);
+    feats.popcnt = BIT(r[2], 23);
+    feats.aesni  = BIT(r[2], 25);
+    feats.pclmul = BIT(r[2], 1);
+
+    // AVX state must be enabled by the OS (OSXSAVE + XCR0), not just present
+    const int osxsave = BIT(r[2], 27);
+    const unsigned long long xcr0 = osxsave ? xgetbv0() : 0;
+    const int os_avx = (xcr0 & 0x6) == 0x6;
+    const int os_avx512 = os_avx && (xcr0 & 0xE0) == 0xE0;
+
+    feats.avx = os_avx && BIT(r[2], 28);
+    feats.fma = feats.avx && BIT(r[2], 12);
+
+    if (max_leaf >= 7) {
+        cpuid(7, 0, r);
+        feats.avx2     = feats.avx && BIT(r[1], 5);
+        feats.bmi2     = BIT(r[1], 8);
+        feats.sha      = BIT(r[1], 29);
+        feats.avx512f  = os_avx512 && BIT(r[1], 16);
+        feats.avx512dq = feats.avx512f && BIT(r[1], 17);
+        feats.avx512bw = feats.avx512f && BIT(r[1], 30);
+        feats.avx512vl = feats.avx512f && BIT(r[1], 31);
+        feats.vaes     = feats.avx && BIT(r[2], 9);
+        feats.vpclmul  = feats.avx && BIT(r[2], 10);
+    }
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+    feats.neon = 1;   // mandatory on AArch64
+#endif
+}
+
+int cpu_cpuid(unsigned leaf, unsigned sub, unsigned r[4]) {
+#ifdef CPU_X86
+    cpuid(leaf, sub, r);
+    return 1;
+#else
+    (void)leaf; (void)sub;
+    r[0] = r[1] = r[2] = r[3] = 0;
+    return 0;
+#endif
+}
+
+const CpuFeatures* cpu_features(void) {
+    if (!probed) { probe(); probed = 1; }
+    return &feats;
+}
+
+void cpu_features_str(char* buffer, size_t max_len) {
+    const CpuFeatures* f = cpu_features();
+    const struct { int on; const char* name; } flags[] = {
+        { f->sse2, "sse2" }, { f->ssse3, "ssse3" }, { f->sse41, "sse4.1" }, { f->sse42, "sse4.2" },
+        { f->popcnt, "popcnt" }, { f->avx, "avx" }, { f->avx2, "avx2" }, { f->fma, "fma" },
+        { f->bmi2, "bmi2" }, { f->avx512f, "avx512f" }, { f->avx512dq, "avx512dq" },
+        { f->avx512bw, "avx512bw" }, { f->avx512vl, "avx512vl" }, { f->aesni, "aes" },
+        { f->pclmul, "pclmul" }, { f->vaes, "vaes" }, { f->vpclmul, "vpclmulqdq" },
+        { f->sha, "sha" }, { f->neon, "neon" }
+    };
+    size_t used = 0;
+    if (max_len == 0) return;
+    buffer[0] = '\0';
+    for (size_t i = 0; i < sizeof(flags) / sizeof(flags[0]); ++i) {
+        if (!flags[i].on) continue;
+        int w = snprintf(buffer + used, max_len - used, "%s%s", used ? " " : "", flags[i].name);
+        if (w < 0 || (size_t)w >= max_len - used) break;
+        used += (size_t)w;
+    }
+}
@@ -0,0 +1,199 @@
+#include <stdlib.h>
+#include <string.h>
+#include "json_read.h"
+
+#define JSON_MAX_DEPTH 64
+
+static const char* skip_ws(const char* p) {
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') ++p;
+    return p;
+}
+
+static int hex4(const char* p, unsigned* out) {
+    unsigned v = 0;
+    for (int i = 0; i < 4; ++i) {
+        const char c = p[i];
+        v <<= 4;
+        if (c >= '0' && c <= '9') v |= (unsigned)(c - '0');
+        else if (c >= 'a' && c <= 'f') v |= (unsigned)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') v |= (unsigned)(c - 'A' + 10);
+        else return 0;
+    }
+    *out = v;
+    return 1;
+}
+
+static size_t put_utf8(char* o, unsigned cp) {
+    if (cp < 0x80) { o[0] = (char)cp; return 1; }
+    if (cp < 0x800) { o[0] = (char)(0xC0 | (cp >> 6)); o[1] = (char)(0x80 | (cp & 0x3F)); return 2; }
+    if (cp < 0x10000) {
+        o[0] = (char)(0xE0 | (cp >> 12)); o[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        o[2] = (char)(0x80 | (cp & 0x3F)); return 3;
+    }
+    o[0] = (char)(0xF0 | (cp >> 18)); o[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    o[2] = (char)(0x80 | ((cp >> 6) & 0x3F)); o[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+// p points after the opening quote; the unescaped text never outgrows the escaped one
+static const char* parse_string(const char* p, char** out) {
+    const char* q = p;
+    while (*q && *q != '"') q += (*q == '\\' && q[1]) ? 2 : 1;
+    if (*q != '"') return NULL;
+    char* s = (char*)malloc((size_t)(q - p) + 1);
+    if (!s) return NULL;
+    size_t n = 0;
+    while (p < q) {
+        if (*p != '\\') {
+            s[n++] = *p++;
+            continue;
+        }
+        ++p;
+        switch (*p) {
+        case 'n': s[n++] = '\n'; break;
+        case 't': s[n++] = '\t'; break;
+        case 'r': s[n++] = '\r'; break;
+        case 'b': s[n++] = '\b'; break;
+        case 'f': s[n++] = '\f'; break;
+        case 'u': {
+            unsigned cp;
+            if (p + 4 >= q || !hex4(p + 1, &cp)) { free(s); return NULL; }
+            p += 4;
+            // Surrogate pair
+            unsigned lo;
+            if (cp >= 0xD800 && cp < 0xDC00 && p + 6 < q && p[1] == '\\' && p[2] == 'u' &&
+                hex4(p + 3, &lo) && lo >= 0xDC00 && lo < 0xE000) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                p += 6;
+            }
+            n += put_utf8(s + n, cp);
+            break;
+        }
+        default: s[n++] = *p; break;   // \" \\ \/
+        }
+        ++p;
+    }
+    s[n] = '\0';
+    *out = s;
+    return q + 1;
+}
+
+static const char* parse_value(const char* p, JsonValue* v, int depth);
+
+// Grows the item (and key) arrays by doubling
+static int push_slot(JsonValue* v, int* cap, int with_key) {
+    if (v->count < *cap) return 1;
+    const int ncap = *cap ? *cap * 2 : 8;
+    JsonValue* items = (JsonValue*)realloc(v->items, (size_t)ncap * sizeof(JsonValue));
+    if (!items) return 0;
+    v->items = items;
+    if (with_key) {
+        char** keys = (char**)realloc(v->keys, (size_t)ncap * sizeof(char*));
+        if (!keys) return 0;
+        v->keys = keys;
+    }
+    *cap = ncap;
+    return 1;
+}
+
+static const char* parse_container(const char* p, JsonValue* v, int depth, int object) {
+    const char close = object ? '}' : ']';
+    int cap = 0;
+    v->type = object ? JSON_OBJECT : JSON_ARRAY;
+    p = skip_ws(p);
+    if (*p == close) return p + 1;
+    for (;;) {
+        if (!push_slot(v, &cap, object)) return NULL;
+        if (object) {
+            p = skip_ws(p);
+            if (*p != '"') return NULL;
+            char* key = NULL;
+            p = parse_string(p + 1, &key);
+            if (!p) return NULL;
+            v->keys[v->count] = key;
+            p = skip_ws(p);
+            if (*p != ':') {
+                v->items[v->count].type = JSON_NULL;
+                v->count++;
+                return NULL;
+            }
+            ++p;
+        }
+        memset(&v->items[v->count], 0, sizeof(JsonValue));
+        p = parse_value(p, &v->items[v->count], depth + 1);
+        v->count++;
+        if (!p) return NULL;
+        p = skip_ws(p);
+        if (*p == ',') { ++p; continue; }
+        if (*p == close) return p + 1;
+        return NULL;
+    }
+}
+
+static const char* parse_value(const char* p, JsonValue* v, int depth) {
+    memset(v, 0, sizeof(*v));
+    if (depth > JSON_MAX_DEPTH) return NULL;
+    p = skip_ws(p);
+    switch (*p) {
+    case '{': return parse_container(p + 1, v, depth, 1);
+    case '[': return parse_container(p + 1, v, depth, 0);
+    case '"': v->type = JSON_STRING; return parse_string(p + 1, &v->string);
+    case 't': if (strncmp(p, "true", 4) == 0) { v->type = JSON_BOOL; v->number = 1.0; return p + 4; } return NULL;
+    case 'f': if (strncmp(p, "false", 5) == 0) { v->type = JSON_BOOL; return p + 5; } return NULL;
+    case 'n': if (strncmp(p, "null", 4) == 0) { v->type = JSON_NULL; return p + 4; } return NULL;
+    default: {
+        char* end = NULL;
+        v->number = strtod(p, &end);
+        if (end == p) return NULL;
+        v->type = JSON_NUMBER;
+        return end;
+    }
+    }
+}
+
+const char* json_parse(const char* text, JsonValue* out) {
+    const char* end = parse_value(text, out, 0);
+    if (!end) json_free(out);
+    return end;
+}
+
+void json_free(JsonValue* v) {
+    if (!v) return;
+    for (int i = 0; i < v->count; ++i) {
+        if (v->items) json_free(&v->items[i]);
+        if (v->keys) free(v->keys[i]);
+    }
+    free(v->items);
+    free(v->keys);
+    free(v->string);
+    memset(v, 0, sizeof(*v));
+}
+
+const JsonValue* json_get(const JsonValue* obj, const char* key) {
+    if (!obj || obj->type != JSON_OBJECT) return NULL;
+    for (int i = 0; i < obj->count; ++i) {
+        if (strcmp(obj->keys[i], key) == 0) return &obj->items[i];
+    }
+    return NULL;
+}
+
+double json_get_number(const JsonValue* obj, const char* key, double fallback) {
+    const JsonValue* v = json_get(obj, key);
+    return (v && v->type == JSON_NUMBER) ? v->number : fallback;
+}
+
+const char* json_get_string(const JsonValue* obj, const char* key) {
+    const JsonValue* v = json_get(obj, key);
+    return (v && v->type == JSON_STRING) ? v->string : NULL;
+}
+
+void json_write_string(FILE* f, const char* s) {
+    fputc('"', f);
+    for (; s && *s; ++s) {
+        const unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(f, "\\%c", c);
+        else if (c < 0x20) fprintf(f, "\\u%04x", c);
+        else fputc(c, f);
+    }
+    fputc('"', f);
+}
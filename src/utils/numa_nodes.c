@@ -0,0 +1,59 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "numa_nodes.h"
+#include "threadpool.h"
+
+static NumaNode nodes[NUMA_MAX_NODES];
+static int      node_count = 0;
+
+int numa_parse_cpulist(const char* s, int* cpus, int cap) {
+    int n = 0;
+    while (s && *s && n < cap) {
+        char* end;
+        long lo = strtol(s, &end, 10);
+        if (end == s) break;
+        long hi = lo;
+        s = end;
+        if (*s == '-') {
+            hi = strtol(s + 1, &end, 10);
+            s = end;
+        }
+        for (long c = lo; c <= hi && n < cap; ++c) cpus[n++] = (int)c;
+        if (*s == ',') ++s;
+        else break;
+    }
+    return n;
+}
+
+static void single_node_fallback(void) {
+    const int hw = pool_hw_threads();
+    nodes[0].id = 0;
+    nodes[0].ncpus = (hw < NUMA_MAX_CPUS) ? hw : NUMA_MAX_CPUS;
+    for (int i = 0; i < nodes[0].ncpus; ++i) nodes[0].cpus[i] = i;
+    node_count = 1;
+}
+
+const NumaNode* numa_nodes(int* count) {
+    if (node_count == 0) {
+#ifdef __linux__
+        // Node ids can be sparse (node0, node2...), so probe the whole range
+        for (int id = 0; id < 1024 && node_count < NUMA_MAX_NODES; ++id) {
+            char path[96], line[4096];
+            snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", id);
+            FILE* f = fopen(path, "r");
+            if (!f) continue;
+            if (fgets(line, sizeof(line), f)) {
+                NumaNode* nd = &nodes[node_count];
+                nd->id = id;
+                nd->ncpus = numa_parse_cpulist(line, nd->cpus, NUMA_MAX_CPUS);
+                if (nd->ncpus > 0) node_count++;   // memory-only nodes have no CPUs
+            }
+            fclose(f);
+        }
+#endif
+        if (node_count == 0) single_node_fallback();
+    }
+    if (count) *count = node_count;
+    return nodes;
+}
@@ -0,0 +1,78 @@
+#include "pagemem.h"
+
+#define HUGE_2M (2ull * 1024ull * 1024ull)
+
+// Every mapping is rounded to 2 MiB so page_free() can recompute the length
+// without knowing which kind of page backed it.
+static size_t round_len(size_t bytes) {
+    if (bytes == 0) bytes = 1;
+    return (bytes + HUGE_2M - 1) & ~(size_t)(HUGE_2M - 1);
+}
+
+// WINDOWS IMPLEMENTATION
+#if defined(_WIN32)
+#include <windows.h>
+
+void* page_alloc(size_t bytes, int kind, int* got_huge) {
+    const size_t len = round_len(bytes);
+    if (got_huge) *got_huge = 0;
+    if (kind == PAGE_HUGE) {
+        // Needs SeLockMemoryPrivilege; silently falls back without it
+        void* p = VirtualAlloc(NULL, len, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        if (p) { if (got_huge) *got_huge = 1; return p; }
+    }
+    return VirtualAlloc(NULL, len, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+void page_free(void* p, size_t bytes) {
+    (void)bytes;
+    if (p) VirtualFree(p, 0, MEM_RELEASE);
+}
+
+// LINUX & MACOS IMPLEMENTATION
+#else
+#include <stdint.h>
+#include <sys/mman.h>
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+void* page_alloc(size_t bytes, int kind, int* got_huge) {
+    const size_t len = round_len(bytes);
+    if (got_huge) *got_huge = 0;
+
+#ifdef MAP_HUGETLB
+    // Explicit hugetlbfs pool first (vm.nr_hugepages), it is the only hard guarantee
+    if (kind == PAGE_HUGE) {
+        void* p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) { if (got_huge) *got_huge = 1; return p; }
+    }
+#endif
+
+    // Over-map by 2 MiB and trim so the region is 2 MiB aligned (THP eligible)
+    uint8_t* raw = (uint8_t*)mmap(NULL, len + HUGE_2M, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == (uint8_t*)MAP_FAILED) return NULL;
+    uint8_t* p = (uint8_t*)(((uintptr_t)raw + HUGE_2M - 1) & ~(uintptr_t)(HUGE_2M - 1));
+    const size_t head = (size_t)(p - raw);
+    if (head) munmap(raw, head);
+    if (HUGE_2M - head) munmap(p + len, HUGE_2M - head);
+
+#ifdef MADV_HUGEPAGE
+    if (kind == PAGE_HUGE && madvise(p, len, MADV_HUGEPAGE) == 0) {
+        if (got_huge) *got_huge = 1;   // transparent huge pages advised
+    }
+#endif
+#ifdef MADV_NOHUGEPAGE
+    // Keep "small" honest even when THP is set to always
+    if (kind == PAGE_SMALL) (void)madvise(p, len, MADV_NOHUGEPAGE);
+#endif
+    return p;
+}
+
+void page_free(void* p, size_t bytes) {
+    if (p) munmap(p, round_len(bytes));
+}
+#endif
@@ -0,0 +1,125 @@
+#include "stats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "util.h"
+
+static int cmp_double(const void* a, const void* b) {
+    const double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+double stats_percentile(const double* sorted, int n, double p) {
+    if (n <= 0) return 0.0;
+    if (p <= 0.0) return sorted[0];
+    if (p >= 1.0) return sorted[n - 1];
+    const double pos = p * (double)(n - 1);
+    const int i = (int)pos;
+    const double frac = pos - (double)i;
+    return (i + 1 < n) ? sorted[i] + frac * (sorted[i + 1] - sorted[i]) : sorted[i];
+}
+
+// Median of n values drawn with replacement from v (scratch holds n values)
+static double resample_median(const double* v, int n, double* scratch, uint64_t* rng) {
+    for (int i = 0; i < n; ++i) scratch[i] = v[splitmix64(rng) % (uint64_t)n];
+    qsort(scratch, (size_t)n, sizeof(double), cmp_double);
+    return stats_percentile(scratch, n, 0.5);
+}
+
+void stats_summarize(const double* v, int n, SampleStats* out) {
+    memset(out, 0, sizeof(*out));
+    if (n <= 0) return;
+    out->n = n;
+
+    double* sorted = (double*)malloc((size_t)n * sizeof(double));
+    if (!sorted) return;
+    memcpy(sorted, v, (size_t)n * sizeof(double));
+    qsort(sorted, (size_t)n, sizeof(double), cmp_double);
+
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i) sum += v[i];
+    out->mean = sum / (double)n;
+
+    // Two-pass variance: the samples are large and close together
+    double ss = 0.0;
+    for (int i = 0; i < n; ++i) ss += (v[i] - out->mean) * (v[i] - out->mean);
+    out->stddev = (n > 1) ? sqrt(ss / (double)(n - 1)) : 0.0;
+    out->cv = (out->mean != 0.0) ? out->stddev / out->mean : 0.0;
+
+    out->minv = sorted[0];
+    out->maxv = sorted[n - 1];
+    out->median = stats_percentile(sorted, n, 0.5);
+    out->p5 = stats_percentile(sorted, n, 0.05);
+    out->p95 = stats_percentile(sorted, n, 0.95);
+    out->ci_lo = out->ci_hi = out->median;
+
+    // Percentile bootstrap of the median; fixed seed keeps reports reproducible
+    double* medians = (double*)malloc(STATS_BOOTSTRAP * sizeof(double));
+    double* scratch = (double*)malloc((size_t)n * sizeof(double));
+    if (n > 1 && medians && scratch) {
+        uint64_t rng = 0xB0075742ull;
+        for (int b = 0; b < STATS_BOOTSTRAP; ++b) medians[b] = resample_median(v, n, scratch, &rng);
+        qsort(medians, STATS_BOOTSTRAP, sizeof(double), cmp_double);
+        const double tail = (1.0 - STATS_CI_LEVEL) / 2.0;
+        out->ci_lo = stats_percentile(medians, STATS_BOOTSTRAP, tail);
+        out->ci_hi = stats_percentile(medians, STATS_BOOTSTRAP, 1.0 - tail);
+    }
+    free(scratch);
+    free(medians);
+    free(sorted);
+}
+
+double stats_ci_rel_width(const SampleStats* s) {
+    return (s->median != 0.0) ? (s->ci_hi - s->ci_lo) / fabs(s->median) : 0.0;
+}
+
+typedef struct { double v; int group; } RankItem;
+
+static int cmp_rank_item(const void* a, const void* b) {
+    const double x = ((const RankItem*)a)->v, y = ((const RankItem*)b)->v;
+    return (x > y) - (x < y);
+}
+
+double stats_mann_whitney(const double* a, int na, const double* b, int nb, double* effect) {
+    if (effect) *effect = 0.0;
+    if (na < 1 || nb < 1) return 1.0;
+    const int n = na + nb;
+    RankItem* all = (RankItem*)malloc((size_t)n * sizeof(RankItem));
+    if (!all) return 1.0;
+    for (int i = 0; i < na; ++i) { all[i].v = a[i]; all[i].group = 0; }
+    for (int i = 0; i < nb; ++i) { all[na + i].v = b[i]; all[na + i].group = 1; }
+    qsort(all, (size_t)n, sizeof(RankItem), cmp_rank_item);
+
+    // Tied values share the average of their ranks
+    double rank_sum_a = 0.0, ties = 0.0;
+    for (int i = 0; i < n;) {
+        int j = i;
+        while (j + 1 < n && all[j + 1].v == all[i].v) ++j;
+        const double rank = 0.5 * (double)(i + j) + 1.0;
+        for (int k = i; k <= j; ++k) {
+            if (all[k].group == 0) rank_sum_a += rank;
+        }
+        const double t = (double)(j - i + 1);
+        ties += t * t * t - t;
+        i = j + 1;
+    }
+    free(all);
+
+    const double u = rank_sum_a - 0.5 * (double)na * (double)(na + 1);
+    const double nn = (double)na * (double)nb;
+    if (effect) *effect = 2.0 * u / nn - 1.0;
+
+    const double var = nn / 12.0 * (((double)n + 1.0) - ties / ((double)n * (double)(n - 1)));
+    if (var <= 0.0) return 1.0;   // every value equal
+    const double diff = fabs(u - 0.5 * nn) - 0.5;
+    const double z = (diff > 0.0 ? diff : 0.0) / sqrt(var);
+    return erfc(z / sqrt(2.0));
+}
+
+double stats_mann_whitney_min_p(int na, int nb) {
+    if (na < 1 || nb < 1) return 1.0;
+    const double nn = (double)na * (double)nb;
+    const double var = nn / 12.0 * ((double)(na + nb) + 1.0);
+    const double z = (0.5 * nn - 0.5) / sqrt(var);
+    return z > 0.0 ? erfc(z / sqrt(2.0)) : 1.0;
+}
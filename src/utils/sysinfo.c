@@ -2,127 +2,448 @@
 #include <string.h>
 #include <stdlib.h>
 #include "sysinfo.h"
+#include "cpu_features.h"
+#include "topology.h"
 
-
-// WINDOWS IMPLEMENTATION
 #ifdef _WIN32
 #include <windows.h>
-#include <intrin.h>
+#else
+#include <unistd.h>
+#include <sys/utsname.h>
+#endif
 
-static void get_gpu_name(char* buffer, int max_len) {
-    DISPLAY_DEVICEA dd;
-    dd.cb = sizeof(dd);
-    if (EnumDisplayDevicesA(NULL, 0, &dd, 0)) {
-        strncpy_s(buffer, max_len, dd.DeviceString, _TRUNCATE);
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+static SystemInfo info;
+static int collected = 0;
+
+static void copy_str(char* dst, size_t n, const char* src) {
+    while (src && (*src == ' ' || *src == '\t')) ++src;
+    size_t len = 0;
+    for (; src && src[len] && len + 1 < n; ++len) dst[len] = src[len];
+    dst[len] = '\0';
+    while (len > 0 && (dst[len - 1] == ' ' || dst[len - 1] == '\n')) dst[--len] = '\0';
+}
+
+static void set_cache(int level, int type, size_t bytes, int line) {
+    // type: 1 data, 2 instruction, 3 unified (CPUID numbering)
+    if (bytes == 0) return;
+    if (level == 1 && type == 2) info.l1i_bytes = bytes;
+    else if (level == 1) info.l1d_bytes = bytes;
+    else if (level == 2) info.l2_bytes = bytes;
+    else if (level == 3) info.l3_bytes = bytes;
+    if (type != 2 && level >= info.llc_level) {
+        info.llc_level = level;
+        info.llc_bytes = bytes;
+    }
+    if (line > 0 && info.cache_line <= 0) info.cache_line = line;
+}
+
+// Vendor, brand string, family/model/stepping, nominal and max clock
+static void cpuid_identity(void) {
+    unsigned r[4];
+    if (!cpu_cpuid(0, 0, r)) return;
+    const unsigned max_leaf = r[0];
+    memcpy(info.cpu_vendor, &r[1], 4);
+    memcpy(info.cpu_vendor + 4, &r[3], 4);
+    memcpy(info.cpu_vendor + 8, &r[2], 4);
+    info.cpu_vendor[12] = '\0';
+
+    if (max_leaf >= 1) {
+        cpu_cpuid(1, 0, r);
+        const int base_family = (int)((r[0] >> 8) & 0xf);
+        int model = (int)((r[0] >> 4) & 0xf);
+        info.cpu_family = base_family == 0xf ? base_family + (int)((r[0] >> 20) & 0xff) : base_family;
+        if (base_family == 0x6 || base_family == 0xf) model |= (int)((r[0] >> 12) & 0xf0);
+        info.cpu_model_id = model;
+        info.cpu_stepping = (int)(r[0] & 0xf);
     }
-    else {
-        strncpy_s(buffer, max_len, "Unknown GPU", _TRUNCATE);
+    // Leaf 0x16 is Intel-only and often zero under hypervisors
+    if (max_leaf >= 0x16) {
+        cpu_cpuid(0x16, 0, r);
+        if ((r[0] & 0xffff) != 0) info.base_mhz = (int)(r[0] & 0xffff);
+        if ((r[1] & 0xffff) != 0) info.max_mhz = (int)(r[1] & 0xffff);
+    }
+
+    cpu_cpuid(0x80000000u, 0, r);
+    if (r[0] >= 0x80000004u) {
+        char brand[49];
+        for (unsigned i = 0; i < 3; ++i) {
+            cpu_cpuid(0x80000002u + i, 0, r);
+            memcpy(brand + 16 * i, r, 16);
+        }
+        brand[48] = '\0';
+        copy_str(info.cpu_model, sizeof(info.cpu_model), brand);
     }
 }
 
-static void get_os_name(char* buffer, int max_len) {
-    HKEY hKey;
-    char productName[256] = "Windows (Unknown)";
-    DWORD bufLen = sizeof(productName);
-    if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, "SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion",
-        0, KEY_QUERY_VALUE, &hKey) == ERROR_SUCCESS) {
-        RegQueryValueExA(hKey, "ProductName", NULL, NULL, (LPBYTE)productName, &bufLen);
-        RegCloseKey(hKey);
+// Deterministic cache parameters: leaf 4 on Intel, 0x8000001D on AMD/Hygon
+static void cpuid_caches(void) {
+    unsigned r[4];
+    if (!cpu_cpuid(0, 0, r)) return;
+    unsigned leaf = 4;
+    if (strcmp(info.cpu_vendor, "GenuineIntel") != 0) {
+        cpu_cpuid(0x80000000u, 0, r);
+        if (r[0] < 0x8000001Du) return;
+        leaf = 0x8000001Du;
+    } else if (r[0] < 4) {
+        return;
+    }
+    for (unsigned sub = 0; sub < 16; ++sub) {
+        cpu_cpuid(leaf, sub, r);
+        const int type = (int)(r[0] & 0x1f);
+        if (type == 0) break;
+        const int level = (int)((r[0] >> 5) & 0x7);
+        const size_t line = (r[1] & 0xfff) + 1;
+        const size_t parts = ((r[1] >> 12) & 0x3ff) + 1;
+        const size_t ways = ((r[1] >> 22) & 0x3ff) + 1;
+        const size_t sets = (size_t)r[2] + 1;
+        set_cache(level, type, ways * parts * line * sets, (int)line);
     }
-    strncpy_s(buffer, max_len, productName, _TRUNCATE);
 }
 
-API void get_system_info_str(char* buffer, int max_len) {
-    // CPU Brand
-    int cpuInfo[4] = { -1 };
-    char cpu_brand[0x40];
-    memset(cpu_brand, 0, sizeof(cpu_brand));
-    __cpuid(cpuInfo, 0x80000000);
-    if (cpuInfo[0] >= 0x80000004) {
-        __cpuid(cpuInfo, 0x80000002); memcpy(cpu_brand, cpuInfo, 16);
-        __cpuid(cpuInfo, 0x80000003); memcpy(cpu_brand + 16, cpuInfo, 16);
-        __cpuid(cpuInfo, 0x80000004); memcpy(cpu_brand + 32, cpuInfo, 16);
-    }
-    else strcpy_s(cpu_brand, sizeof(cpu_brand), "Unknown CPU");
-
-    // RAM
-    MEMORYSTATUSEX statex;
-    statex.dwLength = sizeof(statex);
-    GlobalMemoryStatusEx(&statex);
-    double ram_gb = (double)statex.ullTotalPhys / (1024 * 1024 * 1024);
+#ifdef __linux__
+static int read_line(const char* path, char* out, size_t n) {
+    FILE* f = fopen(path, "r");
+    if (!f) return 0;
+    const int ok = fgets(out, (int)n, f) != NULL;
+    fclose(f);
+    if (ok) out[strcspn(out, "\n")] = '\0';
+    return ok;
+}
 
-    // Cores
-    SYSTEM_INFO sysInfo;
-    GetSystemInfo(&sysInfo);
-    int num_cores = sysInfo.dwNumberOfProcessors;
+static long read_long(const char* path, long fallback) {
+    char line[64];
+    return read_line(path, line, sizeof(line)) ? atol(line) : fallback;
+}
 
-    // GPU & OS
-    char gpu_name[128]; get_gpu_name(gpu_name, sizeof(gpu_name));
-    char os_name[128];  get_os_name(os_name, sizeof(os_name));
+// First processor block only; x86 "model name", Arm "Processor"/"CPU implementer"
+static void parse_cpuinfo(void) {
+    FILE* f = fopen("/proc/cpuinfo", "r");
+    if (!f) return;
+    char line[1024];
+    int have_model = info.cpu_model[0] != '\0';
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '\n') break;
+        char* colon = strchr(line, ':');
+        if (!colon) continue;
+        char* key_end = colon;
+        while (key_end > line && (key_end[-1] == ' ' || key_end[-1] == '\t')) --key_end;
+        *key_end = '\0';
+        const char* v = colon + 1;
+        if (strcmp(line, "vendor_id") == 0 && !info.cpu_vendor[0]) {
+            copy_str(info.cpu_vendor, sizeof(info.cpu_vendor), v);
+        } else if (strcmp(line, "CPU implementer") == 0 && !info.cpu_vendor[0]) {
+            copy_str(info.cpu_vendor, sizeof(info.cpu_vendor), v);
+        } else if ((strcmp(line, "model name") == 0 || strcmp(line, "Processor") == 0) && !have_model) {
+            copy_str(info.cpu_model, sizeof(info.cpu_model), v);
+            have_model = 1;
+        } else if (strcmp(line, "cpu family") == 0 && info.cpu_family < 0) {
+            info.cpu_family = atoi(v);
+        } else if (strcmp(line, "model") == 0 && info.cpu_model_id < 0) {
+            info.cpu_model_id = atoi(v);
+        } else if (strcmp(line, "stepping") == 0 && info.cpu_stepping < 0) {
+            info.cpu_stepping = atoi(v);
+        }
+    }
+    fclose(f);
+}
 
-    snprintf(buffer, max_len,
-        "OS:  %s\nCPU: %s\n     (%d Logical Cores)\nGPU: %s\nRAM: %.1f GB",
-        os_name, cpu_brand, num_cores, gpu_name, ram_gb);
+static void sys_caches(void) {
+    char path[128], line[64];
+    for (int idx = 0; idx < 16; ++idx) {
+        const char* base = "/sys/devices/system/cpu/cpu0/cache/index%d/%s";
+        snprintf(path, sizeof(path), base, idx, "level");
+        const long level = read_long(path, -1);
+        if (level < 0) break;
+        snprintf(path, sizeof(path), base, idx, "type");
+        if (!read_line(path, line, sizeof(line))) continue;
+        const int type = strcmp(line, "Data") == 0 ? 1 : strcmp(line, "Instruction") == 0 ? 2 : 3;
+        snprintf(path, sizeof(path), base, idx, "size");
+        size_t bytes = 0;
+        if (read_line(path, line, sizeof(line))) {
+            char* end;
+            bytes = (size_t)strtoul(line, &end, 10);
+            if (*end == 'K') bytes <<= 10;
+            else if (*end == 'M') bytes <<= 20;
+        }
+        snprintf(path, sizeof(path), base, idx, "coherency_line_size");
+        set_cache((int)level, type, bytes, (int)read_long(path, 0));
+    }
 }
 
-// LINUX & MACOS IMPLEMENTATION
-#else
-#include <unistd.h>
-#include <sys/utsname.h>
+static void sys_cpufreq(void) {
+    const char* dir = "/sys/devices/system/cpu/cpu0/cpufreq";
+    char path[128];
+    snprintf(path, sizeof(path), "%s/scaling_governor", dir);
+    (void)read_line(path, info.governor, sizeof(info.governor));
+
+    // kHz in sysfs
+    snprintf(path, sizeof(path), "%s/cpuinfo_max_freq", dir);
+    long khz = read_long(path, -1);
+    if (khz > 0) info.max_mhz = (int)(khz / 1000);
+    snprintf(path, sizeof(path), "%s/cpuinfo_min_freq", dir);
+    khz = read_long(path, -1);
+    if (khz > 0) info.min_mhz = (int)(khz / 1000);
+    snprintf(path, sizeof(path), "%s/base_frequency", dir);
+    khz = read_long(path, -1);
+    if (khz > 0) info.base_mhz = (int)(khz / 1000);
+
+    // intel_pstate inverts the sense; acpi-cpufreq and amd-pstate expose boost
+    const long no_turbo = read_long("/sys/devices/system/cpu/intel_pstate/no_turbo", -1);
+    if (no_turbo >= 0) {
+        info.turbo = no_turbo == 0;
+        return;
+    }
+    long boost = read_long("/sys/devices/system/cpu/cpufreq/boost", -1);
+    if (boost < 0) {
+        snprintf(path, sizeof(path), "%s/boost", dir);
+        boost = read_long(path, -1);
+    }
+    if (boost >= 0) info.turbo = boost != 0;
+}
 
-// Helper to run a shell command and get the first line of output
-static void get_cmd_output(const char* cmd, char* buffer, int max_len) {
-    FILE* fp = popen(cmd, "r");
-    if (fp) {
-        if (fgets(buffer, max_len, fp) != NULL) {
-            // Remove newline at end
-            buffer[strcspn(buffer, "\n")] = 0;
+static void sys_memory(void) {
+    FILE* f = fopen("/proc/meminfo", "r");
+    if (f) {
+        char line[256];
+        while (fgets(line, sizeof(line), f)) {
+            char key[64];
+            long long v;
+            if (sscanf(line, "%63[^:]: %lld", key, &v) != 2) continue;
+            if (strcmp(key, "MemTotal") == 0) info.ram_bytes = v * 1024;
+            else if (strcmp(key, "MemAvailable") == 0) info.ram_available_bytes = v * 1024;
+            else if (strcmp(key, "HugePages_Total") == 0) info.hugepages_total = (long)v;
+            else if (strcmp(key, "HugePages_Free") == 0) info.hugepages_free = (long)v;
+            else if (strcmp(key, "Hugepagesize") == 0) info.hugepage_kb = (long)v;
         }
-        else {
-            strncpy(buffer, "Unknown", max_len);
+        fclose(f);
+    }
+
+    // "always [madvise] never": the bracketed word is the mode
+    char buf[128];
+    if (read_line("/sys/kernel/mm/transparent_hugepage/enabled", buf, sizeof(buf))) {
+        const char* lb = strchr(buf, '[');
+        const char* rb = lb ? strchr(lb, ']') : NULL;
+        if (lb && rb) snprintf(info.thp, sizeof(info.thp), "%.*s", (int)(rb - lb - 1), lb + 1);
+    }
+}
+
+static const char* pci_vendor_name(long id) {
+    switch (id) {
+    case 0x8086: return "Intel";
+    case 0x1002: return "AMD";
+    case 0x10de: return "NVIDIA";
+    case 0x13b5: return "Arm";
+    case 0x5143: return "Qualcomm";
+    case 0x1af4: return "virtio";
+    case 0x15ad: return "VMware";
+    case 0x1234: return "QEMU";
+    default:     return NULL;
+    }
+}
+
+// First DRM card: PCI vendor:device and the bound kernel driver (what lspci would name)
+static void sys_gpu(void) {
+    char path[128], link[256];
+    for (int card = 0; card < 8; ++card) {
+        snprintf(path, sizeof(path), "/sys/class/drm/card%d/device/driver", card);
+        const ssize_t n = readlink(path, link, sizeof(link) - 1);
+        if (n <= 0) continue;
+        link[n] = '\0';
+        const char* slash = strrchr(link, '/');
+        const char* driver = slash ? slash + 1 : link;
+
+        char line[32];
+        snprintf(path, sizeof(path), "/sys/class/drm/card%d/device/vendor", card);
+        if (!read_line(path, line, sizeof(line))) {
+            copy_str(info.gpu, sizeof(info.gpu), driver);
+            return;
         }
-        pclose(fp);
+        const long vendor = strtol(line, NULL, 16);
+        snprintf(path, sizeof(path), "/sys/class/drm/card%d/device/device", card);
+        const long device = read_line(path, line, sizeof(line)) ? strtol(line, NULL, 16) : 0;
+        const char* name = pci_vendor_name(vendor);
+        snprintf(info.gpu, sizeof(info.gpu), "%.48s%s[%04lx:%04lx] (%.48s)",
+            name ? name : "", name ? " " : "", vendor, device, driver);
+        return;
     }
-    else {
-        strncpy(buffer, "Error", max_len);
+}
+#endif
+
+#if defined(__APPLE__)
+static long long sysctl_num(const char* name) {
+    long long v = 0;
+    size_t sz = sizeof(v);
+    if (sysctlbyname(name, &v, &sz, NULL, 0) != 0) return -1;
+    // Some entries are 32-bit
+    if (sz == sizeof(int)) { int i; memcpy(&i, &v, sizeof(i)); return i; }
+    return v;
+}
+
+static void collect_apple(void) {
+    size_t sz = sizeof(info.cpu_model);
+    if (!info.cpu_model[0] && sysctlbyname("machdep.cpu.brand_string", info.cpu_model, &sz, NULL, 0) != 0) {
+        info.cpu_model[0] = '\0';
     }
+    long long v;
+    if ((v = sysctl_num("hw.physicalcpu")) > 0) info.physical_cores = (int)v;
+    if ((v = sysctl_num("hw.packages")) > 0) info.packages = (int)v;
+    if ((v = sysctl_num("hw.memsize")) > 0) info.ram_bytes = v;
+    if ((v = sysctl_num("hw.cachelinesize")) > 0) info.cache_line = (int)v;
+    if ((v = sysctl_num("hw.cpufrequency_max")) > 0) info.max_mhz = (int)(v / 1000000);
+    if ((v = sysctl_num("hw.l1icachesize")) > 0) set_cache(1, 2, (size_t)v, 0);
+    if ((v = sysctl_num("hw.l1dcachesize")) > 0) set_cache(1, 1, (size_t)v, 0);
+    if ((v = sysctl_num("hw.l2cachesize")) > 0) set_cache(2, 3, (size_t)v, 0);
+    if ((v = sysctl_num("hw.l3cachesize")) > 0) set_cache(3, 3, (size_t)v, 0);
 }
+#endif
 
-API void get_system_info_str(char* buffer, int max_len) {
-    // OS Name (Kernel version)
-    struct utsname os_info;
-    char os_str[128] = "Linux/Unix";
-    if (uname(&os_info) == 0) {
-        snprintf(os_str, sizeof(os_str), "%s %s", os_info.sysname, os_info.release);
+#ifdef _WIN32
+static void collect_windows(void) {
+    DWORD len = (DWORD)sizeof(info.host);
+    if (!GetComputerNameA(info.host, &len)) info.host[0] = '\0';
+
+    copy_str(info.os, sizeof(info.os), "Windows");
+    HKEY key;
+    if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, "SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion",
+        0, KEY_QUERY_VALUE, &key) == ERROR_SUCCESS) {
+        DWORD sz = (DWORD)sizeof(info.os) - 1;
+        RegQueryValueExA(key, "ProductName", NULL, NULL, (LPBYTE)info.os, &sz);
+        sz = (DWORD)sizeof(info.os_version) - 1;
+        RegQueryValueExA(key, "CurrentBuild", NULL, NULL, (LPBYTE)info.os_version, &sz);
+        RegCloseKey(key);
     }
 
-    // CPU Model & Cores
-    char cpu_model[128] = "Unknown CPU";
-    long num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+    MEMORYSTATUSEX statex;
+    statex.dwLength = sizeof(statex);
+    if (GlobalMemoryStatusEx(&statex)) {
+        info.ram_bytes = (long long)statex.ullTotalPhys;
+        info.ram_available_bytes = (long long)statex.ullAvailPhys;
+    }
 
-    // Linux-specific way to get CPU name
-#ifdef __linux__
-    get_cmd_output("grep -m1 'model name' /proc/cpuinfo | cut -d: -f2 | sed 's/^ *//'", cpu_model, sizeof(cpu_model));
-#elif __APPLE__
-    get_cmd_output("sysctl -n machdep.cpu.brand_string", cpu_model, sizeof(cpu_model));
+    // Cores, packages and caches (authoritative over the CPUID walk)
+    DWORD bytes = 0;
+    GetLogicalProcessorInformation(NULL, &bytes);
+    SYSTEM_LOGICAL_PROCESSOR_INFORMATION* lpi = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION*)malloc(bytes);
+    if (lpi && GetLogicalProcessorInformation(lpi, &bytes)) {
+        const DWORD n = bytes / (DWORD)sizeof(*lpi);
+        int cores = 0, packages = 0, llc = 0;
+        for (DWORD i = 0; i < n; ++i) {
+            if (lpi[i].Relationship == RelationProcessorCore) cores++;
+            else if (lpi[i].Relationship == RelationProcessorPackage) packages++;
+            else if (lpi[i].Relationship == RelationCache) {
+                const CACHE_DESCRIPTOR* c = &lpi[i].Cache;
+                const int type = c->Type == CacheData ? 1 : c->Type == CacheInstruction ? 2 : 3;
+                set_cache(c->Level, type, c->Size, c->LineSize);
+                if (c->Level == 3) llc++;
+            }
+        }
+        if (cores > 0) info.physical_cores = cores;
+        if (packages > 0) info.packages = packages;
+        if (llc > 0) info.llc_instances = llc;
+        if (cores > 0) info.smt_active = info.logical_cpus > cores;
+    }
+    free(lpi);
+
+    DISPLAY_DEVICEA dd;
+    dd.cb = sizeof(dd);
+    if (EnumDisplayDevicesA(NULL, 0, &dd, 0)) copy_str(info.gpu, sizeof(info.gpu), dd.DeviceString);
+}
 #endif
 
-    // RAM Size
-    long pages = sysconf(_SC_PHYS_PAGES);
-    long page_size = sysconf(_SC_PAGE_SIZE);
-    double ram_gb = (double)(pages * page_size) / (1024.0 * 1024.0 * 1024.0);
+static void collect(void) {
+    memset(&info, 0, sizeof(info));
+    info.cpu_family = info.cpu_model_id = info.cpu_stepping = -1;
+    info.smt_active = -1;
+    info.turbo = -1;
+    info.base_mhz = info.min_mhz = info.max_mhz = -1;
+    info.cache_line = -1;
+    info.llc_instances = -1;
+    info.ram_bytes = info.ram_available_bytes = -1;
+    info.hugepages_total = info.hugepages_free = info.hugepage_kb = -1;
+
+    const Topology* t = topology_get();
+    info.logical_cpus = t->ncpus;
+    info.physical_cores = t->ncores;
+    info.packages = t->npackages;
+    cpu_features_str(info.isa_flags, sizeof(info.isa_flags));
+    cpuid_identity();
+
+#ifndef _WIN32
+    struct utsname u;
+    if (uname(&u) == 0) {
+        copy_str(info.host, sizeof(info.host), u.nodename);
+        snprintf(info.os, sizeof(info.os), "%.32s %.90s", u.sysname, u.release);
+        copy_str(info.os_version, sizeof(info.os_version), u.version);
+    }
+    const long pages = sysconf(_SC_PHYS_PAGES);
+    const long page_size = sysconf(_SC_PAGE_SIZE);
+    if (pages > 0 && page_size > 0) info.ram_bytes = (long long)pages * page_size;
+#endif
 
-    // GPU (Tricky on Linux, requires tools like lspci)
-    char gpu_name[128] = "Unknown (requires lspci)";
 #ifdef __linux__
-    // Try to get the first VGA compatible controller
-    get_cmd_output("lspci | grep -i 'vga\\|3d' | head -n 1 | cut -d: -f3 | sed 's/^ *//'", gpu_name, sizeof(gpu_name));
-#elif __APPLE__
-    get_cmd_output("system_profiler SPDisplaysDataType | grep 'Chipset Model' | head -n 1 | cut -d: -f2 | sed 's/^ *//'", gpu_name, sizeof(gpu_name));
+    parse_cpuinfo();
+    sys_caches();
+    sys_cpufreq();
+    sys_memory();
+    sys_gpu();
+    const long smt = read_long("/sys/devices/system/cpu/smt/active", -1);
+    info.smt_active = smt >= 0 ? smt != 0 : t->smt > 1;
+#elif defined(__APPLE__)
+    collect_apple();
+#elif defined(_WIN32)
+    collect_windows();
 #endif
 
-    snprintf(buffer, max_len,
-        "OS:  %s\nCPU: %s\n     (%ld Logical Cores)\nGPU: %s\nRAM: %.1f GB",
-        os_str, cpu_model, num_cores, gpu_name, ram_gb);
+    // sysfs and the OS win; CPUID fills what they left out
+    if (info.l1d_bytes == 0 && info.l2_bytes == 0) cpuid_caches();
+
+    if (info.llc_instances < 0 && info.llc_level > 1) {
+        int count = 0;
+        for (int i = 0; i < t->ncaches; ++i) count += t->caches[i].level == info.llc_level;
+        if (count > 0) info.llc_instances = count;
+    }
+}
+
+const SystemInfo* sysinfo_get(void) {
+    if (!collected) {
+        collect();
+        collected = 1;
+    }
+    return &info;
+}
+
+// "48 KB", "2 MB", "1.25 MB"
+static void format_bytes(char* out, size_t n, size_t bytes) {
+    if (bytes == 0) snprintf(out, n, "?");
+    else if (bytes < (1u << 20)) snprintf(out, n, "%zu KB", bytes >> 10);
+    else if (bytes % (1u << 20) == 0) snprintf(out, n, "%zu MB", bytes >> 20);
+    else snprintf(out, n, "%.1f MB", (double)bytes / (1 << 20));
+}
+
+API void get_system_info_str(char* buffer, int max_len) {
+    const SystemInfo* s = sysinfo_get();
+
+    // Packages, physical cores, SMT, core types and last-level cache
+    char topo[192];
+    topology_summary(topo, sizeof(topo));
+
+    char l1[32], l2[32], l3[32], clock[96] = "";
+    format_bytes(l1, sizeof(l1), s->l1d_bytes);
+    format_bytes(l2, sizeof(l2), s->l2_bytes);
+    format_bytes(l3, sizeof(l3), s->l3_bytes);
+    int len = 0;
+    if (s->max_mhz > 0) len += snprintf(clock + len, sizeof(clock) - (size_t)len, "max %d MHz, ", s->max_mhz);
+    if (s->governor[0]) len += snprintf(clock + len, sizeof(clock) - (size_t)len, "%s, ", s->governor);
+    snprintf(clock + len, sizeof(clock) - (size_t)len, "turbo %s",
+        s->turbo < 0 ? "unknown" : s->turbo ? "on" : "off");
+
+    snprintf(buffer, (size_t)max_len,
+        "OS:  %s\nCPU: %s\n     (%d Logical Cores)\n     %s\n     L1d %s, L2 %s, L3 %s\n     %s\nGPU: %s\nRAM: %.1f GB",
+        s->os[0] ? s->os : "Unknown OS", s->cpu_model[0] ? s->cpu_model : "Unknown CPU", s->logical_cpus, topo,
+        l1, l2, s->l3_bytes ? l3 : "none", clock, s->gpu[0] ? s->gpu : "none detected",
+        s->ram_bytes > 0 ? (double)s->ram_bytes / (1024.0 * 1024.0 * 1024.0) : 0.0);
 }
-#endif
\ No newline at end of file
@@ -0,0 +1,260 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "topology.h"
+#include "numa_nodes.h"
+#include "threadpool.h"
+
+static Topology topo;
+static int      discovered = 0;
+
+// "0-3,8" with no trailing junk
+static int is_cpulist(const char* s) {
+    if (!s[0]) return 0;
+    for (; *s; ++s) {
+        if ((*s < '0' || *s > '9') && *s != ',' && *s != '-') return 0;
+    }
+    return 1;
+}
+
+#ifdef __linux__
+static int read_line(const char* path, char* buf, int len) {
+    FILE* f = fopen(path, "r");
+    if (!f) return 0;
+    const int ok = fgets(buf, len, f) != NULL;
+    fclose(f);
+    if (ok) buf[strcspn(buf, "\n")] = '\0';
+    return ok;
+}
+
+static int read_int(const char* path, int fallback) {
+    char line[64];
+    return read_line(path, line, sizeof(line)) ? atoi(line) : fallback;
+}
+
+static void mark_type(const char* path, int type) {
+    char line[4096];
+    int cpus[TOPO_MAX_CPUS];
+    if (!read_line(path, line, sizeof(line))) return;
+    const int n = numa_parse_cpulist(line, cpus, TOPO_MAX_CPUS);
+    for (int i = 0; i < n; ++i) {
+        for (int k = 0; k < topo.ncpus; ++k) {
+            if (topo.cpus[k].cpu == cpus[i]) topo.cpus[k].type = type;
+        }
+    }
+}
+
+// Intel hybrid parts expose one PMU per core type; Arm big.LITTLE exposes capacity
+static void discover_core_types(void) {
+    char path[128];
+    FILE* f = fopen("/sys/devices/cpu_core/cpus", "r");
+    if (f) {
+        fclose(f);
+        mark_type("/sys/devices/cpu_core/cpus", CORE_TYPE_PERF);
+        mark_type("/sys/devices/cpu_atom/cpus", CORE_TYPE_EFF);
+        return;
+    }
+    int cap[TOPO_MAX_CPUS], maxcap = 0, mincap = 1 << 30;
+    for (int k = 0; k < topo.ncpus; ++k) {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpu_capacity", topo.cpus[k].cpu);
+        cap[k] = read_int(path, 0);
+        if (cap[k] > maxcap) maxcap = cap[k];
+        if (cap[k] < mincap) mincap = cap[k];
+    }
+    if (maxcap == 0 || mincap == maxcap) return;
+    for (int k = 0; k < topo.ncpus; ++k) {
+        topo.cpus[k].type = (cap[k] == maxcap) ? CORE_TYPE_PERF : CORE_TYPE_EFF;
+    }
+}
+
+static void discover_caches(void) {
+    char path[128], line[64];
+    for (int k = 0; k < topo.ncpus; ++k) {
+        for (int idx = 0; idx < 16; ++idx) {
+            const char* base = "/sys/devices/system/cpu/cpu%d/cache/index%d/%s";
+            snprintf(path, sizeof(path), base, topo.cpus[k].cpu, idx, "level");
+            const int level = read_int(path, -1);
+            if (level < 0) break;
+            snprintf(path, sizeof(path), base, topo.cpus[k].cpu, idx, "type");
+            if (level < 2 || !read_line(path, line, sizeof(line)) || strcmp(line, "Instruction") == 0) continue;
+
+            TopoCache c;
+            memset(&c, 0, sizeof(c));
+            c.level = level;
+            snprintf(path, sizeof(path), base, topo.cpus[k].cpu, idx, "shared_cpu_list");
+            if (!read_line(path, c.cpus, sizeof(c.cpus))) continue;
+            snprintf(path, sizeof(path), base, topo.cpus[k].cpu, idx, "size");
+            if (read_line(path, line, sizeof(line))) {
+                char* end;
+                c.size_kb = (int)strtol(line, &end, 10);
+                if (*end == 'M') c.size_kb *= 1024;
+            }
+            int ids[TOPO_MAX_CPUS];
+            c.ncpus = numa_parse_cpulist(c.cpus, ids, TOPO_MAX_CPUS);
+
+            int seen = 0;
+            for (int i = 0; i < topo.ncaches && !seen; ++i) {
+                seen = topo.caches[i].level == c.level && strcmp(topo.caches[i].cpus, c.cpus) == 0;
+            }
+            if (!seen && topo.ncaches < TOPO_MAX_CACHES) topo.caches[topo.ncaches++] = c;
+        }
+    }
+}
+#endif
+
+static void discover(void) {
+    memset(&topo, 0, sizeof(topo));
+    int online[TOPO_MAX_CPUS];
+    int n = 0;
+#ifdef __linux__
+    char line[4096];
+    if (read_line("/sys/devices/system/cpu/online", line, sizeof(line))) {
+        n = numa_parse_cpulist(line, online, TOPO_MAX_CPUS);
+    }
+#endif
+    if (n == 0) {
+        n = pool_hw_threads();
+        if (n > TOPO_MAX_CPUS) n = TOPO_MAX_CPUS;
+        for (int i = 0; i < n; ++i) online[i] = i;
+    }
+
+    // Physical cores are distinct (package, core_id) pairs, numbered in CPU order
+    int core_pkg[TOPO_MAX_CPUS], core_id[TOPO_MAX_CPUS], core_threads[TOPO_MAX_CPUS];
+    int pkgs[TOPO_MAX_CPUS], npkgs = 0;
+    topo.ncpus = n;
+    for (int k = 0; k < n; ++k) {
+        TopoCpu* c = &topo.cpus[k];
+        c->cpu = online[k];
+        int pkg = 0, id = online[k];
+#ifdef __linux__
+        char path[128];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", c->cpu);
+        pkg = read_int(path, 0);
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", c->cpu);
+        id = read_int(path, c->cpu);
+#endif
+        c->package = pkg;
+        int core = 0;
+        while (core < topo.ncores && !(core_pkg[core] == pkg && core_id[core] == id)) ++core;
+        if (core == topo.ncores) {
+            core_pkg[core] = pkg;
+            core_id[core] = id;
+            core_threads[core] = 0;
+            topo.ncores++;
+        }
+        c->core = core;
+        c->smt = core_threads[core]++;
+        if (c->smt + 1 > topo.smt) topo.smt = c->smt + 1;
+
+        int p = 0;
+        while (p < npkgs && pkgs[p] != pkg) ++p;
+        if (p == npkgs) pkgs[npkgs++] = pkg;
+    }
+    topo.npackages = npkgs;
+
+    int nnodes = 0;
+    const NumaNode* nodes = numa_nodes(&nnodes);
+    for (int k = 0; k < n; ++k) {
+        for (int d = 0; d < nnodes; ++d) {
+            for (int i = 0; i < nodes[d].ncpus; ++i) {
+                if (nodes[d].cpus[i] == topo.cpus[k].cpu) topo.cpus[k].node = nodes[d].id;
+            }
+        }
+    }
+
+#ifdef __linux__
+    discover_core_types();
+    discover_caches();
+#endif
+    int types = 0;
+    for (int k = 0; k < n; ++k) {
+        const TopoCpu* c = &topo.cpus[k];
+        if (c->smt == 0 && topo.cores_of_type[c->type]++ == 0) types++;
+    }
+    topo.hybrid = types > 1;
+}
+
+const Topology* topology_get(void) {
+    if (!discovered) {
+        discover();
+        discovered = 1;
+    }
+    return &topo;
+}
+
+const char* topology_type_name(int type) {
+    switch (type) {
+    case CORE_TYPE_PERF: return "P-core";
+    case CORE_TYPE_EFF:  return "E-core";
+    default:             return "core";
+    }
+}
+
+const char* topology_type_short(int type) {
+    switch (type) {
+    case CORE_TYPE_PERF: return "P";
+    case CORE_TYPE_EFF:  return "E";
+    default:             return "";
+    }
+}
+
+void topology_summary(char* out, int max_len) {
+    const Topology* t = topology_get();
+    int len = snprintf(out, (size_t)max_len, "%d package%s, %d core%s, %d thread%s",
+        t->npackages, t->npackages == 1 ? "" : "s", t->ncores, t->ncores == 1 ? "" : "s",
+        t->ncpus, t->ncpus == 1 ? "" : "s");
+    if (t->smt > 1 && len < max_len) {
+        len += snprintf(out + len, (size_t)(max_len - len), " (%d-way SMT)", t->smt);
+    }
+    if (t->hybrid && len < max_len) {
+        len += snprintf(out + len, (size_t)(max_len - len), ", %d %s + %d %s",
+            t->cores_of_type[CORE_TYPE_PERF], topology_type_name(CORE_TYPE_PERF),
+            t->cores_of_type[CORE_TYPE_EFF], topology_type_name(CORE_TYPE_EFF));
+    }
+    // Last-level cache: size and number of instances
+    int llc = 0, size = 0, count = 0;
+    for (int i = 0; i < t->ncaches; ++i) {
+        if (t->caches[i].level > llc) llc = t->caches[i].level;
+    }
+    for (int i = 0; i < t->ncaches; ++i) {
+        if (t->caches[i].level != llc) continue;
+        if (t->caches[i].size_kb > size) size = t->caches[i].size_kb;
+        count++;
+    }
+    if (count > 0 && len < max_len) {
+        if (size >= 1024) snprintf(out + len, (size_t)(max_len - len), ", L%d %d MB x%d", llc, size / 1024, count);
+        else snprintf(out + len, (size_t)(max_len - len), ", L%d %d KB x%d", llc, size, count);
+    }
+}
+
+int topology_pin_set(const char* policy, int type, int* out, int cap) {
+    const Topology* t = topology_get();
+    int n = 0;
+    if (!policy || !policy[0] || strcmp(policy, "none") == 0) return 0;
+
+    const int cores = strcmp(policy, "cores") == 0;
+    if (cores || strcmp(policy, "smt") == 0) {
+        // Core by core; a core's siblings in thread order
+        for (int core = 0; core < t->ncores; ++core) {
+            for (int s = 0; s < t->smt; ++s) {
+                if (cores && s > 0) break;
+                for (int k = 0; k < t->ncpus && n < cap; ++k) {
+                    const TopoCpu* c = &t->cpus[k];
+                    if (c->core == core && c->smt == s && (type < 0 || c->type == type)) out[n++] = c->cpu;
+                }
+            }
+        }
+        return n;
+    }
+
+    if (!is_cpulist(policy)) return -1;
+    int list[TOPO_MAX_CPUS];
+    const int m = numa_parse_cpulist(policy, list, TOPO_MAX_CPUS);
+    for (int i = 0; i < m && n < cap; ++i) {
+        for (int k = 0; k < t->ncpus; ++k) {
+            const TopoCpu* c = &t->cpus[k];
+            if (c->cpu == list[i] && (type < 0 || c->type == type)) out[n++] = c->cpu;
+        }
+    }
+    return m > 0 ? n : -1;
+}